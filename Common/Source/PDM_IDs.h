@@ -59,6 +59,11 @@ extern "C" {
 #define PDM_ID_APP_ZLL_ROUTER       0x6
 #define PDM_ID_APP_SCENES_DATA      0x9
 #define PDM_ID_OTA_DATA             0xA
+#define PDM_ID_APP_STRIP_PROFILE    0xB
+#define PDM_ID_APP_COLOUR_CAL       0xC
+#define PDM_ID_APP_PWM_PROFILE      0xD
+#define PDM_ID_APP_LIGHT_CURVE      0xE
+#define PDM_ID_APP_SCENE_CURVES     0xF
 
 #else
 
@@ -67,6 +72,11 @@ extern "C" {
 #define PDM_ID_APP_GROUP_TABLE      "GROUP_TABLE"
 #define PDM_ID_APP_ZLL_ROUTER       "ZLL_ROUTER"
 #define PDM_ID_APP_SCENES_DATA      "SCENES_DATA"
+#define PDM_ID_APP_STRIP_PROFILE    "STRIP_PROFILE"
+#define PDM_ID_APP_COLOUR_CAL       "COLOUR_CAL"
+#define PDM_ID_APP_PWM_PROFILE      "PWM_PROFILE"
+#define PDM_ID_APP_LIGHT_CURVE      "LIGHT_CURVE"
+#define PDM_ID_APP_SCENE_CURVES     "SCENE_CURVES"
 
 #endif
 
@@ -77,6 +77,8 @@ typedef struct
 /****************************************************************************/
 #if (defined CLD_SCENES) && (defined SCENES_SERVER)
 PRIVATE  bool bCLD_ScenesSearchForScene(void *pvSearchParam, void *psNodeUnderTest);
+PRIVATE tsCLD_ScenesTableEntry *psFindScene(uint16 u16GroupId, uint8 u8SceneId);
+PRIVATE bool_t bPruneSceneCurves(void);
 #endif
 
 /****************************************************************************/
@@ -88,6 +90,7 @@ PRIVATE  bool bCLD_ScenesSearchForScene(void *pvSearchParam, void *psNodeUnderTe
 /****************************************************************************/
 #if (defined CLD_SCENES) && (defined SCENES_SERVER)
 PRIVATE tsAPP_ScenesCustomData sScenesCustomData;
+PRIVATE tsAPP_SceneCurves sSceneCurves;
 #endif
 
 
@@ -148,6 +151,138 @@ PUBLIC void vSaveScenesNVM(void)
         }
     }
     PDM_eSaveRecordData(PDM_ID_APP_SCENES_DATA,&sScenesCustomData,sizeof(tsAPP_ScenesCustomData));
+
+    /* Drop the curves of scenes that have gone */
+    if (bPruneSceneCurves())
+    {
+        PDM_eSaveRecordData(PDM_ID_APP_SCENE_CURVES, &sSceneCurves, sizeof(tsAPP_SceneCurves));
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: vStoreSceneCurve
+ *
+ * DESCRIPTION:
+ * Keeps the curve a scene's level transition takes when it is recalled,
+ * in place of any the scene had, and saves the scene curves to EEPROM
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vStoreSceneCurve(uint16 u16GroupId, uint8 u8SceneId, uint8 u8Curve)
+{
+    tsAPP_SceneCurve *psFree = NULL;
+    uint8 i;
+
+    (void)bPruneSceneCurves();
+
+    for(i=0; i<CLD_SCENES_MAX_NUMBER_OF_SCENES; i++)
+    {
+        tsAPP_SceneCurve *psCurve = &sSceneCurves.asSceneCurve[i];
+
+        if ((psCurve->bIsValid == TRUE) && (psCurve->u16GroupId == u16GroupId) && (psCurve->u8SceneId == u8SceneId))
+        {
+            psFree = psCurve;
+            break;
+        }
+        if ((psCurve->bIsValid == FALSE) && (psFree == NULL))
+        {
+            psFree = psCurve;
+        }
+    }
+
+    if (psFree == NULL)
+    {
+        return;
+    }
+    psFree->bIsValid = TRUE;
+    psFree->u16GroupId = u16GroupId;
+    psFree->u8SceneId = u8SceneId;
+    psFree->u8Curve = u8Curve;
+    PDM_eSaveRecordData(PDM_ID_APP_SCENE_CURVES, &sSceneCurves, sizeof(tsAPP_SceneCurves));
+}
+
+/****************************************************************************
+ *
+ * NAME: bGetSceneCurve
+ *
+ * DESCRIPTION:
+ * The curve kept for a scene
+ *
+ * RETURNS:
+ * TRUE if the scene has one
+ *
+ ****************************************************************************/
+PUBLIC bool_t bGetSceneCurve(uint16 u16GroupId, uint8 u8SceneId, uint8 *pu8Curve)
+{
+    uint8 i;
+
+    for(i=0; i<CLD_SCENES_MAX_NUMBER_OF_SCENES; i++)
+    {
+        tsAPP_SceneCurve *psCurve = &sSceneCurves.asSceneCurve[i];
+
+        if ((psCurve->bIsValid == TRUE) && (psCurve->u16GroupId == u16GroupId) && (psCurve->u8SceneId == u8SceneId))
+        {
+            *pu8Curve = psCurve->u8Curve;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME: bGetSceneLevel
+ *
+ * DESCRIPTION:
+ * The level a scene holds in its level control extension field set, and
+ * its transition time in tenths of a second
+ *
+ * RETURNS:
+ * TRUE if the scene is in the table and holds a level
+ *
+ ****************************************************************************/
+PUBLIC bool_t bGetSceneLevel(uint16 u16GroupId, uint8 u8SceneId, uint8 *pu8Level, uint16 *pu16TransitionTime)
+{
+    tsCLD_ScenesTableEntry *psTableEntry;
+    uint32 u32TransitionTime;
+    uint16 u16Length;
+    uint16 i;
+
+    psTableEntry = psFindScene(u16GroupId, u8SceneId);
+    if (psTableEntry == NULL)
+    {
+        return FALSE;
+    }
+
+    /* Each field set is a cluster ID, a length and that many bytes */
+    u16Length = psTableEntry->u16SceneDataLength;
+    if (u16Length > CLD_SCENES_MAX_SCENE_STORAGE_BYTES)
+    {
+        u16Length = CLD_SCENES_MAX_SCENE_STORAGE_BYTES;
+    }
+    for(i=0; i+3<u16Length; i+=3+psTableEntry->au8SceneData[i+2])
+    {
+        if ((psTableEntry->au8SceneData[i] | (psTableEntry->au8SceneData[i+1] << 8)) == GENERAL_CLUSTER_ID_LEVEL_CONTROL)
+        {
+            if (psTableEntry->au8SceneData[i+2] == 0)
+            {
+                return FALSE;
+            }
+            *pu8Level = psTableEntry->au8SceneData[i+3];
+
+            u32TransitionTime = (uint32)psTableEntry->u16TransitionTime * 10;
+        #ifdef CLD_SCENES_SUPPORT_ZLL_ENHANCED_COMMANDS
+            u32TransitionTime += psTableEntry->u8TransitionTime100ms;
+        #endif
+            /* 0xFFFF would ask for the On/Off transition time */
+            *pu16TransitionTime = (u32TransitionTime < 0xFFFF) ? (uint16)u32TransitionTime : 0xFFFE;
+            return TRUE;
+        }
+    }
+    return FALSE;
 }
 
 PRIVATE  bool bCLD_ScenesSearchForScene(void *pvSearchParam, void *psNodeUnderTest)
@@ -167,6 +302,57 @@ PRIVATE  bool bCLD_ScenesSearchForScene(void *pvSearchParam, void *psNodeUnderTe
 
     return TRUE;
 }
+
+/****************************************************************************
+ *
+ * NAME: psFindScene
+ *
+ * DESCRIPTION:
+ * Finds a scene in the table
+ *
+ * RETURNS:
+ * The scene's table entry, NULL if it is not there
+ *
+ ****************************************************************************/
+PRIVATE tsCLD_ScenesTableEntry *psFindScene(uint16 u16GroupId, uint8 u8SceneId)
+{
+    tsSearchParameter sSearchParameter;
+
+    sSearchParameter.u8SearchOptions = (SCENES_SEARCH_GROUP_ID|SCENES_SEARCH_SCENE_ID);
+    sSearchParameter.u16GroupId = u16GroupId;
+    sSearchParameter.u8SceneId  = u8SceneId;
+    return (tsCLD_ScenesTableEntry*)psDLISTsearchFromHead(&sLight.sScenesServerCustomDataStructure.lScenesAllocList,
+                                                          bCLD_ScenesSearchForScene, (void*)&sSearchParameter);
+}
+
+/****************************************************************************
+ *
+ * NAME: bPruneSceneCurves
+ *
+ * DESCRIPTION:
+ * Drops the curves of scenes no longer in the table
+ *
+ * RETURNS:
+ * TRUE if any were dropped
+ *
+ ****************************************************************************/
+PRIVATE bool_t bPruneSceneCurves(void)
+{
+    bool_t bPruned = FALSE;
+    uint8 i;
+
+    for(i=0; i<CLD_SCENES_MAX_NUMBER_OF_SCENES; i++)
+    {
+        tsAPP_SceneCurve *psCurve = &sSceneCurves.asSceneCurve[i];
+
+        if ((psCurve->bIsValid == TRUE) && (psFindScene(psCurve->u16GroupId, psCurve->u8SceneId) == NULL))
+        {
+            psCurve->bIsValid = FALSE;
+            bPruned = TRUE;
+        }
+    }
+    return bPruned;
+}
 #endif
 
 #if (defined CLD_SCENES) && (defined SCENES_SERVER)
@@ -175,7 +361,7 @@ PRIVATE  bool bCLD_ScenesSearchForScene(void *pvSearchParam, void *psNodeUnderTe
  * NAME: vLoadScenesNVM
  *
  * DESCRIPTION:
- * To load scenes data from EEPROM
+ * To load scenes data and scene curves from EEPROM
  *
  * RETURNS:
  * void
@@ -190,6 +376,14 @@ PUBLIC void vLoadScenesNVM(void)
                             &sScenesCustomData,
                             sizeof(tsAPP_ScenesCustomData), &u16ByteRead);
 
+    /* Scenes stored before curves were kept have none */
+    if ((PDM_eReadDataFromRecord(PDM_ID_APP_SCENE_CURVES, &sSceneCurves,
+                                 sizeof(tsAPP_SceneCurves), &u16ByteRead) != PDM_E_STATUS_OK) ||
+        (u16ByteRead != sizeof(tsAPP_SceneCurves)))
+    {
+        memset(&sSceneCurves, 0, sizeof(tsAPP_SceneCurves));
+    }
+
     /* initialise lists */
     vDLISTinitialise(&sLight.sScenesServerCustomDataStructure.lScenesAllocList);
     vDLISTinitialise(&sLight.sScenesServerCustomDataStructure.lScenesDeAllocList);
@@ -62,6 +62,22 @@ typedef struct
 {
     tsAPP_ScenesCustomTableEntry  asScenesCustomTableEntry[CLD_SCENES_MAX_NUMBER_OF_SCENES];
 } tsAPP_ScenesCustomData;
+
+/* Curve a scene's level transition takes, a teLI_Curve */
+typedef struct
+{
+    bool_t  bIsValid;
+    uint16  u16GroupId;
+    uint8   u8SceneId;
+    uint8   u8Curve;
+} tsAPP_SceneCurve;
+
+/* Scene curves, saved in a PDM record of their own so the scenes record
+ * keeps its size */
+typedef struct
+{
+    tsAPP_SceneCurve  asSceneCurve[CLD_SCENES_MAX_NUMBER_OF_SCENES];
+} tsAPP_SceneCurves;
 #endif
 
 /****************************************************************************/
@@ -70,6 +86,9 @@ typedef struct
 #if (defined CLD_SCENES) && (defined SCENES_SERVER)
 PUBLIC void vLoadScenesNVM(void);
 PUBLIC void vSaveScenesNVM(void);
+PUBLIC void vStoreSceneCurve(uint16 u16GroupId, uint8 u8SceneId, uint8 u8Curve);
+PUBLIC bool_t bGetSceneCurve(uint16 u16GroupId, uint8 u8SceneId, uint8 *pu8Curve);
+PUBLIC bool_t bGetSceneLevel(uint16 u16GroupId, uint8 u8SceneId, uint8 *pu8Level, uint16 *pu16TransitionTime);
 #endif
 
 #ifdef CLD_GROUPS
@@ -0,0 +1,67 @@
+###############################################################################
+#
+# MODULE:   DimCurve.awk
+#
+# DESCRIPTION: Generates the perceptual dimming table used by the bulb drivers
+#              in place of a linear (colour * level) / 255 scaling.
+#
+#              awk -v CURVE=CIE -f DimCurve.awk > DimCurve_CIE.c
+#
+#              CURVE   CIE     CIE 1931 lightness (L*) to luminance
+#                      GAMMA   power law, exponent GAMMA (default 2.2)
+#                      LINEAR  straight line, matches the original scaling
+#
+#              Entry n is the relative light output for an 8 bit input n in
+#              Q16, so entry 0 is 0 and entry 255 is 65535. A copy of the last
+#              entry follows so 12 bit inputs can interpolate up to 4095.
+#
+###############################################################################
+
+function dim_curve(n,    x, l)
+{
+    x = n / 255
+    if (CURVE == "CIE")
+    {
+        l = 100 * x
+        if (l <= 8)
+            return l / 903.3
+        return ((l + 16) / 116) ^ 3
+    }
+    if (CURVE == "GAMMA")
+        return x ^ GAMMA
+    return x
+}
+
+BEGIN {
+    if (CURVE == "")
+        CURVE = "CIE"
+    if (GAMMA == "")
+        GAMMA = 2.2
+    if (CURVE != "CIE" && CURVE != "GAMMA" && CURVE != "LINEAR")
+    {
+        print "DimCurve.awk: unknown CURVE " CURVE > "/dev/stderr"
+        exit 1
+    }
+
+    print "/* Generated by DimCurve.awk with CURVE=" CURVE ", do not edit */"
+    print ""
+    print "#include <jendefs.h>"
+    print "#include \"DriverBulb_DimCurve.h\""
+    print ""
+    print "const uint16 au16DimCurve[DIM_CURVE_SIZE + 1] ="
+    print "{"
+    for (n = 0; n < 256; n++)
+    {
+        v = int(dim_curve(n) * 65535 + 0.5)
+        line = line sprintf("%5d,", v)
+        if (n % 8 == 7)
+        {
+            print "    " line
+            line = ""
+        }
+        else
+            line = line " "
+    }
+    print "    65535"
+    print "};"
+}
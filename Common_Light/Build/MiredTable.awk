@@ -0,0 +1,176 @@
+###############################################################################
+#
+# MODULE:   MiredTable.awk
+#
+# DESCRIPTION: Generates the colour temperature tables, the RGB that RGB
+#              bulbs show a colour temperature with and the warm/cool
+#              split of tunable white bulbs.
+#
+#              awk -f MiredTable.awk > MiredTable.c
+#              awk -v TABLE=WARMCOOL -f MiredTable.awk > WarmCoolTable.c
+#
+#              Entry n is for the black body at MIRED_TABLE_MIN +
+#              n * MIRED_TABLE_STEP mired. The locus is the Kim et al.
+#              cubic fit of the Planckian locus in CIE xy.
+#
+#              RGB entries are the 12 bit RGB of the locus point, its
+#              brightest primary at 4095, taken onto the primaries and
+#              white point below, which are those of Light_ColorLight's
+#              zcl_options.h and can be overridden with -v.
+#
+#              WARMCOOL entries are the 12 bit duties of a warm and a cool
+#              white LED, both on the locus at WARM and COOL mired, whose
+#              mix comes closest to the locus point in CIE 1960 uv. COOL_FLUX
+#              and WARM_FLUX are the light each LED gives at full duty; the
+#              duties are scaled so every entry gives the same light, the
+#              most the dimmer LED gives on its own. Beyond the LEDs the
+#              entries hold the nearer one.
+#
+###############################################################################
+
+function locus_x(t)
+{
+    if (t <= 4000)
+        return -0.2661239e9 / t^3 - 0.2343589e6 / t^2 + 0.8776956e3 / t + 0.179910
+    return -3.0258469e9 / t^3 + 2.1070379e6 / t^2 + 0.2226347e3 / t + 0.240390
+}
+
+function locus_y(t, x)
+{
+    if (t <= 2222)
+        return -1.1063814 * x^3 - 1.34811020 * x^2 + 2.18555832 * x - 0.20219683
+    if (t <= 4000)
+        return -0.9549476 * x^3 - 1.37418593 * x^2 + 2.09137015 * x - 0.16748867
+    return 3.0817580 * x^3 - 5.87338670 * x^2 + 3.75112997 * x - 0.37001483
+}
+
+# Rows of the xyz to RGB matrix: the adjugate of the primaries, each row
+# scaled so that the white point comes out equal in all three
+function build_matrix(    p, i, j, r1, r2, c1, c2, w)
+{
+    p[0, 0] = RX; p[0, 1] = GX; p[0, 2] = BX
+    p[1, 0] = RY; p[1, 1] = GY; p[1, 2] = BY
+    for (j = 0; j < 3; j++)
+        p[2, j] = 1 - p[0, j] - p[1, j]
+    for (i = 0; i < 3; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            r1 = (j + 1) % 3; r2 = (j + 2) % 3; c1 = (i + 1) % 3; c2 = (i + 2) % 3
+            m[i, j] = p[r1, c1] * p[r2, c2] - p[r1, c2] * p[r2, c1]
+        }
+        w = m[i, 0] * WX + m[i, 1] * WY + m[i, 2] * (1 - WX - WY)
+        for (j = 0; j < 3; j++)
+            m[i, j] /= w
+    }
+}
+
+# Mix of the warm and cool LEDs nearest the locus at mired: the share of
+# the light from the cool LED, searched in 1/4096 steps along the line
+# between them in uv
+function cool_share(mired,    t, x, y, u, v, f, best, bestf, d, X, Z)
+{
+    t = 1000000 / mired
+    x = locus_x(t)
+    y = locus_y(t, x)
+    u = 4 * x / (-2 * x + 12 * y + 3)
+    v = 6 * y / (-2 * x + 12 * y + 3)
+    best = -1
+    for (f = 0; f <= 4096; f++)
+    {
+        # Light adds in XYZ, each LED's share of Y at its own chromaticity
+        X = (f * CX / CY + (4096 - f) * WWX / WWY) / 4096
+        Z = (f * (1 - CX - CY) / CY + (4096 - f) * (1 - WWX - WWY) / WWY) / 4096
+        d = (4 * X / (X + 15 + 3 * Z) - u)^2 + (6 / (X + 15 + 3 * Z) - v)^2
+        if ((best < 0) || (d < best))
+        {
+            best = d
+            bestf = f
+        }
+    }
+    return bestf / 4096
+}
+
+BEGIN {
+    if (TABLE == "") TABLE = "RGB"
+    if (RX == "") RX = 0.68
+    if (RY == "") RY = 0.31
+    if (GX == "") GX = 0.11
+    if (GY == "") GY = 0.82
+    if (BX == "") BX = 0.13
+    if (BY == "") BY = 0.04
+    if (WX == "") WX = 0.33
+    if (WY == "") WY = 0.33
+    if (WARM == "") WARM = 370
+    if (COOL == "") COOL = 154
+    if (WARM_FLUX == "") WARM_FLUX = 0.8
+    if (COOL_FLUX == "") COOL_FLUX = 1.0
+    MIN  = 152
+    STEP = 16
+    SIZE = 28
+
+    print "/* Generated by MiredTable.awk, do not edit */"
+    print ""
+    print "#include <jendefs.h>"
+    print "#include \"DriverBulb_MiredTable.h\""
+    print ""
+    print "#if (MIRED_TABLE_MIN != " MIN ") || (MIRED_TABLE_STEP != " STEP ") || (MIRED_TABLE_SIZE != " SIZE ")"
+    print "#error MiredTable.awk and DriverBulb_MiredTable.h disagree on the table"
+    print "#endif"
+    print ""
+
+    if (TABLE == "WARMCOOL")
+    {
+        print "#if (WARMCOOL_MIRED_WARM != " WARM ") || (WARMCOOL_MIRED_COOL != " COOL ")"
+        print "#error MiredTable.awk and DriverBulb_MiredTable.h disagree on the LEDs"
+        print "#endif"
+        print ""
+
+        WWX = locus_x(1000000 / WARM); WWY = locus_y(1000000 / WARM, WWX)
+        CX  = locus_x(1000000 / COOL); CY  = locus_y(1000000 / COOL, CX)
+        flux = (WARM_FLUX < COOL_FLUX) ? WARM_FLUX : COOL_FLUX
+
+        print "const uint16 au16WarmCoolTable[MIRED_TABLE_SIZE + 1][2] ="
+        print "{"
+        for (n = 0; n <= SIZE; n++)
+        {
+            mired = MIN + n * STEP
+            if (mired <= COOL)
+                f = 1
+            else if (mired >= WARM)
+                f = 0
+            else
+                f = cool_share(mired)
+            printf "    { %4d, %4d }%s    /* %3d mired, %5d K */\n", \
+                   int(4095 * (1 - f) * flux / WARM_FLUX + 0.5), int(4095 * f * flux / COOL_FLUX + 0.5), \
+                   (n < SIZE) ? "," : " ", mired, int(1000000 / mired + 0.5)
+        }
+        print "};"
+        exit
+    }
+
+    build_matrix()
+
+    print "const uint16 au16MiredTable[MIRED_TABLE_SIZE + 1][3] ="
+    print "{"
+    for (n = 0; n <= SIZE; n++)
+    {
+        mired = MIN + n * STEP
+        t = 1000000 / mired
+        x = locus_x(t)
+        y = locus_y(t, x)
+        max = 0
+        for (i = 0; i < 3; i++)
+        {
+            c[i] = m[i, 0] * x + m[i, 1] * y + m[i, 2] * (1 - x - y)
+            if (c[i] < 0)
+                c[i] = 0
+            if (c[i] > max)
+                max = c[i]
+        }
+        printf "    { %4d, %4d, %4d }%s    /* %3d mired, %5d K */\n", \
+               int(4095 * c[0] / max + 0.5), int(4095 * c[1] / max + 0.5), int(4095 * c[2] / max + 0.5), \
+               (n < SIZE) ? "," : " ", mired, int(t + 0.5)
+    }
+    print "};"
+}
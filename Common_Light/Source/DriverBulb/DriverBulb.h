@@ -51,6 +51,61 @@ extern "C" {
 /****************************************************************************/
 
 enum {E_RED_PWM,E_GREEN_PWM,E_BLUE_PWM};
+
+/* Addressable strip chips and the order they take their colour bytes in */
+typedef enum
+{
+	E_STRIP_LPD8806,
+	E_STRIP_WS2801,
+	E_STRIP_APA102,
+	E_STRIP_NUM_CHIPS
+} teStripChip;
+
+typedef enum
+{
+	E_STRIP_ORDER_RGB,
+	E_STRIP_ORDER_RBG,
+	E_STRIP_ORDER_GRB,
+	E_STRIP_ORDER_GBR,
+	E_STRIP_ORDER_BRG,
+	E_STRIP_ORDER_BGR,
+	E_STRIP_NUM_ORDERS
+} teStripOrder;
+
+/* Fixture profile of an addressable strip, persisted in PDM */
+typedef struct
+{
+	uint16	u16NumLeds;
+	uint8	u8Chip;			/* teStripChip */
+	uint8	u8Order;		/* teStripOrder */
+	uint32	u32SpiHz;
+} tsStripProfile;
+
+/* PWM frequency of the PWM drivers, persisted in PDM. Higher frequencies
+ * don't band on cameras but have fewer counts per period, so more of the
+ * 12 bit duty is dithered */
+typedef enum
+{
+	E_PWM_PROFILE_STANDARD,			/* 980Hz, 8 bit  */
+	E_PWM_PROFILE_FLICKER_FREE,		/* 16kHz, 10 bit */
+	E_PWM_PROFILE_HIGH_RES,			/* 1kHz, 12 bit  */
+	E_PWM_PROFILE_NUM
+} tePwmProfile;
+
+/* Colour calibration of a fixture, persisted in PDM. Each LED is driven
+ * with its row of the matrix applied to the colour in linear light, then
+ * its gain; all in Q12, so the identity matrix and gains of 4096 leave
+ * the colour as it is */
+#define COLOUR_CAL_ONE			4096
+#define COLOUR_CAL_MATRIX_MAX	(2 * COLOUR_CAL_ONE)	/* +-2.0 */
+#define COLOUR_CAL_GAIN_MAX		COLOUR_CAL_ONE			/* no LED past full */
+
+typedef struct
+{
+	int16	ai16Matrix[3][3];	/* [LED][colour channel] */
+	uint16	au16Gain[3];
+} tsColourCalibration;
+
 /****************************************************************************/
 /***        Public Function Prototypes                                    ***/
 /****************************************************************************/
@@ -65,6 +120,10 @@ PUBLIC void 	 	DriverBulb_vSetLevel(uint32 u32Level);
 PUBLIC void         DriverBulb_vSetOnOff(bool_t bOn);
 PUBLIC void         DriverBulb_vSetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)__attribute__((weak));
 
+/* Batched update: level, colour and colour temperature in one hardware write */
+PUBLIC void         DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)__attribute__((weak));
+PUBLIC uint32       DriverBulb_u32GetOutputCount(void)__attribute__((weak));
+
 /* Optional Interface Functions                        */
 /* Stub out in implementation if no behaviour required */
 PUBLIC bool_t 	 	DriverBulb_bReady(void);
@@ -80,6 +139,35 @@ PUBLIC void         DriverBulb_vGetColourTempPhyMinMax(uint16 *pu16PhyMin, uint1
 PUBLIC uint16 DriverBulb_u16GetAdcValue(uint32 u32ChannelId)__attribute__((weak));
 PUBLIC void DriverBulb_vSet12BitColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)__attribute__((weak));
 
+/* 12 bit interface, dithered onto the PWM by drivers with less resolution */
+PUBLIC void DriverBulb_vSet12BitLevel(uint32 u32Level)__attribute__((weak));
+PUBLIC void DriverBulb_vSet12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)__attribute__((weak));
+
+/* 10ms tick from the application, and whether the driver has work for the
+ * next one. Without work the application may leave it out */
+PUBLIC void   DriverBulb_vTick(void)__attribute__((weak));
+PUBLIC bool_t DriverBulb_bTickPending(void)__attribute__((weak));
+
+/* Driver settings held in PDM, loaded once PDM is initialised */
+PUBLIC void DriverBulb_vLoadSettings(void)__attribute__((weak));
+
+/* Addressable strips: per pixel colour, and segments of adjacent pixels */
+PUBLIC void   DriverBulb_vSetPixel(uint16 u16Pixel, uint32 u32Red, uint32 u32Green, uint32 u32Blue)__attribute__((weak));
+PUBLIC void   DriverBulb_vSetSegmentColour(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue)__attribute__((weak));
+PUBLIC bool_t DriverBulb_bMapSegment(uint8 u8Segment, uint16 u16First, uint16 u16Count)__attribute__((weak));
+PUBLIC bool_t DriverBulb_bCheckStripProfile(const tsStripProfile *psProfile)__attribute__((weak));
+PUBLIC bool_t DriverBulb_bSetStripProfile(const tsStripProfile *psProfile)__attribute__((weak));
+PUBLIC void   DriverBulb_vGetStripProfile(tsStripProfile *psProfile)__attribute__((weak));
+
+/* PWM drivers: frequency profile, a tePwmProfile */
+PUBLIC bool_t DriverBulb_bSetPwmProfile(uint8 u8Profile)__attribute__((weak));
+PUBLIC uint8  DriverBulb_u8GetPwmProfile(void)__attribute__((weak));
+
+/* Per fixture colour calibration */
+PUBLIC bool_t DriverBulb_bCheckColourCalibration(const tsColourCalibration *psCalibration)__attribute__((weak));
+PUBLIC bool_t DriverBulb_bSetColourCalibration(const tsColourCalibration *psCalibration)__attribute__((weak));
+PUBLIC void   DriverBulb_vGetColourCalibration(tsColourCalibration *psCalibration)__attribute__((weak));
+
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          DriverBulb_DimCurve.h
+ *
+ * DESCRIPTION:        Perceptual dimming table shared by the bulb drivers
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef DRIVERBULB_DIMCURVE_H_INCLUDED
+#define DRIVERBULB_DIMCURVE_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* The table itself is generated at build time by Common_Light/Build/DimCurve.awk,
+ * the curve (CIE, GAMMA or LINEAR) being chosen per LIGHT target by DIM_CURVE.
+ * Entries are the relative light output in Q16 for an 8 bit level or colour.
+ */
+#define DIM_CURVE_SIZE          (256)
+#define DIM_CURVE_BITS          (16)
+
+/* Output for colour u8C at level u8L, scaled to u8Bits of PWM resolution.
+ * Multiplying two Q16 entries replaces the (colour * level) / 255 division.
+ */
+#define DIM_CURVE_SCALE(u8C, u8L, u8Bits) \
+    (((uint32)au16DimCurve[(u8C)] * (uint32)au16DimCurve[(u8L)]) >> (2 * DIM_CURVE_BITS - (u8Bits)))
+
+/* 12 bit inputs interpolate between neighbouring entries */
+#define DIM_12BIT_MAX           (4095)
+#define DIM_12BIT_FRAC_BITS     (4)
+#define DIM_12BIT_FRAC_MASK     ((1 << DIM_12BIT_FRAC_BITS) - 1)
+
+#define DIM_CURVE_LOOKUP12(u16X) \
+    ((uint32)au16DimCurve[(u16X) >> DIM_12BIT_FRAC_BITS] + \
+     ((((uint32)au16DimCurve[((u16X) >> DIM_12BIT_FRAC_BITS) + 1] - (uint32)au16DimCurve[(u16X) >> DIM_12BIT_FRAC_BITS]) * \
+       ((u16X) & DIM_12BIT_FRAC_MASK)) >> DIM_12BIT_FRAC_BITS))
+
+#define DIM_CURVE_SCALE12(u16C, u16L, u8Bits) \
+    ((DIM_CURVE_LOOKUP12(u16C) * DIM_CURVE_LOOKUP12(u16L)) >> (2 * DIM_CURVE_BITS - (u8Bits)))
+
+/* Widens an 8 bit value so that 255 maps onto 4095 */
+#define DIM_EXPAND_12BIT(u8X)   ((uint16)(((u8X) << DIM_12BIT_FRAC_BITS) | ((u8X) >> DIM_12BIT_FRAC_BITS)))
+
+/* Temporal dithering of a 12 bit duty onto an 8 bit PWM. The fraction is
+ * compared against a bit reversed phase counter so that over 16 successive
+ * phases the extra LSB is spread as evenly as possible, and at any single
+ * phase the output never decreases as the duty increases.
+ */
+#define DIM_DITHER_PHASES       (1 << DIM_12BIT_FRAC_BITS)
+#define DIM_DITHER_THRESHOLD(u8Phase) \
+    ((((u8Phase) & 1) << 3) | (((u8Phase) & 2) << 1) | (((u8Phase) & 4) >> 1) | (((u8Phase) & 8) >> 3))
+#define DIM_DITHER(u16Duty, u8Phase) \
+    (((u16Duty) >> DIM_12BIT_FRAC_BITS) + (((u16Duty) & DIM_12BIT_FRAC_MASK) > DIM_DITHER_THRESHOLD(u8Phase) ? 1 : 0))
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+extern const uint16 au16DimCurve[DIM_CURVE_SIZE + 1];
+
+#endif /* DRIVERBULB_DIMCURVE_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
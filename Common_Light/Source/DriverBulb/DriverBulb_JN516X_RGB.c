@@ -35,17 +35,19 @@
 #include <PeripheralRegs.h>
 /* JenOS includes */
 #include <dbg.h>
+#include "pdm.h"
 /* Application includes */
+#include "PDM_IDs.h"
 /* Device includes */
 #include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_Pwm.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 /* PWM timer configuration */
 #define PERIPHERAL_CLOCK_FREQUENCY_HZ	16000000UL		/* System frequency 16MHz */
-#define PWM_TIMER_PRESCALE				6     			/* Prescale value to use   */
-#define PWM_COUNT_MAX					255				/* Gives PWM frequency of ((16MHz / 2^6) / 255) */
 
 
 #define PWM_TIMER_RED					E_AHI_TIMER_1
@@ -64,6 +66,9 @@
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Red, uint16 u16Green, uint16 u16Blue);
+PRIVATE bool_t DriverBulb_bValidCalibration(const tsColourCalibration *psCalibration);
+PRIVATE void DriverBulb_vApplyCalibration(void);
 PRIVATE void DriverBulb_vOutput(void);
 
 /****************************************************************************/
@@ -78,11 +83,27 @@ PRIVATE void DriverBulb_vOutput(void);
 /***        Local Variables                                               ***/
 /****************************************************************************/
 PRIVATE bool_t  bIsOn      	 	= FALSE;
-PRIVATE uint8   u8CurrLevel 	= 255;
 
-PRIVATE uint8   u8CurrRed       = PWM_COUNT_MAX;
-PRIVATE uint8   u8CurrGreen     = PWM_COUNT_MAX;
-PRIVATE uint8   u8CurrBlue		= PWM_COUNT_MAX;
+/* Level and colour are held at 12 bits */
+PRIVATE uint16  u16CurrLevel 	= DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrRed      = DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrGreen    = DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrBlue		= DIM_12BIT_MAX;
+
+PRIVATE const uint8  au8Timer[3]       = { PWM_TIMER_RED, PWM_TIMER_GREEN, PWM_TIMER_BLUE };
+PRIVATE const uint32 au32TimerDevice[3] = { E_AHI_DEVICE_TIMER1, E_AHI_DEVICE_TIMER2, E_AHI_DEVICE_TIMER3 };
+
+/* Colour calibration as set, and as applied: the matrix with each LED's
+ * gain folded into its row, so an update is 9 multiplies */
+PRIVATE tsColourCalibration sCalibration =
+{
+	{ { COLOUR_CAL_ONE, 0, 0 }, { 0, COLOUR_CAL_ONE, 0 }, { 0, 0, COLOUR_CAL_ONE } },
+	{ COLOUR_CAL_ONE, COLOUR_CAL_ONE, COLOUR_CAL_ONE }
+};
+PRIVATE int32   ai32Mix[3][3] =
+{
+	{ COLOUR_CAL_ONE, 0, 0 }, { 0, COLOUR_CAL_ONE, 0 }, { 0, 0, COLOUR_CAL_ONE }
+};
 
 
 /****************************************************************************/
@@ -108,24 +129,11 @@ PUBLIC void DriverBulb_vInit(void)
 	/* Not already initialized ? */
 	if (bInit == FALSE)
 	{
-
-		/* Configure red channel PWM timer */
-		vAHI_TimerEnable(PWM_TIMER_RED, PWM_TIMER_PRESCALE, FALSE, FALSE, TRUE);
-		vAHI_TimerConfigureOutputs(PWM_TIMER_RED, PWM_INVERT, TRUE);
-
-		/* Configure green channel PWM timer */
-		vAHI_TimerEnable(PWM_TIMER_GREEN, PWM_TIMER_PRESCALE, FALSE, FALSE, TRUE);
-		vAHI_TimerConfigureOutputs(PWM_TIMER_GREEN, PWM_INVERT, TRUE);
-
-		/* Configure blue channel PWM timer */
-		vAHI_TimerEnable(PWM_TIMER_BLUE, PWM_TIMER_PRESCALE, FALSE, FALSE, TRUE);
-		vAHI_TimerConfigureOutputs(PWM_TIMER_BLUE, PWM_INVERT, TRUE);
-
-
 		/* Note light is on */
 		bIsOn = TRUE;
 
-		/* Set outputs */
+		/* Start the red, green and blue PWM timers, then set the first duties */
+		DriverBulb_vPwmInit(3, au8Timer, au32TimerDevice, PWM_INVERT);
 		DriverBulb_vOutput();
 
 		/* Now initialized */
@@ -169,18 +177,7 @@ PUBLIC bool_t DriverBulb_bReady(void)
  ****************************************************************************/
 PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
 {
-	/* Different value ? */
-	if (u8CurrLevel != (uint8) u32Level)
-	{
-		/* Note the new level */
-		u8CurrLevel = (uint8) MAX(1, u32Level);
-		/* Is the lamp on ? */
-		if (bIsOn)
-		{
-			/* Set outputs */
-			DriverBulb_vOutput();
-		}
-	}
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)), u16CurrRed, u16CurrGreen, u16CurrBlue);
 }
 
 /****************************************************************************
@@ -197,20 +194,145 @@ PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
 
 PUBLIC void DriverBulb_vSetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
 {
-	/* Different value ? */
-	if (u8CurrRed != (uint8) u32Red || u8CurrGreen != (uint8) u32Green || u8CurrBlue != (uint8) u32Blue)
+	DriverBulb_vUpdate(u16CurrLevel,
+					   DIM_EXPAND_12BIT((uint8) u32Red),
+					   DIM_EXPAND_12BIT((uint8) u32Green),
+					   DIM_EXPAND_12BIT((uint8) u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetState
+ *
+ * DESCRIPTION:		Updates level and colour together so a caller changing
+ *                  both programs the outputs only once
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-LAMP_LEVEL_MAX
+ *                  u32Red/Green/Blue     R   Colour 0-255
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)),
+					   DIM_EXPAND_12BIT((uint8) u32Red),
+					   DIM_EXPAND_12BIT((uint8) u32Green),
+					   DIM_EXPAND_12BIT((uint8) u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSet12BitColour, DriverBulb_vSet12BitLevel,
+ *                  DriverBulb_vSet12BitState
+ *
+ * DESCRIPTION:		12 bit equivalents of the above. The extra resolution is
+ *                  dithered onto the PWM by DriverBulb_vTick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-4095
+ *                  u32Red/Green/Blue     R   Colour 0-4095
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSet12BitColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	DriverBulb_vUpdate(u16CurrLevel,
+					   (uint16) MIN(DIM_12BIT_MAX, u32Red),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Green),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Blue));
+}
+
+PUBLIC void DriverBulb_vSet12BitLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)), u16CurrRed, u16CurrGreen, u16CurrBlue);
+}
+
+PUBLIC void DriverBulb_vSet12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Red),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Green),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vLoadSettings
+ *
+ * DESCRIPTION:		Restores the colour calibration saved in PDM, keeping
+ *                  the identity if there is none or it isn't usable
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vLoadSettings(void)
+{
+	tsColourCalibration sSaved;
+	uint16 u16BytesRead;
+
+	if (PDM_eReadDataFromRecord(PDM_ID_APP_COLOUR_CAL, &sSaved, sizeof(sSaved), &u16BytesRead) == PDM_E_STATUS_OK &&
+		u16BytesRead == sizeof(sSaved) && DriverBulb_bValidCalibration(&sSaved))
 	{
-		/* Note the new values */
-		u8CurrRed   = (uint8) u32Red;
-		u8CurrGreen = (uint8) u32Green;
-		u8CurrBlue  = (uint8) u32Blue;
-		/* Is the lamp on ? */
-		if (bIsOn)
-		{
-			/* Set outputs */
-			DriverBulb_vOutput();
-		}
+		sCalibration = sSaved;
+		DriverBulb_vApplyCalibration();
 	}
+
+	DriverBulb_vPwmLoadSettings();
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bCheckColourCalibration
+ *
+ * DESCRIPTION:		Checks a colour calibration is one the driver could take,
+ *                  without changing the calibration in use
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  psCalibration         R   Calibration to check, Q12
+ *
+ * RETURNS:         TRUE if the calibration is in range
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bCheckColourCalibration(const tsColourCalibration *psCalibration)
+{
+	return DriverBulb_bValidCalibration(psCalibration);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bSetColourCalibration
+ *
+ * DESCRIPTION:		Changes the colour calibration matrix and LED gains and
+ *                  saves them in PDM. The outputs are recalculated at once
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  psCalibration         R   New calibration, Q12
+ *
+ * RETURNS:         TRUE if the calibration is in range and was taken
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bSetColourCalibration(const tsColourCalibration *psCalibration)
+{
+	if (DriverBulb_bValidCalibration(psCalibration) == FALSE)
+	{
+		return (FALSE);
+	}
+	sCalibration = *psCalibration;
+	PDM_eSaveRecordData(PDM_ID_APP_COLOUR_CAL, &sCalibration, sizeof(sCalibration));
+
+	DriverBulb_vApplyCalibration();
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vGetColourCalibration
+ *
+ * DESCRIPTION:		Reads back the colour calibration in use
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vGetColourCalibration(tsColourCalibration *psCalibration)
+{
+	*psCalibration = sCalibration;
 }
 
 /****************************************************************************
@@ -276,20 +398,6 @@ PUBLIC bool_t DriverBulb_bOn(void)
 	return (bIsOn);
 }
 
-/****************************************************************************
- *
- * NAMES:           DriverBulb_vTick
- *
- * DESCRIPTION:		Hook for 10 ms Ticks from higher layer for timing
- *                  This currently restores very low dim levels after
- *                  we've started up with sufficient DCI level to ensure
- *                  ignition
- *
- ****************************************************************************/
-PUBLIC void DriverBulb_vTick(void)
-{
-}
-
 /****************************************************************************
  *
  * NAME:			DriverBulb_i16Analogue
@@ -324,47 +432,139 @@ PUBLIC bool_t DriverBulb_bFailed(void)
 	return (FALSE);
 }
 
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vUpdate
+ *
+ * DESCRIPTION:     Notes new 12 bit level and colour values, updating the
+ *                  outputs if they changed
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Red, uint16 u16Green, uint16 u16Blue)
+{
+	/* Different value ? */
+	if (u16CurrLevel != u16Level ||
+		u16CurrRed != u16Red || u16CurrGreen != u16Green || u16CurrBlue != u16Blue)
+	{
+		/* Note the new values */
+		u16CurrLevel = u16Level;
+		u16CurrRed   = u16Red;
+		u16CurrGreen = u16Green;
+		u16CurrBlue  = u16Blue;
+		/* Is the lamp on ? */
+		if (bIsOn)
+		{
+			/* Set outputs */
+			DriverBulb_vOutput();
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bValidCalibration
+ *
+ * DESCRIPTION:     Checks a calibration keeps every matrix entry within
+ *                  +-2.0, so a row of three sums in 32 bits, and no gain
+ *                  drives an LED past full
+ *
+ ****************************************************************************/
+PRIVATE bool_t DriverBulb_bValidCalibration(const tsColourCalibration *psCalibration)
+{
+	uint8 i, j;
+
+	for (i = 0; i < 3; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			if (psCalibration->ai16Matrix[i][j] < -COLOUR_CAL_MATRIX_MAX ||
+				psCalibration->ai16Matrix[i][j] > COLOUR_CAL_MATRIX_MAX)
+			{
+				return (FALSE);
+			}
+		}
+		if (psCalibration->au16Gain[i] > COLOUR_CAL_GAIN_MAX)
+		{
+			return (FALSE);
+		}
+	}
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vApplyCalibration
+ *
+ * DESCRIPTION:     Folds each LED's gain into its row of the matrix and
+ *                  recalculates the outputs
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vApplyCalibration(void)
+{
+	uint8 i, j;
+
+	for (i = 0; i < 3; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			ai32Mix[i][j] = ((int32)sCalibration.ai16Matrix[i][j] * sCalibration.au16Gain[i]) / COLOUR_CAL_ONE;
+		}
+	}
+	if (bIsOn)
+	{
+		DriverBulb_vOutput();
+	}
+}
+
 /****************************************************************************
  *
  * NAME:			DriverBulb_vOutput
  *
- * DESCRIPTION:
+ * DESCRIPTION:     Takes the colour along the dimming curve to linear
+ *                  light, mixes it for the LEDs through the calibration
+ *                  matrix, and scales each for the level
  *
  * RETURNS:         void
  *
  ****************************************************************************/
 PRIVATE void DriverBulb_vOutput(void)
 {
-
-	uint8   u8Red;
-	uint8   u8Green;
-	uint8   u8Blue;
+	uint16  au16Duty[3];
+	int32   ai32Light[3];
+	int32   i32Mix;
+	uint32  u32Level;
+	uint8   i;
 
 	/* Is bulb on ? */
 	if (bIsOn)
 	{
-		/* Scale colour for brightness level */
-		u8Red   = (uint8)(((uint32)u8CurrRed   * (uint32)u8CurrLevel) / (uint32)255);
-		u8Green = (uint8)(((uint32)u8CurrGreen * (uint32)u8CurrLevel) / (uint32)255);
-		u8Blue  = (uint8)(((uint32)u8CurrBlue  * (uint32)u8CurrLevel) / (uint32)255);
-
-		/* Don't allow fully off */
-		if (u8Red   == 0) u8Red   = 1;
-		if (u8Green == 0) u8Green = 1;
-		if (u8Blue  == 0) u8Blue  = 1;
+		/* Colour in linear light, Q16 */
+		ai32Light[E_RED_PWM]   = (int32)DIM_CURVE_LOOKUP12(u16CurrRed);
+		ai32Light[E_GREEN_PWM] = (int32)DIM_CURVE_LOOKUP12(u16CurrGreen);
+		ai32Light[E_BLUE_PWM]  = (int32)DIM_CURVE_LOOKUP12(u16CurrBlue);
+		u32Level = DIM_CURVE_LOOKUP12(u16CurrLevel);
+
+		for (i = 0; i < 3; i++)
+		{
+			/* Calibrate, then scale for brightness level along the dimming curve */
+			i32Mix = ai32Mix[i][E_RED_PWM]   * ai32Light[E_RED_PWM] +
+					 ai32Mix[i][E_GREEN_PWM] * ai32Light[E_GREEN_PWM] +
+					 ai32Mix[i][E_BLUE_PWM]  * ai32Light[E_BLUE_PWM];
+			i32Mix = MIN(MAX(0, i32Mix) >> 12, (1 << DIM_CURVE_BITS) - 1);
+			au16Duty[i] = (uint16)(((uint32)i32Mix * u32Level) >> (2 * DIM_CURVE_BITS - 12));
+
+			/* Don't allow fully off */
+			if (au16Duty[i] < (1 << DIM_12BIT_FRAC_BITS)) au16Duty[i] = (1 << DIM_12BIT_FRAC_BITS);
+		}
 	}
 	else /* Turn off */
 	{
-		u8Red   = 0;
-		u8Green = 0;
-		u8Blue  = 0;
+		au16Duty[E_RED_PWM]   = 0;
+		au16Duty[E_GREEN_PWM] = 0;
+		au16Duty[E_BLUE_PWM]  = 0;
 	}
 
-	/* Set RGB channel levels */
-	vAHI_TimerStartRepeat(PWM_TIMER_RED,   (PWM_COUNT_MAX - u8Red  ), PWM_COUNT_MAX);
-	vAHI_TimerStartRepeat(PWM_TIMER_GREEN, (PWM_COUNT_MAX - u8Green), PWM_COUNT_MAX);
-	vAHI_TimerStartRepeat(PWM_TIMER_BLUE,  (PWM_COUNT_MAX - u8Blue ), PWM_COUNT_MAX);
-
+	DriverBulb_vPwmWrite(au16Duty);
 }
 
 /****************************************************************************/
@@ -0,0 +1,489 @@
+/****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+/* Standard includes */
+#include <string.h>
+/* SDK includes */
+#include <jendefs.h>
+/* Hardware includes */
+#include <AppHardwareApi.h>
+#include <PeripheralRegs.h>
+/* JenOS includes */
+#include <dbg.h>
+/* Device includes */
+#include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_Pwm.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+/* PWM timer configuration */
+#define PERIPHERAL_CLOCK_FREQUENCY_HZ	16000000UL		/* System frequency 16MHz */
+
+
+#define PWM_TIMER_RED					E_AHI_TIMER_1
+#define PWM_TIMER_GREEN					E_AHI_TIMER_2
+#define PWM_TIMER_BLUE					E_AHI_TIMER_3
+#define PWM_TIMER_WHITE					E_AHI_TIMER_4
+
+#define PWM_CHANNELS					4
+
+
+
+#define PWM_INVERT						TRUE
+
+/* Calibration of the white LED: the light it gives at full, as a share of
+ * each of the red, green and blue LEDs at full, in Q12. 4096 on all three
+ * extracts min(R, G, B). Keep each at 1024 or more so the reciprocal
+ * below cannot overflow the 32 bit products */
+#define WHITE_SHARE_RED					4096
+#define WHITE_SHARE_GREEN				4096
+#define WHITE_SHARE_BLUE				4096
+
+/* Balance of each LED's duty, in Q12, to match LEDs of different output */
+#define GAIN_RED						4096
+#define GAIN_GREEN						4096
+#define GAIN_BLUE						4096
+#define GAIN_WHITE						4096
+
+/* Reciprocal of a white share, fixed at compile time, so the white is found
+ * with multiplies and shifts */
+#define WHITE_SHARE_INV(u32Share)		((1UL << 24) / (u32Share))
+
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+enum {E_WHITE_PWM = E_BLUE_PWM + 1};
+
+/* Calibration of one LED */
+typedef struct
+{
+	uint16	u16WhiteShare;		/* white LED's light in this LED's, Q12 */
+	uint32	u32WhiteInv;		/* 2^24 / u16WhiteShare                 */
+	uint16	u16Gain;			/* balance, Q12                         */
+} tsDriverBulb_Channel;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Red, uint16 u16Green, uint16 u16Blue);
+PRIVATE void DriverBulb_vOutput(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Global Variables                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE bool_t  bIsOn      	 	= FALSE;
+
+/* Level and colour are held at 12 bits */
+PRIVATE uint16  u16CurrLevel 	= DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrRed      = DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrGreen    = DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrBlue		= DIM_12BIT_MAX;
+
+PRIVATE const uint8  au8Timer[PWM_CHANNELS]        = { PWM_TIMER_RED, PWM_TIMER_GREEN, PWM_TIMER_BLUE, PWM_TIMER_WHITE };
+PRIVATE const uint32 au32TimerDevice[PWM_CHANNELS] = { E_AHI_DEVICE_TIMER1, E_AHI_DEVICE_TIMER2, E_AHI_DEVICE_TIMER3, E_AHI_DEVICE_TIMER4 };
+
+PRIVATE const tsDriverBulb_Channel asChannel[PWM_CHANNELS] =
+{
+	{ WHITE_SHARE_RED,   WHITE_SHARE_INV(WHITE_SHARE_RED),   GAIN_RED   },
+	{ WHITE_SHARE_GREEN, WHITE_SHARE_INV(WHITE_SHARE_GREEN), GAIN_GREEN },
+	{ WHITE_SHARE_BLUE,  WHITE_SHARE_INV(WHITE_SHARE_BLUE),  GAIN_BLUE  },
+	{ 0,                 0,                                  GAIN_WHITE }
+};
+
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vInit
+ *
+ * DESCRIPTION:		Initializes the lamp drive system
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vInit(void)
+{
+	static bool_t bInit = FALSE;
+
+	/* Not already initialized ? */
+	if (bInit == FALSE)
+	{
+		/* Note light is on */
+		bIsOn = TRUE;
+
+		/* Start the red, green, blue and white PWM timers, then set the first duties */
+		DriverBulb_vPwmInit(PWM_CHANNELS, au8Timer, au32TimerDevice, PWM_INVERT);
+		DriverBulb_vOutput();
+
+		/* Now initialized */
+		bInit = TRUE;
+	}
+}
+
+PUBLIC void DriverBulb_vSetOnOff(bool_t bOn)
+{
+	(bOn) ? DriverBulb_vOn() : DriverBulb_vOff();
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bReady
+ *
+ * DESCRIPTION:		Returns if lamp is ready to be operated
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bReady(void)
+{
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetLevel
+ *
+ * DESCRIPTION:		Updates the PWM via the thermal control loop
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *         	        u8Level  R   Light level 0-LAMP_LEVEL_MAX
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)), u16CurrRed, u16CurrGreen, u16CurrBlue);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetColour
+ *
+ * DESCRIPTION:		Updates the PWM via the thermal control loop
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *         	        u8Level  R   Light level 0-LAMP_LEVEL_MAX
+ *
+ ****************************************************************************/
+
+PUBLIC void DriverBulb_vSetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	DriverBulb_vUpdate(u16CurrLevel,
+					   DIM_EXPAND_12BIT((uint8) u32Red),
+					   DIM_EXPAND_12BIT((uint8) u32Green),
+					   DIM_EXPAND_12BIT((uint8) u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetState
+ *
+ * DESCRIPTION:		Updates level and colour together so a caller changing
+ *                  both programs the outputs only once
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-LAMP_LEVEL_MAX
+ *                  u32Red/Green/Blue     R   Colour 0-255
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)),
+					   DIM_EXPAND_12BIT((uint8) u32Red),
+					   DIM_EXPAND_12BIT((uint8) u32Green),
+					   DIM_EXPAND_12BIT((uint8) u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSet12BitColour, DriverBulb_vSet12BitLevel,
+ *                  DriverBulb_vSet12BitState
+ *
+ * DESCRIPTION:		12 bit equivalents of the above. The extra resolution is
+ *                  dithered onto the PWM by DriverBulb_vTick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-4095
+ *                  u32Red/Green/Blue     R   Colour 0-4095
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSet12BitColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	DriverBulb_vUpdate(u16CurrLevel,
+					   (uint16) MIN(DIM_12BIT_MAX, u32Red),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Green),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Blue));
+}
+
+PUBLIC void DriverBulb_vSet12BitLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)), u16CurrRed, u16CurrGreen, u16CurrBlue);
+}
+
+PUBLIC void DriverBulb_vSet12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Red),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Green),
+					   (uint16) MIN(DIM_12BIT_MAX, u32Blue));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vLoadSettings
+ *
+ * DESCRIPTION:		Restores the PWM frequency profile saved in PDM,
+ *                  keeping the standard profile if there is none
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vLoadSettings(void)
+{
+	DriverBulb_vPwmLoadSettings();
+}
+
+/****************************************************************************
+ *
+ * NAME:            DriverBulb_vOn
+ *
+ * DESCRIPTION:     Turns the lamp on, over-driving if user deep-dimmed
+ *                  before turning off otherwise ignition failures occur
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vOn(void)
+{
+	/* Lamp is not on ? */
+	if (bIsOn != TRUE)
+	{
+		/* Note light is on */
+		bIsOn = TRUE;
+		/* Set outputs */
+		DriverBulb_vOutput();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:            DriverBulb_vOff
+ *
+ * DESCRIPTION:     Turns the lamp off
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vOff(void)
+{
+	/* Lamp is on ? */
+	if (bIsOn == TRUE)
+	{
+		/* Note light is off */
+		bIsOn = FALSE;
+		/* Set outputs */
+		DriverBulb_vOutput();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAMES:           DriverBulb_bOn, u16ReadBusVoltage, u16ReadChipTemperature
+ *
+ * DESCRIPTION:		Access functions for Monitored Lamp Parameters
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ * RETURNS:
+ * Lamp state, Bus Voltage (Volts), Chip Temperature (Degrees C)
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bOn(void)
+{
+	return (bIsOn);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_i16Analogue
+ *
+ * DESCRIPTION:     ADC based measurement of bus voltage is not support in
+ * 					this driver.
+ *
+ * PARAMETERS:      Name	     RW      Usage
+ *                  u8Adc        R       ADC Channel
+ *                  u16AdcRead   R       Raw ADC Value
+ *
+ * RETURNS:         Bus voltage
+ *
+ ****************************************************************************/
+PUBLIC int16 DriverBulb_i16Analogue(uint8 u8Adc, uint16 u16AdcRead)
+{
+	return 0;
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bFailed
+ *
+ * DESCRIPTION:     Access function for Failed bulb state
+ *
+ *
+ * RETURNS:         bulb state
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bFailed(void)
+{
+	return (FALSE);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vUpdate
+ *
+ * DESCRIPTION:     Notes new 12 bit level and colour values, updating the
+ *                  outputs if they changed
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Red, uint16 u16Green, uint16 u16Blue)
+{
+	/* Different value ? */
+	if (u16CurrLevel != u16Level ||
+		u16CurrRed != u16Red || u16CurrGreen != u16Green || u16CurrBlue != u16Blue)
+	{
+		/* Note the new values */
+		u16CurrLevel = u16Level;
+		u16CurrRed   = u16Red;
+		u16CurrGreen = u16Green;
+		u16CurrBlue  = u16Blue;
+		/* Is the lamp on ? */
+		if (bIsOn)
+		{
+			/* Set outputs */
+			DriverBulb_vOutput();
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vOutput
+ *
+ * DESCRIPTION:     Takes the white the colour holds out onto the white LED.
+ *                  The colour is taken along the dimming curve to linear
+ *                  light first, where the white is the least of the
+ *                  channels over their white shares, and that white's share
+ *                  is taken back off each. The shares' reciprocals are in
+ *                  the channel table, so there is no division. Each LED
+ *                  is then scaled for the level and its balance.
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vOutput(void)
+{
+	uint16  au16Duty[PWM_CHANNELS];
+	uint32  au32Light[PWM_CHANNELS];
+	uint32  u32Level;
+	uint32  u32White;
+	uint8   i;
+
+	/* Is bulb on ? */
+	if (bIsOn)
+	{
+		/* Colour in linear light, Q16 */
+		au32Light[E_RED_PWM]   = DIM_CURVE_LOOKUP12(u16CurrRed);
+		au32Light[E_GREEN_PWM] = DIM_CURVE_LOOKUP12(u16CurrGreen);
+		au32Light[E_BLUE_PWM]  = DIM_CURVE_LOOKUP12(u16CurrBlue);
+
+		/* White the colour holds, in white LED light, and what is left */
+		u32White = (au32Light[E_RED_PWM] * asChannel[E_RED_PWM].u32WhiteInv) >> 12;
+		for (i = E_GREEN_PWM; i <= E_BLUE_PWM; i++)
+		{
+			u32White = MIN(u32White, (au32Light[i] * asChannel[i].u32WhiteInv) >> 12);
+		}
+		u32White = MIN(u32White, (1 << DIM_CURVE_BITS) - 1);
+		for (i = E_RED_PWM; i <= E_BLUE_PWM; i++)
+		{
+			au32Light[i] -= MIN(au32Light[i], (u32White * asChannel[i].u16WhiteShare) >> 12);
+		}
+		au32Light[E_WHITE_PWM] = u32White;
+
+		/* Scale for brightness level along the dimming curve and balance,
+		 * Q16 light by Q12 gain down to a 12 bit duty */
+		u32Level = DIM_CURVE_LOOKUP12(u16CurrLevel);
+		for (i = 0; i < PWM_CHANNELS; i++)
+		{
+			au16Duty[i] = (uint16)((((au32Light[i] * u32Level) >> DIM_CURVE_BITS) * asChannel[i].u16Gain) >> DIM_CURVE_BITS);
+		}
+
+		/* Don't allow the colour fully off */
+		for (i = E_RED_PWM; i <= E_BLUE_PWM; i++)
+		{
+			if (au16Duty[i] < (1 << DIM_12BIT_FRAC_BITS)) au16Duty[i] = (1 << DIM_12BIT_FRAC_BITS);
+		}
+	}
+	else /* Turn off */
+	{
+		for (i = 0; i < PWM_CHANNELS; i++)
+		{
+			au16Duty[i] = 0;
+		}
+	}
+
+	DriverBulb_vPwmWrite(au16Duty);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -27,9 +27,12 @@
 #include <PeripheralRegs.h>
 /* JenOS includes */
 #include <dbg.h>
+#include "pdm.h"
 /* Application includes */
+#include "PDM_IDs.h"
 /* Device includes */
 #include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
@@ -40,14 +43,72 @@
 #define PWM_TIMER_PRESCALE				6     			/* Prescale value to use   */
 #define N_LEDS 							26
 
+/* SPI clock is the 16MHz clock divided by twice a divider of 1-255 */
+#define SPI_MIN_HZ						((PERIPHERAL_CLOCK_FREQUENCY_HZ / 2 + 254) / 255)
+#define SPI_MAX_HZ						(PERIPHERAL_CLOCK_FREQUENCY_HZ / 2)
+
+/* RAM is reserved for strips up to STRIP_MAX_LEDS long. Until a profile
+ * is loaded from PDM an LPD8806 strip of N_LEDS is driven */
+#ifndef STRIP_MAX_LEDS
+#define STRIP_MAX_LEDS					160
+#endif
+#define STRIP_SEGMENTS					4
+
+/* A frame is a header of zero bytes, up to 4 bytes per LED and a latch of
+ * zero bytes, one per u8LatchLeds LEDs. The SPI interrupt chains it out
+ * 32 bits at a time */
+#define STRIP_MAX_LED_BYTES				4
+#define STRIP_MAX_HEADER_BYTES			4
+#define STRIP_MAX_LATCH_BYTES			((STRIP_MAX_LEDS + 15) / 16)
+#define STRIP_MAX_FRAME_BYTES			(STRIP_MAX_HEADER_BYTES + STRIP_MAX_LEDS * STRIP_MAX_LED_BYTES + STRIP_MAX_LATCH_BYTES)
+#define DIRTY_WORDS(u16Leds)			(((u16Leds) + 31) / 32)
+
+/* APA102 LED frames start with 3 set bits and a 5 bit global brightness */
+#define APA102_LED_START				0xFF
+
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
+typedef struct
+{
+	uint8	u8Red;
+	uint8	u8Green;
+	uint8	u8Blue;
+} tsPixel;
+
+typedef struct
+{
+	uint16	u16First;
+	uint16	u16Count;
+} tsSegment;
+
+/* How a chip is sent its colours. Each colour byte is
+ * MAX(u8Min, u8Mark | colour scaled to u8Bits), so one encoder with these
+ * parameters serves every chip */
+typedef struct
+{
+	uint8	u8LedBytes;
+	uint8	u8ColourOffset;		/* colour bytes after an LED start byte */
+	uint8	u8HeaderBytes;
+	uint8	u8LatchLeds;		/* LEDs per latch byte, 0 for no latch */
+	uint8	u8Bits;
+	uint8	u8Mark;
+	uint8	u8Min;				/* lowest byte sent while on */
+	bool_t	bChain;				/* FALSE if frames must be gapped to latch */
+} tsStripChip;
 
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
+PRIVATE bool_t DriverBulb_bValidProfile(const tsStripProfile *psProfile);
+PRIVATE void DriverBulb_vApplyProfile(void);
+PRIVATE void DriverBulb_vPaint(uint16 u16First, uint16 u16Count, uint32 u32Red, uint32 u32Green, uint32 u32Blue);
+PRIVATE void DriverBulb_vMarkAll(void);
 PRIVATE void DriverBulb_vOutput(void);
+PRIVATE void DriverBulb_vEncode(uint8 *pu8Frame, uint32 *pu32Dirty);
+PRIVATE void DriverBulb_vStartFrame(void);
+PRIVATE void DriverBulb_vSendWord(void);
+PRIVATE void DriverBulb_vSpiCallback(uint32 u32Device, uint32 u32ItemBitmap);
 
 /****************************************************************************/
 /***        Exported Variables                                            ***/
@@ -60,13 +121,67 @@ PRIVATE void DriverBulb_vOutput(void);
 /****************************************************************************/
 /***        Local Variables                                               ***/
 /****************************************************************************/
+PRIVATE const tsStripChip asStripChip[E_STRIP_NUM_CHIPS] =
+{
+	/* LPD8806: 7 bit GRB with the top bit set, a zero byte latches 32 LEDs */
+	[E_STRIP_LPD8806] = { .u8LedBytes = 3, .u8ColourOffset = 0, .u8HeaderBytes = 0, .u8LatchLeds = 32,
+						  .u8Bits = 7, .u8Mark = 0x80, .u8Min = 129, .bChain = TRUE },
+	/* WS2801: 8 bit RGB, latched by holding the clock low for 500us */
+	[E_STRIP_WS2801]  = { .u8LedBytes = 3, .u8ColourOffset = 0, .u8HeaderBytes = 0, .u8LatchLeds = 0,
+						  .u8Bits = 8, .u8Mark = 0x00, .u8Min = 0,   .bChain = FALSE },
+	/* APA102: 32 zero bits, then a start byte and 8 bit BGR per LED, and
+	 * a clock edge for every 2 LEDs to shift the data to the end */
+	[E_STRIP_APA102]  = { .u8LedBytes = 4, .u8ColourOffset = 1, .u8HeaderBytes = 4, .u8LatchLeds = 16,
+						  .u8Bits = 8, .u8Mark = 0x00, .u8Min = 0,   .bChain = TRUE },
+};
+
+/* Offsets of red, green and blue within an LED for each byte order */
+PRIVATE const uint8 au8StripOrder[E_STRIP_NUM_ORDERS][3] =
+{
+	[E_STRIP_ORDER_RGB] = { 0, 1, 2 },
+	[E_STRIP_ORDER_RBG] = { 0, 2, 1 },
+	[E_STRIP_ORDER_GRB] = { 1, 0, 2 },
+	[E_STRIP_ORDER_GBR] = { 2, 0, 1 },
+	[E_STRIP_ORDER_BRG] = { 1, 2, 0 },
+	[E_STRIP_ORDER_BGR] = { 2, 1, 0 },
+};
+
+/* Strip profile, and the frame layout worked out from it */
+PRIVATE tsStripProfile sProfile = { .u16NumLeds = N_LEDS,
+									.u8Chip     = E_STRIP_LPD8806,
+									.u8Order    = E_STRIP_ORDER_GRB,
+									.u32SpiHz   = SPI_FREQUENCY_HZ };
+PRIVATE const tsStripChip *psChip = &asStripChip[E_STRIP_LPD8806];
+PRIVATE uint8   au8Offset[3];
+PRIVATE uint16  u16FrameBytes;
+PRIVATE bool_t  bProfileChanged	= FALSE;
+
 PRIVATE bool_t  bIsOn      	 	= FALSE;
 PRIVATE uint8   u8CurrLevel 	= 127;
+PRIVATE uint32  u32OutputCount	= 0;
 
+/* Colour last set for the whole strip */
 PRIVATE uint8   u8CurrRed       = 64;
 PRIVATE uint8   u8CurrGreen     = 64;
 PRIVATE uint8   u8CurrBlue		= 64;
 
+/* Framebuffer and segment map */
+PRIVATE uint16  u16NumLeds		= 0;
+PRIVATE tsPixel asPixel[STRIP_MAX_LEDS];
+PRIVATE tsSegment asSegment[STRIP_SEGMENTS];
+
+/* Double buffered frames. The interrupt owns au8Frame[u8TxFrame] while
+ * bBusy is set, the task owns the other buffer while bPending is clear.
+ * Each buffer has its own map of the pixels changed since it was last
+ * encoded, so only those are encoded into it */
+PRIVATE uint8   		au8Frame[2][STRIP_MAX_FRAME_BYTES];
+PRIVATE uint32  		au32Dirty[2][DIRTY_WORDS(STRIP_MAX_LEDS)];
+PRIVATE bool_t			bDirty		= FALSE;
+PRIVATE volatile uint8  u8TxFrame	= 0;
+PRIVATE volatile uint16 u16TxByte	= 0;
+PRIVATE volatile bool_t bBusy		= FALSE;
+PRIVATE volatile bool_t bPending	= FALSE;
+
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -91,16 +206,11 @@ PUBLIC void DriverBulb_vInit(void)
 	/* Not already initialized ? */
 	if (bInit == FALSE)
 	{
-		uint8 divider = (PERIPHERAL_CLOCK_FREQUENCY_HZ / 2) / SPI_FREQUENCY_HZ;
-		/* Enable SPI */
-		vAHI_SpiConfigure(1, /* 1 Slave device */
-						  FALSE, /* MSB FIRST */
-						  FALSE, /* Normal Polarity */
-						  FALSE, /* Leading edge latch */
-						  divider, /* 2x8 = 16MHz, Divide 16MHz clk to get 1MHz spi clk */
-						  TRUE, /* Enable Interrupts */
-						  FALSE); /* Disable auto slave select */
+		/* Frames are chained from the transfer complete interrupt */
+		vAHI_SpiRegisterCallback(DriverBulb_vSpiCallback);
 
+		/* Lay out the default strip; PDM is not up yet to hold another */
+		DriverBulb_vApplyProfile();
 
 		/* Note light is on */
 		bIsOn = TRUE;
@@ -149,18 +259,7 @@ PUBLIC bool_t DriverBulb_bReady(void)
  ****************************************************************************/
 PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
 {
-	/* Different value ? */
-	if (u8CurrLevel != (uint8) u32Level)
-	{
-		/* Note the new level */
-		u8CurrLevel = (uint8) MAX(1, u32Level);
-		/* Is the lamp on ? */
-		if (bIsOn)
-		{
-			/* Set outputs */
-			DriverBulb_vOutput();
-		}
-	}
+	DriverBulb_vSetState(u32Level, u8CurrRed, u8CurrGreen, u8CurrBlue, 0);
 }
 
 /****************************************************************************
@@ -177,20 +276,194 @@ PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
 
 PUBLIC void DriverBulb_vSetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
 {
-	/* Different value ? */
+	DriverBulb_vSetState(u8CurrLevel, u32Red, u32Green, u32Blue, 0);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetState
+ *
+ * DESCRIPTION:		Updates level and colour together so a caller changing
+ *                  both programs the outputs only once. A new colour is
+ *                  painted over every pixel, a new level alone keeps the
+ *                  pixel colours
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-LAMP_LEVEL_MAX
+ *                  u32Red/Green/Blue     R   Colour 0-255
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	/* Different colour ? */
 	if (u8CurrRed != (uint8) u32Red || u8CurrGreen != (uint8) u32Green || u8CurrBlue != (uint8) u32Blue)
 	{
 		/* Note the new values */
 		u8CurrRed   = (uint8) u32Red;
 		u8CurrGreen = (uint8) u32Green;
 		u8CurrBlue  = (uint8) u32Blue;
-		/* Is the lamp on ? */
-		if (bIsOn)
-		{
-			/* Set outputs */
-			DriverBulb_vOutput();
-		}
+		DriverBulb_vPaint(0, u16NumLeds, u32Red, u32Green, u32Blue);
+	}
+	/* Different level ? Every pixel is rescaled */
+	if (u8CurrLevel != (uint8) MAX(1, u32Level))
+	{
+		u8CurrLevel = (uint8) MAX(1, u32Level);
+		DriverBulb_vMarkAll();
+	}
+	/* Is the lamp on ? */
+	if (bIsOn && bDirty)
+	{
+		/* Set outputs */
+		DriverBulb_vOutput();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetPixel
+ *
+ * DESCRIPTION:		Sets the colour of a single pixel. Pixel changes are
+ *                  sent together at the next tick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u16Pixel              R   Pixel, 0 nearest the controller
+ *                  u32Red/Green/Blue     R   Colour 0-255
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetPixel(uint16 u16Pixel, uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	if (u16Pixel < u16NumLeds)
+	{
+		DriverBulb_vPaint(u16Pixel, 1, u32Red, u32Green, u32Blue);
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetSegmentColour
+ *
+ * DESCRIPTION:		Sets the colour of every pixel in a segment, sent at
+ *                  the next tick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u8Segment             R   Segment 0-STRIP_SEGMENTS-1
+ *                  u32Red/Green/Blue     R   Colour 0-255
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetSegmentColour(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	if (u8Segment < STRIP_SEGMENTS)
+	{
+		DriverBulb_vPaint(asSegment[u8Segment].u16First, asSegment[u8Segment].u16Count, u32Red, u32Green, u32Blue);
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bMapSegment
+ *
+ * DESCRIPTION:		Maps a segment onto a run of pixels. Segments may
+ *                  overlap, or be left empty with a zero count
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u8Segment             R   Segment 0-STRIP_SEGMENTS-1
+ *                  u16First              R   First pixel of the segment
+ *                  u16Count              R   Number of pixels
+ *
+ * RETURNS:         TRUE if the segment lies on the strip and was mapped
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bMapSegment(uint8 u8Segment, uint16 u16First, uint16 u16Count)
+{
+	if (u8Segment >= STRIP_SEGMENTS || u16First > u16NumLeds || u16Count > u16NumLeds - u16First)
+	{
+		return (FALSE);
+	}
+	asSegment[u8Segment].u16First = u16First;
+	asSegment[u8Segment].u16Count = u16Count;
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vLoadSettings
+ *
+ * DESCRIPTION:		Restores the strip profile saved in PDM, keeping the
+ *                  default if there is none or it isn't usable
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vLoadSettings(void)
+{
+	tsStripProfile sSaved;
+	uint16 u16BytesRead;
+
+	if (PDM_eReadDataFromRecord(PDM_ID_APP_STRIP_PROFILE, &sSaved, sizeof(sSaved), &u16BytesRead) == PDM_E_STATUS_OK &&
+		u16BytesRead == sizeof(sSaved) && DriverBulb_bValidProfile(&sSaved))
+	{
+		sProfile = sSaved;
+		bProfileChanged = TRUE;
+		DriverBulb_vTick();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bCheckStripProfile
+ *
+ * DESCRIPTION:		Checks a profile is one the driver could take, without
+ *                  changing the profile in use
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  psProfile             R   Profile to check
+ *
+ * RETURNS:         TRUE if the profile is usable
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bCheckStripProfile(const tsStripProfile *psProfile)
+{
+	return DriverBulb_bValidProfile(psProfile);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bSetStripProfile
+ *
+ * DESCRIPTION:		Changes the length, chip, byte order and SPI clock of
+ *                  the strip and saves them in PDM. The frame being sent
+ *                  is finished first, so the change can take effect up to
+ *                  a tick later
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  psProfile             R   New profile
+ *
+ * RETURNS:         TRUE if the profile is usable and was taken
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bSetStripProfile(const tsStripProfile *psProfile)
+{
+	if (DriverBulb_bValidProfile(psProfile) == FALSE)
+	{
+		return (FALSE);
 	}
+	sProfile = *psProfile;
+	PDM_eSaveRecordData(PDM_ID_APP_STRIP_PROFILE, &sProfile, sizeof(sProfile));
+
+	bProfileChanged = TRUE;
+	DriverBulb_vTick();
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vGetStripProfile
+ *
+ * DESCRIPTION:		Reads back the strip profile in use
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vGetStripProfile(tsStripProfile *psProfile)
+{
+	*psProfile = sProfile;
 }
 
 /****************************************************************************
@@ -209,6 +482,7 @@ PUBLIC void DriverBulb_vOn(void)
 		/* Note light is on */
 		bIsOn = TRUE;
 		/* Set outputs */
+		DriverBulb_vMarkAll();
 		DriverBulb_vOutput();
 	}
 }
@@ -234,6 +508,7 @@ PUBLIC void DriverBulb_vOff(void)
 		/* Note light is off */
 		bIsOn = FALSE;
 		/* Set outputs */
+		DriverBulb_vMarkAll();
 		DriverBulb_vOutput();
 	}
 }
@@ -256,18 +531,62 @@ PUBLIC bool_t DriverBulb_bOn(void)
 	return (bIsOn);
 }
 
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_u32GetOutputCount
+ *
+ * DESCRIPTION:     Number of times the outputs have been programmed since
+ *                  initialisation, used to measure the hardware write rate
+ *
+ * RETURNS:         Free running output count
+ *
+ ****************************************************************************/
+PUBLIC uint32 DriverBulb_u32GetOutputCount(void)
+{
+	return (u32OutputCount);
+}
+
 /****************************************************************************
  *
  * NAMES:           DriverBulb_vTick
  *
  * DESCRIPTION:		Hook for 10 ms Ticks from higher layer for timing
- *                  This currently restores very low dim levels after
- *                  we've started up with sufficient DCI level to ensure
- *                  ignition
+ *                  Sends the pixels and segments changed since the last
+ *                  frame as one frame. A new profile is laid out once the
+ *                  SPI is idle, and chips that latch on a gap in the clock
+ *                  have their frames started here
  *
  ****************************************************************************/
 PUBLIC void DriverBulb_vTick(void)
 {
+	/* Nothing is in flight while bBusy is clear, so no interrupt can race */
+	if (bProfileChanged && bBusy == FALSE)
+	{
+		bProfileChanged = FALSE;
+		DriverBulb_vApplyProfile();
+		DriverBulb_vOutput();
+	}
+	else if (bIsOn && bDirty)
+	{
+		DriverBulb_vOutput();
+	}
+	if (bPending && bBusy == FALSE)
+	{
+		DriverBulb_vStartFrame();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bTickPending
+ *
+ * DESCRIPTION:     Whether a changed profile, changed pixels or a frame
+ *                  waiting on the SPI still need the tick
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bTickPending(void)
+{
+	return (bProfileChanged || (bIsOn && bDirty) || bPending);
 }
 
 /****************************************************************************
@@ -304,64 +623,318 @@ PUBLIC bool_t DriverBulb_bFailed(void)
 	return (FALSE);
 }
 
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bValidProfile
+ *
+ * DESCRIPTION:     Checks a profile can be driven with the RAM reserved
+ *                  and the SPI clocks available
+ *
+ * RETURNS:         TRUE if usable
+ *
+ ****************************************************************************/
+PRIVATE bool_t DriverBulb_bValidProfile(const tsStripProfile *psProfile)
+{
+	return (psProfile->u16NumLeds > 0 && psProfile->u16NumLeds <= STRIP_MAX_LEDS &&
+			psProfile->u8Chip < E_STRIP_NUM_CHIPS && psProfile->u8Order < E_STRIP_NUM_ORDERS &&
+			psProfile->u32SpiHz >= SPI_MIN_HZ && psProfile->u32SpiHz <= SPI_MAX_HZ);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vApplyProfile
+ *
+ * DESCRIPTION:     Works out the frame layout for the profile, writes the
+ *                  parts of it that never change into both frame buffers,
+ *                  sets the SPI clock and splits the strip into equal
+ *                  segments. Called with the SPI idle
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vApplyProfile(void)
+{
+	uint8  u8Divider = (uint8)((PERIPHERAL_CLOCK_FREQUENCY_HZ / 2) / sProfile.u32SpiHz);
+	uint16 u16Led;
+	uint8  u8Segment;
+	uint8  i;
+
+	psChip     = &asStripChip[sProfile.u8Chip];
+	u16NumLeds = sProfile.u16NumLeds;
+	for (i = 0; i < 3; i++)
+	{
+		au8Offset[i] = psChip->u8HeaderBytes + psChip->u8ColourOffset + au8StripOrder[sProfile.u8Order][i];
+	}
+	u16FrameBytes = psChip->u8HeaderBytes + u16NumLeds * psChip->u8LedBytes;
+	if (psChip->u8LatchLeds)
+	{
+		u16FrameBytes += (u16NumLeds + psChip->u8LatchLeds - 1) / psChip->u8LatchLeds;
+	}
+
+	/* Header and latch are zero, LED start bytes are fixed */
+	memset(au8Frame, 0, sizeof(au8Frame));
+	if (psChip->u8ColourOffset)
+	{
+		for (u16Led = 0; u16Led < u16NumLeds; u16Led++)
+		{
+			au8Frame[0][psChip->u8HeaderBytes + u16Led * psChip->u8LedBytes] = APA102_LED_START;
+			au8Frame[1][psChip->u8HeaderBytes + u16Led * psChip->u8LedBytes] = APA102_LED_START;
+		}
+	}
+
+	vAHI_SpiConfigure(1, /* 1 Slave device */
+					  FALSE, /* MSB FIRST */
+					  FALSE, /* Normal Polarity */
+					  FALSE, /* Leading edge latch */
+					  MAX(1, u8Divider), /* Divide 16MHz clk by twice this for the spi clk */
+					  TRUE, /* Enable Interrupts */
+					  FALSE); /* Disable auto slave select */
+
+	/* Split the strip into equal segments */
+	for (u8Segment = 0; u8Segment < STRIP_SEGMENTS; u8Segment++)
+	{
+		asSegment[u8Segment].u16First = (u8Segment * u16NumLeds) / STRIP_SEGMENTS;
+		asSegment[u8Segment].u16Count = ((u8Segment + 1) * u16NumLeds) / STRIP_SEGMENTS - asSegment[u8Segment].u16First;
+	}
+
+	/* The whole strip takes the colour of the light, and all of it is
+	 * encoded into the next frame */
+	bPending = FALSE;
+	DriverBulb_vPaint(0, u16NumLeds, u8CurrRed, u8CurrGreen, u8CurrBlue);
+	DriverBulb_vMarkAll();
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vPaint
+ *
+ * DESCRIPTION:     Sets a run of pixels to one colour, marking those that
+ *                  change for encoding into both frame buffers
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vPaint(uint16 u16First, uint16 u16Count, uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	tsPixel *psPixel = &asPixel[u16First];
+	uint16   u16Pixel;
+
+	for (u16Pixel = u16First; u16Pixel < u16First + u16Count; u16Pixel++, psPixel++)
+	{
+		if (psPixel->u8Red != (uint8) u32Red || psPixel->u8Green != (uint8) u32Green || psPixel->u8Blue != (uint8) u32Blue)
+		{
+			psPixel->u8Red   = (uint8) u32Red;
+			psPixel->u8Green = (uint8) u32Green;
+			psPixel->u8Blue  = (uint8) u32Blue;
+			au32Dirty[0][u16Pixel >> 5] |= (1UL << (u16Pixel & 31));
+			au32Dirty[1][u16Pixel >> 5] |= (1UL << (u16Pixel & 31));
+			bDirty = TRUE;
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vMarkAll
+ *
+ * DESCRIPTION:     Marks every pixel for encoding, for a change of level or
+ *                  on/off state which rescales them all
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vMarkAll(void)
+{
+	uint16 u16Word;
+
+	for (u16Word = 0; u16Word < u16NumLeds / 32; u16Word++)
+	{
+		au32Dirty[0][u16Word] = 0xFFFFFFFFUL;
+		au32Dirty[1][u16Word] = 0xFFFFFFFFUL;
+	}
+	if (u16NumLeds & 31)
+	{
+		au32Dirty[0][u16Word] = (1UL << (u16NumLeds & 31)) - 1;
+		au32Dirty[1][u16Word] = (1UL << (u16NumLeds & 31)) - 1;
+		u16Word++;
+	}
+	/* Nothing past the end, after a profile shortens the strip */
+	for (; u16Word < DIRTY_WORDS(STRIP_MAX_LEDS); u16Word++)
+	{
+		au32Dirty[0][u16Word] = 0;
+		au32Dirty[1][u16Word] = 0;
+	}
+	bDirty = TRUE;
+}
+
 /****************************************************************************
  *
  * NAME:			DriverBulb_vOutput
  *
- * DESCRIPTION:
+ * DESCRIPTION:     Encodes the changed pixels into the free frame buffer
+ *                  and queues it for transmission. Returns without waiting
+ *                  for the SPI; a frame still queued when the next one is
+ *                  encoded is superseded by it
  *
  * RETURNS:         void
  *
  ****************************************************************************/
 PRIVATE void DriverBulb_vOutput(void)
 {
+	uint8 u8Back;
+
+	/* Take back the queued frame, the interrupt won't start it now */
+	bPending = FALSE;
+	u8Back   = u8TxFrame ^ 1;
 
-	uint32   u32Red;
-	uint32   u32Green;
-	uint32   u32Blue;
-	uint32  u32Color;
-	uint8 i;
+	DriverBulb_vEncode(au8Frame[u8Back], au32Dirty[u8Back]);
 
-	/* LED Strip based on LPD8806 only supports Color values from 128->255 */
+	/* Changes remain marked for the other buffer until it's encoded */
+	bDirty = FALSE;
 
-	/* Is bulb on ? */
-	if (bIsOn)
+	/* Queue it, starting the SPI if it's idle. Chips that need a gap to
+	 * latch have their frames started from the tick */
+	bPending = TRUE;
+	if (bBusy == FALSE && psChip->bChain)
 	{
-		/* Scale colour for brightness level */
-		u32Red   = 128 + (uint8)(((uint32)u8CurrRed   * (uint32)u8CurrLevel) / (uint32)255);
-		u32Green = 128 + (uint8)(((uint32)u8CurrGreen * (uint32)u8CurrLevel) / (uint32)255);
-		u32Blue  = 128 + (uint8)(((uint32)u8CurrBlue  * (uint32)u8CurrLevel) / (uint32)255);
-
-		/* Don't allow fully off */
-		if (u32Red   == 128) u32Red   = 129;
-		if (u32Green == 128) u32Green = 129;
-		if (u32Blue  == 128) u32Blue  = 129;
+		DriverBulb_vStartFrame();
 	}
-	else /* Turn off */
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vEncode
+ *
+ * DESCRIPTION:     Encodes the marked pixels into a frame buffer, scaling
+ *                  each colour for brightness along the dimming curve.
+ *                  Everything that depends on the chip and on/off state
+ *                  is settled before the loop
+ *
+ * PARAMETERS:      Name	        RW      Usage
+ *                  pu8Frame        W       Frame buffer
+ *                  pu32Dirty       RW      Its changed pixel map, cleared
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vEncode(uint8 *pu8Frame, uint32 *pu32Dirty)
+{
+	uint32   u32Dirty;
+	uint16   u16Word;
+	uint16   u16Pixel;
+	tsPixel *psPixel;
+	uint8   *pu8Out;
+	uint8    u8Level = bIsOn ? u8CurrLevel : 0;
+	uint8    u8Min   = bIsOn ? psChip->u8Min : psChip->u8Mark;
+	uint8    u8Mark  = psChip->u8Mark;
+	uint8    u8Bits  = psChip->u8Bits;
+	uint8    u8Step  = psChip->u8LedBytes;
+	uint8    u8R     = au8Offset[0];
+	uint8    u8G     = au8Offset[1];
+	uint8    u8B     = au8Offset[2];
+
+	for (u16Word = 0; u16Word < DIRTY_WORDS(u16NumLeds); u16Word++)
 	{
-		u32Red   = 128;
-		u32Green = 128;
-		u32Blue  = 128;
+		u32Dirty = pu32Dirty[u16Word];
+		pu32Dirty[u16Word] = 0;
+
+		for (u16Pixel = u16Word * 32; u32Dirty != 0; u16Pixel++, u32Dirty >>= 1)
+		{
+			if ((u32Dirty & 1) == 0)
+			{
+				continue;
+			}
+			psPixel = &asPixel[u16Pixel];
+			pu8Out  = &pu8Frame[u16Pixel * u8Step];
+
+			/* Level 0 scales to nothing, the LPD8806 minimum of 129 keeps
+			 * it from going fully off while on */
+			pu8Out[u8R] = (uint8) MAX(u8Min, u8Mark | DIM_CURVE_SCALE(psPixel->u8Red,   u8Level, u8Bits));
+			pu8Out[u8G] = (uint8) MAX(u8Min, u8Mark | DIM_CURVE_SCALE(psPixel->u8Green, u8Level, u8Bits));
+			pu8Out[u8B] = (uint8) MAX(u8Min, u8Mark | DIM_CURVE_SCALE(psPixel->u8Blue,  u8Level, u8Bits));
+		}
 	}
+}
 
-	/* Strip format is GRB */
-	u32Color = (u32Green << 16) | (u32Red << 8) | u32Blue;
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vStartFrame
+ *
+ * DESCRIPTION:     Makes the queued frame the one being transmitted and
+ *                  sends its first word. Called with the SPI idle, from the
+ *                  task or from the end of the previous frame
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vStartFrame(void)
+{
+	bPending  = FALSE;
+	bBusy     = TRUE;
+	u8TxFrame ^= 1;
+	u16TxByte = 0;
+	u32OutputCount++;
 
-	/* Clear Strip */
-	for(i = 0; i < N_LEDS/32; i = i + 1) {
-		vAHI_SpiStartTransfer(8, 0);
-		vAHI_SpiWaitBusy();
-	}
+	DriverBulb_vSendWord();
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vSendWord
+ *
+ * DESCRIPTION:     Starts the transfer of the next 4 bytes of the frame,
+ *                  fewer at the end of the frame
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vSendWord(void)
+{
+	const uint8 *pu8Byte = &au8Frame[u8TxFrame][u16TxByte];
+	uint8  u8Bytes = MIN(4, u16FrameBytes - u16TxByte);
+	uint32 u32Word = 0;
+	uint8  i;
 
-	/* Set RGB channel levels */
-	for(i = 0; i < N_LEDS; i = i + 1) {
-		vAHI_SpiStartTransfer(24, u32Color);
-		vAHI_SpiWaitBusy();
+	for (i = 0; i < u8Bytes; i++)
+	{
+		u32Word = (u32Word << 8) | pu8Byte[i];
 	}
+	u16TxByte += u8Bytes;
 
+	vAHI_SpiStartTransfer(u8Bytes * 8, u32Word);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vSpiCallback
+ *
+ * DESCRIPTION:     SPI transfer complete interrupt. Chains the rest of the
+ *                  frame, then starts the queued frame if there is one and
+ *                  the chip latches without a gap
+ *
+ * PARAMETERS:      Name	        RW      Usage
+ *                  u32Device       R       Interrupting device
+ *                  u32ItemBitmap   R       Interrupt source
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vSpiCallback(uint32 u32Device, uint32 u32ItemBitmap)
+{
+	if (u16TxByte < u16FrameBytes)
+	{
+		DriverBulb_vSendWord();
+	}
+	else if (bPending && psChip->bChain)
+	{
+		DriverBulb_vStartFrame();
+	}
+	else
+	{
+		bBusy = FALSE;
+	}
 }
 
 /****************************************************************************/
 /***        END OF FILE                                                   ***/
 /****************************************************************************/
-
@@ -0,0 +1,447 @@
+/****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+/* Standard includes */
+#include <string.h>
+/* SDK includes */
+#include <jendefs.h>
+/* Hardware includes */
+#include <AppHardwareApi.h>
+#include <PeripheralRegs.h>
+/* JenOS includes */
+#include <dbg.h>
+/* Device includes */
+#include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_Pwm.h"
+#include "DriverBulb_MiredTable.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+/* PWM timer configuration */
+#define PERIPHERAL_CLOCK_FREQUENCY_HZ	16000000UL		/* System frequency 16MHz */
+
+
+/* Channel definitions */
+#define PWM_TIMER_WARM					E_AHI_TIMER_3
+#define PWM_TIMER_COOL					E_AHI_TIMER_4
+
+#define PWM_CHANNELS					2
+
+
+#define PWM_INVERT						FALSE
+
+/* Colour temperature until the first one arrives, 4000K */
+#define MIRED_DEFAULT					250
+
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+enum {E_WARM_PWM, E_COOL_PWM};
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Mired);
+PRIVATE void DriverBulb_vOutput(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Global Variables                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE bool_t  bIsOn      	 	= FALSE;
+
+/* Level is held at 12 bits, colour temperature in mired */
+PRIVATE uint16  u16CurrLevel 	= DIM_12BIT_MAX;
+PRIVATE uint16  u16CurrMired	= MIRED_DEFAULT;
+
+PRIVATE const uint8  au8Timer[PWM_CHANNELS]        = { PWM_TIMER_WARM, PWM_TIMER_COOL };
+PRIVATE const uint32 au32TimerDevice[PWM_CHANNELS] = { E_AHI_DEVICE_TIMER3, E_AHI_DEVICE_TIMER4 };
+
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vInit
+ *
+ * DESCRIPTION:		Initializes the lamp drive system
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vInit(void)
+{
+	static bool_t bInit = FALSE;
+
+	/* Not already initialized ? */
+	if (bInit == FALSE)
+	{
+		/* Note light is on */
+		bIsOn = TRUE;
+
+		/* Start the warm and cool white PWM timers, then set the first duties */
+		DriverBulb_vPwmInit(PWM_CHANNELS, au8Timer, au32TimerDevice, PWM_INVERT);
+		DriverBulb_vOutput();
+
+		/* Now initialized */
+		bInit = TRUE;
+	}
+}
+
+PUBLIC void DriverBulb_vSetOnOff(bool_t bOn)
+{
+	(bOn) ? DriverBulb_vOn() : DriverBulb_vOff();
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bReady
+ *
+ * DESCRIPTION:		Returns if lamp is ready to be operated
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bReady(void)
+{
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetLevel
+ *
+ * DESCRIPTION:		Updates the PWM via the thermal control loop
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *         	        u8Level  R   Light level 0-LAMP_LEVEL_MAX
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)), u16CurrMired);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetTunableWhiteColourTemperature
+ *
+ * DESCRIPTION:		Moves the white point, keeping the light output
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  i32ColourTemperature  R   Colour temperature in mired,
+ *                                            0 keeps the current one
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetTunableWhiteColourTemperature(int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate(u16CurrLevel, (i32ColourTemperature > 0) ? (uint16) MIN(0xFFFF, i32ColourTemperature) : u16CurrMired);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vGetColourTempPhyMinMax
+ *
+ * DESCRIPTION:		Colour temperatures of the two LEDs, the range the
+ *                  light can show
+ *
+ * PARAMETERS:      Name        RW  Usage
+ *                  pu16PhyMin  W   Coolest, in mired
+ *                  pu16PhyMax  W   Warmest, in mired
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vGetColourTempPhyMinMax(uint16 *pu16PhyMin, uint16 *pu16PhyMax)
+{
+	*pu16PhyMin = WARMCOOL_MIRED_COOL;
+	*pu16PhyMax = WARMCOOL_MIRED_WARM;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetState
+ *
+ * DESCRIPTION:		Updates level and colour temperature together so a
+ *                  caller changing both programs the outputs only once
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-LAMP_LEVEL_MAX
+ *                  u32Red/Green/Blue     R   Unused by this driver
+ *                  i32ColourTemperature  R   Mired, 0 keeps the current one
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)),
+					   (i32ColourTemperature > 0) ? (uint16) MIN(0xFFFF, i32ColourTemperature) : u16CurrMired);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSet12BitLevel, DriverBulb_vSet12BitState
+ *
+ * DESCRIPTION:		12 bit equivalents of the above. The extra resolution is
+ *                  dithered onto the PWM by DriverBulb_vTick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-4095
+ *                  u32Red/Green/Blue     R   Unused by this driver
+ *                  i32ColourTemperature  R   Mired, 0 keeps the current one
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSet12BitLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)), u16CurrMired);
+}
+
+PUBLIC void DriverBulb_vSet12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)),
+					   (i32ColourTemperature > 0) ? (uint16) MIN(0xFFFF, i32ColourTemperature) : u16CurrMired);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vLoadSettings
+ *
+ * DESCRIPTION:		Restores the PWM frequency profile saved in PDM,
+ *                  keeping the standard profile if there is none
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vLoadSettings(void)
+{
+	DriverBulb_vPwmLoadSettings();
+}
+
+/****************************************************************************
+ *
+ * NAME:            DriverBulb_vOn
+ *
+ * DESCRIPTION:     Turns the lamp on, over-driving if user deep-dimmed
+ *                  before turning off otherwise ignition failures occur
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vOn(void)
+{
+	/* Lamp is not on ? */
+	if (bIsOn != TRUE)
+	{
+		/* Note light is on */
+		bIsOn = TRUE;
+		/* Set outputs */
+		DriverBulb_vOutput();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:            DriverBulb_vOff
+ *
+ * DESCRIPTION:     Turns the lamp off
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vOff(void)
+{
+	/* Lamp is on ? */
+	if (bIsOn == TRUE)
+	{
+		/* Note light is off */
+		bIsOn = FALSE;
+		/* Set outputs */
+		DriverBulb_vOutput();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAMES:           DriverBulb_bOn, u16ReadBusVoltage, u16ReadChipTemperature
+ *
+ * DESCRIPTION:		Access functions for Monitored Lamp Parameters
+ *
+ *
+ * PARAMETERS:      Name     RW  Usage
+ *
+ * RETURNS:
+ * Lamp state, Bus Voltage (Volts), Chip Temperature (Degrees C)
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bOn(void)
+{
+	return (bIsOn);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_i16Analogue
+ *
+ * DESCRIPTION:     ADC based measurement of bus voltage is not support in
+ * 					this driver.
+ *
+ * PARAMETERS:      Name	     RW      Usage
+ *                  u8Adc        R       ADC Channel
+ *                  u16AdcRead   R       Raw ADC Value
+ *
+ * RETURNS:         Bus voltage
+ *
+ ****************************************************************************/
+PUBLIC int16 DriverBulb_i16Analogue(uint8 u8Adc, uint16 u16AdcRead)
+{
+	return 0;
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bFailed
+ *
+ * DESCRIPTION:     Access function for Failed bulb state
+ *
+ *
+ * RETURNS:         bulb state
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bFailed(void)
+{
+	return (FALSE);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vUpdate
+ *
+ * DESCRIPTION:     Notes a new 12 bit level and colour temperature,
+ *                  updating the outputs if they changed
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level, uint16 u16Mired)
+{
+	/* Different value ? */
+	if (u16CurrLevel != u16Level || u16CurrMired != u16Mired)
+	{
+		/* Note the new values */
+		u16CurrLevel = u16Level;
+		u16CurrMired = u16Mired;
+		/* Is the lamp on ? */
+		if (bIsOn)
+		{
+			/* Set outputs */
+			DriverBulb_vOutput();
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vOutput
+ *
+ * DESCRIPTION:     Splits the level between the warm and cool LEDs. The
+ *                  split is interpolated between the entries of the
+ *                  generated table either side of the colour temperature,
+ *                  the cells holding an LED's own colour temperature
+ *                  narrowed to end on it so each LED is reached alone.
+ *                  Every entry gives the same light, so only the level
+ *                  moves the brightness. The split is linear light, so the
+ *                  dimming curve is applied to the level alone.
+ *
+ * RETURNS:         void
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vOutput(void)
+{
+	const uint16 *pu16Low;
+	const uint16 *pu16High;
+	uint16  au16Duty[PWM_CHANNELS];
+	uint32  u32Mired;
+	uint32  u32Low;
+	uint32  u32High;
+	uint32  u32Frac;
+	uint32  u32Level;
+	uint8   i;
+
+	/* Is bulb on ? */
+	if (bIsOn)
+	{
+		u32Mired = MIN(MAX(u16CurrMired, WARMCOOL_MIRED_COOL), WARMCOOL_MIRED_WARM);
+		pu16Low  = au16WarmCoolTable[(u32Mired - MIRED_TABLE_MIN) >> MIRED_TABLE_STEP_BITS];
+		pu16High = au16WarmCoolTable[((u32Mired - MIRED_TABLE_MIN) >> MIRED_TABLE_STEP_BITS) + 1];
+		u32Low   = MIRED_TABLE_MIN + ((u32Mired - MIRED_TABLE_MIN) & ~(MIRED_TABLE_STEP - 1));
+		u32High  = MIN(u32Low + MIRED_TABLE_STEP, WARMCOOL_MIRED_WARM);
+		u32Low   = MAX(u32Low, WARMCOOL_MIRED_COOL);
+		u32Frac  = (u32High > u32Low) ? (((u32Mired - u32Low) << MIRED_TABLE_STEP_BITS) / (u32High - u32Low)) : 0;
+		u32Level = DIM_CURVE_LOOKUP12(u16CurrLevel);
+
+		for (i = 0; i < PWM_CHANNELS; i++)
+		{
+			au16Duty[i] = (uint16)(((pu16Low[i] + ((((int32)pu16High[i] - (int32)pu16Low[i]) * (int32)u32Frac) >> MIRED_TABLE_STEP_BITS))
+			                        * u32Level) >> DIM_CURVE_BITS);
+		}
+
+		/* Don't allow fully off, keeping the lit LED the one that dominates */
+		if ((au16Duty[E_WARM_PWM] + au16Duty[E_COOL_PWM]) < (1 << DIM_12BIT_FRAC_BITS))
+		{
+			i = (pu16Low[E_WARM_PWM] + pu16High[E_WARM_PWM] >= pu16Low[E_COOL_PWM] + pu16High[E_COOL_PWM]) ? E_WARM_PWM : E_COOL_PWM;
+			au16Duty[i]     = (1 << DIM_12BIT_FRAC_BITS);
+			au16Duty[1 - i] = 0;
+		}
+	}
+	else /* Turn off */
+	{
+		au16Duty[E_WARM_PWM] = 0;
+		au16Duty[E_COOL_PWM] = 0;
+	}
+
+	DriverBulb_vPwmWrite(au16Duty);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
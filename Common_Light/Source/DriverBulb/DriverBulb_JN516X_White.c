@@ -35,17 +35,16 @@
 #include <PeripheralRegs.h>
 /* JenOS includes */
 #include <dbg.h>
-/* Application includes */
 /* Device includes */
 #include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_Pwm.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 /* PWM timer configuration */
 #define PERIPHERAL_CLOCK_FREQUENCY_HZ	16000000UL		/* System frequency 16MHz */
-#define PWM_TIMER_PRESCALE				6     			/* Prescale value to use   */
-#define PWM_COUNT_MAX					255				/* Gives PWM frequency of ((16MHz / 2^6) / 255) */
 
 
 
@@ -64,6 +63,7 @@
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level);
 PRIVATE void DriverBulb_vOutput(void);
 
 /****************************************************************************/
@@ -78,7 +78,10 @@ PRIVATE void DriverBulb_vOutput(void);
 /***        Local Variables                                               ***/
 /****************************************************************************/
 PRIVATE bool_t  bIsOn      	 	= FALSE;
-PRIVATE uint8   u8CurrLevel 	= 255;
+PRIVATE uint16  u16CurrLevel 	= DIM_12BIT_MAX;	/* 12 bit */
+
+PRIVATE const uint8  u8Timer        = PWM_TIMER_WHITE;
+PRIVATE const uint32 u32TimerDevice = E_AHI_DEVICE_TIMER3;
 
 
 /****************************************************************************/
@@ -104,14 +107,11 @@ PUBLIC void DriverBulb_vInit(void)
 	/* Not already initialized ? */
 	if (bInit == FALSE)
 	{
-		/* Configure white channel PWM timer */
-		vAHI_TimerEnable(PWM_TIMER_WHITE, PWM_TIMER_PRESCALE, FALSE, FALSE, TRUE);
-		vAHI_TimerConfigureOutputs(PWM_TIMER_WHITE, PWM_INVERT, TRUE);
-
 		/* Note light is on */
 		bIsOn = TRUE;
 
-		/* Set outputs */
+		/* Start the white channel PWM timer, then set the first duty */
+		DriverBulb_vPwmInit(1, &u8Timer, &u32TimerDevice, PWM_INVERT);
 		DriverBulb_vOutput();
 
 		/* Now initialized */
@@ -155,20 +155,61 @@ PUBLIC bool_t DriverBulb_bReady(void)
  ****************************************************************************/
 PUBLIC void DriverBulb_vSetLevel(uint32 u32Level)
 {
-	/* Different value ? */
-	if (u8CurrLevel != (uint8) u32Level)
-	{
-		/* Note the new level */
-		u8CurrLevel = (uint8) MAX(1, u32Level);
-		/* Is the lamp on ? */
-		if (bIsOn)
-		{
-			/* Set outputs */
-			DriverBulb_vOutput();
-		}
-	}
+	DriverBulb_vUpdate(DIM_EXPAND_12BIT(MAX(1, (uint8) u32Level)));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSetState
+ *
+ * DESCRIPTION:		Batched update; only the level applies to a white lamp
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-LAMP_LEVEL_MAX
+ *                  u32Red/Green/Blue     R   Unused by this driver
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vSetLevel(u32Level);
 }
 
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vSet12BitLevel, DriverBulb_vSet12BitState
+ *
+ * DESCRIPTION:		12 bit equivalents of the above. The extra resolution is
+ *                  dithered onto the PWM by DriverBulb_vTick
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u32Level              R   Light level 0-4095
+ *                  u32Red/Green/Blue     R   Unused by this driver
+ *                  i32ColourTemperature  R   Unused by this driver
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vSet12BitLevel(uint32 u32Level)
+{
+	DriverBulb_vUpdate((uint16) MAX(1, MIN(DIM_12BIT_MAX, u32Level)));
+}
+
+PUBLIC void DriverBulb_vSet12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, int32 i32ColourTemperature)
+{
+	DriverBulb_vSet12BitLevel(u32Level);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vLoadSettings
+ *
+ * DESCRIPTION:		Restores the PWM frequency profile saved in PDM,
+ *                  keeping the standard profile if there is none
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vLoadSettings(void)
+{
+	DriverBulb_vPwmLoadSettings();
+}
 
 /****************************************************************************
  *
@@ -233,20 +274,6 @@ PUBLIC bool_t DriverBulb_bOn(void)
 	return (bIsOn);
 }
 
-/****************************************************************************
- *
- * NAMES:           DriverBulb_vTick
- *
- * DESCRIPTION:		Hook for 10 ms Ticks from higher layer for timing
- *                  This currently restores very low dim levels after
- *                  we've started up with sufficient DCI level to ensure
- *                  ignition
- *
- ****************************************************************************/
-PUBLIC void DriverBulb_vTick(void)
-{
-}
-
 /****************************************************************************
  *
  * NAME:			DriverBulb_i16Analogue
@@ -281,6 +308,30 @@ PUBLIC bool_t DriverBulb_bFailed(void)
 	return (FALSE);
 }
 
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vUpdate
+ *
+ * DESCRIPTION:     Notes a new 12 bit level, updating the output if it
+ *                  changed
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vUpdate(uint16 u16Level)
+{
+	/* Different value ? */
+	if (u16CurrLevel != u16Level)
+	{
+		/* Note the new level */
+		u16CurrLevel = u16Level;
+		/* Is the lamp on ? */
+		if (bIsOn)
+		{
+			/* Set outputs */
+			DriverBulb_vOutput();
+		}
+	}
+}
+
 /****************************************************************************
  *
  * NAME:			DriverBulb_vOutput
@@ -292,17 +343,21 @@ PUBLIC bool_t DriverBulb_bFailed(void)
  ****************************************************************************/
 PRIVATE void DriverBulb_vOutput(void)
 {
+	uint16  u16Duty;
 
 	/* Is bulb on ? */
 	if (bIsOn)
 	{
-		vAHI_TimerStartRepeat(PWM_TIMER_WHITE,  (PWM_COUNT_MAX - u8CurrLevel), PWM_COUNT_MAX);
+		/* Level along the dimming curve, not allowed fully off */
+		u16Duty = (uint16)(DIM_CURVE_LOOKUP12(u16CurrLevel) >> (DIM_CURVE_BITS - 12));
+		if (u16Duty < (1 << DIM_12BIT_FRAC_BITS)) u16Duty = (1 << DIM_12BIT_FRAC_BITS);
 	}
 	else
 	{
-		vAHI_TimerStartRepeat(PWM_TIMER_WHITE, PWM_COUNT_MAX, PWM_COUNT_MAX);
+		u16Duty = 0;
 	}
 
+	DriverBulb_vPwmWrite(&u16Duty);
 }
 
 /****************************************************************************/
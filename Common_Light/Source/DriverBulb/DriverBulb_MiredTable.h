@@ -0,0 +1,63 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          DriverBulb_MiredTable.h
+ *
+ * DESCRIPTION:        Colour temperature table for RGB bulbs
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef DRIVERBULB_MIREDTABLE_H_INCLUDED
+#define DRIVERBULB_MIREDTABLE_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* The table itself is generated at build time by Common_Light/Build/MiredTable.awk.
+ * Entries are the 12 bit RGB of the black body, every MIRED_TABLE_STEP mired
+ * from MIRED_TABLE_MIN (6579K) to MIRED_TABLE_MAX (1667K), the warm end of
+ * the fit the table is made from. Colour temperatures beyond take the ends.
+ */
+#define MIRED_TABLE_MIN         (152)
+#define MIRED_TABLE_STEP_BITS   (4)
+#define MIRED_TABLE_STEP        (1 << MIRED_TABLE_STEP_BITS)
+#define MIRED_TABLE_SIZE        (28)
+#define MIRED_TABLE_MAX         (MIRED_TABLE_MIN + MIRED_TABLE_SIZE * MIRED_TABLE_STEP)
+
+/* White LEDs of a tunable white bulb, generated into the warm/cool table
+ * with MiredTable.awk -v TABLE=WARMCOOL: 2700K and 6500K */
+#define WARMCOOL_MIRED_WARM     (370)
+#define WARMCOOL_MIRED_COOL     (154)
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+extern const uint16 au16MiredTable[MIRED_TABLE_SIZE + 1][3];
+extern const uint16 au16WarmCoolTable[MIRED_TABLE_SIZE + 1][2];
+
+#endif /* DRIVERBULB_MIREDTABLE_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,445 @@
+/****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5179].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2016. All rights reserved
+ ****************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+/* SDK includes */
+#include <jendefs.h>
+/* Hardware includes */
+#include <AppHardwareApi.h>
+#include <PeripheralRegs.h>
+/* JenOS includes */
+#include "pdm.h"
+/* Application includes */
+#include "PDM_IDs.h"
+/* Device includes */
+#include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_PwmProfile.h"
+#include "DriverBulb_Pwm.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+/* Dither the 12 bit channel values onto the PWM from the 10ms tick */
+#define PWM_DITHER						TRUE
+
+/* Ticks the duties must hold for before the dither stops on the nearer
+ * count, so a steady light can sleep between its 1Hz ticks */
+#define PWM_DITHER_TICKS				(200)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE void DriverBulb_vPwmStart(void);
+PRIVATE void DriverBulb_vPwmQueue(void);
+PRIVATE void DriverBulb_vPwmLatchInt(uint8 u8Channel, bool_t bEnable);
+PRIVATE void DriverBulb_vPwmTimerCallback(uint32 u32Device, uint32 u32ItemBitmap);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Global Variables                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE uint32  u32OutputCount	= 0;
+
+/* Timers of the driver's channels */
+PRIVATE uint8          u8Channels		= 0;
+PRIVATE const uint8   *pu8Timer			= NULL;
+PRIVATE const uint32  *pu32TimerDevice	= NULL;
+
+/* 12 bit duty per channel and the dither phase. The task writes each new
+ * PWM value to a shadow, the timer's period interrupt latches it into the
+ * timer at the period boundary so no period is cut short. The interrupt
+ * is only on while a shadow waits to be latched */
+PRIVATE uint16  au16Duty[PWM_CHANNELS_MAX];
+PRIVATE volatile uint16 au16Shadow[PWM_CHANNELS_MAX];
+PRIVATE uint16  au16Pwm[PWM_CHANNELS_MAX];
+PRIVATE volatile bool_t abLatchInt[PWM_CHANNELS_MAX];
+PRIVATE uint8   u8DitherPhase	= 0;
+PRIVATE bool_t  bWrittenThisTick = FALSE;
+PRIVATE bool_t  bDithering = FALSE;
+PRIVATE uint16  u16SteadyTicks	= 0;
+
+/* PWM frequency profile in use */
+PRIVATE const tsPwmProfile asPwmProfile[E_PWM_PROFILE_NUM] = PWM_PROFILES;
+PRIVATE const tsPwmProfile *psPwm = &asPwmProfile[E_PWM_PROFILE_STANDARD];
+
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vPwmInit
+ *
+ * DESCRIPTION:		Takes the driver's PWM timers and starts them for the
+ *                  standard profile, until PDM is up, with the outputs off.
+ *                  The driver's first duties are latched at the end of the
+ *                  first period
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u8NumChannels         R   Channels, up to PWM_CHANNELS_MAX
+ *                  pu8Timers             R   Timer of each channel
+ *                  pu32TimerDevices      R   Interrupt device of each timer
+ *                  bInvertOutputs        R   Whether the outputs are inverted
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vPwmInit(uint8 u8NumChannels, const uint8 *pu8Timers, const uint32 *pu32TimerDevices, bool_t bInvertOutputs)
+{
+	uint8 i;
+
+	u8Channels      = MIN(u8NumChannels, PWM_CHANNELS_MAX);
+	pu8Timer        = pu8Timers;
+	pu32TimerDevice = pu32TimerDevices;
+
+	for (i = 0; i < u8Channels; i++)
+	{
+		/* New duties are latched from the period interrupts */
+		switch (pu8Timer[i])
+		{
+		case E_AHI_TIMER_1: vAHI_Timer1RegisterCallback(DriverBulb_vPwmTimerCallback); break;
+		case E_AHI_TIMER_2: vAHI_Timer2RegisterCallback(DriverBulb_vPwmTimerCallback); break;
+		case E_AHI_TIMER_3: vAHI_Timer3RegisterCallback(DriverBulb_vPwmTimerCallback); break;
+		case E_AHI_TIMER_4: vAHI_Timer4RegisterCallback(DriverBulb_vPwmTimerCallback); break;
+		default: break;
+		}
+		vAHI_TimerConfigureOutputs(pu8Timer[i], bInvertOutputs, TRUE);
+	}
+
+	DriverBulb_vPwmStart();
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vPwmWrite
+ *
+ * DESCRIPTION:		Takes new 12 bit duties for the channels and queues
+ *                  those that change for the timers. A change starts the
+ *                  dither again
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  pu16Duties            R   12 bit duty of each channel
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vPwmWrite(const uint16 *pu16Duties)
+{
+	uint8 i;
+
+	for (i = 0; i < u8Channels; i++)
+	{
+		if (au16Duty[i] != pu16Duties[i])
+		{
+			au16Duty[i] = pu16Duties[i];
+			u16SteadyTicks = 0;
+		}
+	}
+	DriverBulb_vPwmQueue();
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_vPwmLoadSettings
+ *
+ * DESCRIPTION:		Restores the PWM frequency profile saved in PDM,
+ *                  keeping the standard profile if there is none
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vPwmLoadSettings(void)
+{
+	uint16 u16BytesRead;
+	uint8  u8Profile;
+
+	if (PDM_eReadDataFromRecord(PDM_ID_APP_PWM_PROFILE, &u8Profile, sizeof(u8Profile), &u16BytesRead) == PDM_E_STATUS_OK &&
+		u16BytesRead == sizeof(u8Profile) && u8Profile < E_PWM_PROFILE_NUM && u8Profile != DriverBulb_u8GetPwmProfile())
+	{
+		psPwm = &asPwmProfile[u8Profile];
+		DriverBulb_vPwmStart();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_bSetPwmProfile
+ *
+ * DESCRIPTION:		Changes the PWM frequency and resolution and saves the
+ *                  profile in PDM. The timers are restarted at once, so
+ *                  the period in progress is cut short
+ *
+ * PARAMETERS:      Name                  RW  Usage
+ *                  u8Profile             R   New profile, a tePwmProfile
+ *
+ * RETURNS:         TRUE if the profile is known and was taken
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bSetPwmProfile(uint8 u8Profile)
+{
+	if (u8Profile >= E_PWM_PROFILE_NUM)
+	{
+		return (FALSE);
+	}
+	PDM_eSaveRecordData(PDM_ID_APP_PWM_PROFILE, &u8Profile, sizeof(u8Profile));
+
+	if (u8Profile != DriverBulb_u8GetPwmProfile())
+	{
+		psPwm = &asPwmProfile[u8Profile];
+		DriverBulb_vPwmStart();
+	}
+	return (TRUE);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		DriverBulb_u8GetPwmProfile
+ *
+ * DESCRIPTION:		Reads back the PWM frequency profile in use
+ *
+ ****************************************************************************/
+PUBLIC uint8 DriverBulb_u8GetPwmProfile(void)
+{
+	return (uint8)(psPwm - asPwmProfile);
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_u32GetOutputCount
+ *
+ * DESCRIPTION:     Number of times the outputs have been programmed since
+ *                  initialisation, used to measure the hardware write rate
+ *
+ * RETURNS:         Free running output count
+ *
+ ****************************************************************************/
+PUBLIC uint32 DriverBulb_u32GetOutputCount(void)
+{
+	return (u32OutputCount);
+}
+
+/****************************************************************************
+ *
+ * NAMES:           DriverBulb_vTick
+ *
+ * DESCRIPTION:		Hook for 10 ms Ticks from higher layer for timing
+ *                  Steps the temporal dither so channels with a fractional
+ *                  duty alternate between neighbouring PWM values. A lamp
+ *                  that is off has zero duties, which never dither. Once
+ *                  the duties have held for PWM_DITHER_TICKS the channels
+ *                  settle on their nearer count and the ticks can stop
+ *
+ ****************************************************************************/
+PUBLIC void DriverBulb_vTick(void)
+{
+#if (PWM_DITHER == TRUE)
+	/* Move on to the next dither phase */
+	u8DitherPhase = (u8DitherPhase + 1) & (DIM_DITHER_PHASES - 1);
+	if (bDithering && (u16SteadyTicks < PWM_DITHER_TICKS))
+	{
+		u16SteadyTicks++;
+	}
+
+	/* Not already written this tick by a level or colour change ? */
+	if (!bWrittenThisTick)
+	{
+		/* Write any channel whose dithered value changed */
+		DriverBulb_vPwmQueue();
+	}
+#endif
+	bWrittenThisTick = FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_bTickPending
+ *
+ * DESCRIPTION:     Whether the next tick would move the dither on a channel
+ *                  that falls between two PWM counts, or settle it.
+ *                  Otherwise the output holds without ticks
+ *
+ ****************************************************************************/
+PUBLIC bool_t DriverBulb_bTickPending(void)
+{
+	return (bDithering);
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vPwmStart
+ *
+ * DESCRIPTION:     Programs the timers for the PWM profile and restarts
+ *                  them at the current duties, with nothing left to latch
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vPwmStart(void)
+{
+	uint8 i;
+
+	for (i = 0; i < u8Channels; i++)
+	{
+		DriverBulb_vPwmLatchInt(i, FALSE);
+	}
+
+	/* Duties for the new period, then start from them */
+	u16SteadyTicks = 0;
+	DriverBulb_vPwmQueue();
+	for (i = 0; i < u8Channels; i++)
+	{
+		if (abLatchInt[i])
+		{
+			DriverBulb_vPwmLatchInt(i, FALSE);
+		}
+		au16Pwm[i] = au16Shadow[i];
+		vAHI_TimerStartRepeat(pu8Timer[i], (psPwm->u16Period - au16Pwm[i]), psPwm->u16Period);
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vPwmQueue
+ *
+ * DESCRIPTION:     Queues the 12 bit duties for the PWM timers at the
+ *                  current dither phase, or at the nearer count once they
+ *                  have held long enough, skipping channels that would not
+ *                  change. Each timer takes its new value at the end of
+ *                  its current period, from the period interrupt turned on
+ *                  for it here, or at once if the profile is too fast to
+ *                  latch
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vPwmQueue(void)
+{
+	bool_t  bWritten = FALSE;
+	bool_t  bDither = FALSE;
+	uint16  u16Pwm;
+	uint8   i;
+
+	for (i = 0; i < u8Channels; i++)
+	{
+#if (PWM_DITHER == TRUE)
+		if (u16SteadyTicks >= PWM_DITHER_TICKS)
+		{
+			u16Pwm = PWM_COUNTS_ROUND(psPwm, au16Duty[i]);
+		}
+		else
+		{
+			u16Pwm = PWM_COUNTS(psPwm, au16Duty[i], u8DitherPhase);
+			bDither |= PWM_DITHERS(psPwm, au16Duty[i]);
+		}
+#else
+		u16Pwm = PWM_COUNTS_TRUNC(psPwm, au16Duty[i]);
+#endif
+		/* Set channel level */
+		if (u16Pwm != au16Shadow[i])
+		{
+			au16Shadow[i] = u16Pwm;
+			bWritten = TRUE;
+			if (!psPwm->bLatch)
+			{
+				au16Pwm[i] = u16Pwm;
+				vAHI_TimerStartRepeat(pu8Timer[i], (psPwm->u16Period - au16Pwm[i]), psPwm->u16Period);
+			}
+			else if (!abLatchInt[i])
+			{
+				DriverBulb_vPwmLatchInt(i, TRUE);
+			}
+		}
+	}
+
+	bDithering = bDither;
+	if (bWritten)
+	{
+		u32OutputCount++;
+		bWrittenThisTick = TRUE;
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vPwmTimerCallback
+ *
+ * DESCRIPTION:     Period interrupt of a PWM timer, on while a new duty
+ *                  waits. The counter has just wrapped, so restarting it
+ *                  with the new duty here can't shorten a period. The
+ *                  interrupt is turned off before the shadow is read, so
+ *                  a duty queued after that turns it on again
+ *
+ * PARAMETERS:      Name	        RW      Usage
+ *                  u32Device       R       Interrupting timer
+ *                  u32ItemBitmap   R       Interrupt source
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vPwmTimerCallback(uint32 u32Device, uint32 u32ItemBitmap)
+{
+	uint8 i;
+
+	for (i = 0; i < u8Channels; i++)
+	{
+		if (u32Device == pu32TimerDevice[i])
+		{
+			DriverBulb_vPwmLatchInt(i, FALSE);
+			if (au16Shadow[i] != au16Pwm[i])
+			{
+				au16Pwm[i] = au16Shadow[i];
+				vAHI_TimerStartRepeat(pu8Timer[i], (psPwm->u16Period - au16Pwm[i]), psPwm->u16Period);
+			}
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:			DriverBulb_vPwmLatchInt
+ *
+ * DESCRIPTION:     Turns the period interrupt of a channel's timer on or
+ *                  off. Enabling a running timer again only changes its
+ *                  interrupts; the counter runs on
+ *
+ * PARAMETERS:      Name	        RW      Usage
+ *                  u8Channel       R       Channel of the timer
+ *                  bEnable         R       Whether to take period interrupts
+ *
+ ****************************************************************************/
+PRIVATE void DriverBulb_vPwmLatchInt(uint8 u8Channel, bool_t bEnable)
+{
+	abLatchInt[u8Channel] = bEnable;
+	vAHI_TimerEnable(pu8Timer[u8Channel], psPwm->u8Prescale, FALSE, bEnable, TRUE);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
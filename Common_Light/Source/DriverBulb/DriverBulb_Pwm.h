@@ -0,0 +1,55 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          DriverBulb_Pwm.h
+ *
+ * DESCRIPTION:        PWM timer handling shared by the PWM bulb drivers
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef DRIVERBULB_PWM_H_INCLUDED
+#define DRIVERBULB_PWM_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Most PWM channels a driver can have, one per timer */
+#define PWM_CHANNELS_MAX			4
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* The PWM drivers mix level and colour into 12 bit duties and hand them
+ * here. DriverBulb_Pwm.c also provides DriverBulb_vTick, bTickPending,
+ * bSetPwmProfile, u8GetPwmProfile and u32GetOutputCount for them */
+PUBLIC void DriverBulb_vPwmInit(uint8 u8NumChannels, const uint8 *pu8Timers, const uint32 *pu32TimerDevices, bool_t bInvertOutputs);
+PUBLIC void DriverBulb_vPwmWrite(const uint16 *pu16Duties);
+PUBLIC void DriverBulb_vPwmLoadSettings(void);
+
+#endif /* DRIVERBULB_PWM_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,88 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          DriverBulb_PwmProfile.h
+ *
+ * DESCRIPTION:        PWM frequency profiles shared by the PWM bulb drivers
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef DRIVERBULB_PWMPROFILE_H_INCLUDED
+#define DRIVERBULB_PWMPROFILE_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include "DriverBulb.h"
+#include "DriverBulb_DimCurve.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Multiplier taking a 12 bit duty to PWM counts in Q4, for the dither:
+ * (u16Duty * (u16Period + 1)) >> 8. At 255 counts it is 256 and the duty
+ * is taken as it is */
+#define PWM_DUTY_MUL(u16Period)     ((uint32)(u16Period) + 1)
+
+/* Timer clock prescale, counts per period, and whether duties are latched
+ * from the period interrupt, for each tePwmProfile. Above a few kHz there
+ * are too many period interrupts to latch from, and a period cut short by
+ * a restart lasts too little to see */
+#define PWM_PROFILES \
+{ \
+	/* E_PWM_PROFILE_STANDARD:     16MHz / 2^6 / 255  = 980Hz, 8 bit  */ \
+	{ 6, 255,  PWM_DUTY_MUL(255),  TRUE  }, \
+	/* E_PWM_PROFILE_FLICKER_FREE: 16MHz / 1000       = 16kHz, 10 bit */ \
+	{ 0, 1000, PWM_DUTY_MUL(1000), FALSE }, \
+	/* E_PWM_PROFILE_HIGH_RES:     16MHz / 2^2 / 4000 = 1kHz, 12 bit  */ \
+	{ 2, 4000, PWM_DUTY_MUL(4000), TRUE  }, \
+}
+
+/* Counts for a 12 bit duty under profile psProfile, dithered at phase
+ * u8Phase or truncated */
+#define PWM_COUNTS(psProfile, u16Duty, u8Phase) \
+	((uint16)MIN((psProfile)->u16Period, \
+				 DIM_DITHER(((uint32)(u16Duty) * (psProfile)->u32DutyMul) >> 8, (u8Phase))))
+#define PWM_COUNTS_TRUNC(psProfile, u16Duty) \
+	((uint16)MIN((psProfile)->u16Period, ((uint32)(u16Duty) * (psProfile)->u32DutyMul) >> 12))
+#define PWM_COUNTS_ROUND(psProfile, u16Duty) \
+	((uint16)MIN((psProfile)->u16Period, (((uint32)(u16Duty) * (psProfile)->u32DutyMul) + (1 << 11)) >> 12))
+
+/* Whether a 12 bit duty falls between two counts, so the dither moves it */
+#define PWM_DITHERS(psProfile, u16Duty) \
+	(((((uint32)(u16Duty) * (psProfile)->u32DutyMul) >> 8) & DIM_12BIT_FRAC_MASK) != 0 && \
+	 (((uint32)(u16Duty) * (psProfile)->u32DutyMul) >> 12) < (psProfile)->u16Period)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef struct
+{
+	uint8	u8Prescale;
+	uint16	u16Period;
+	uint32	u32DutyMul;
+	bool_t	bLatch;
+} tsPwmProfile;
+
+#endif /* DRIVERBULB_PWMPROFILE_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
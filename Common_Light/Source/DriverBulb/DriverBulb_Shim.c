@@ -36,15 +36,19 @@
 
 /* SDK includes */
 #include <jendefs.h>
+#include <string.h>
 
 
 /* Device includes */
 #include "DriverBulb_Shim.h"
 #include "DriverBulb.h"
+#include "DriverBulb_MiredTable.h"
 
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
+/* 12 bit value back to 8 bits, 4095 -> 255 */
+#define TO_8BIT(u32Value)	(((u32Value) - ((u32Value) >> 8)) >> 4)
 
 /****************************************************************************/
 /***        Type Definitions                                              ***/
@@ -65,6 +69,8 @@
 /****************************************************************************/
 /***        Local Variables                                               ***/
 /****************************************************************************/
+PRIVATE uint32 u32LastOutputCount;
+PRIVATE uint32 u32WritesPerSecond;
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -102,10 +108,399 @@ PUBLIC void vBULB_SetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue)
 
 PUBLIC void vBULB_SetColourTemperature(uint32 u32ColTemp)
 {
+	uint32 u32Red;
+	uint32 u32Green;
+	uint32 u32Blue;
+
 	if (DriverBulb_vSetTunableWhiteColourTemperature)
 	{
 		DriverBulb_vSetTunableWhiteColourTemperature(u32ColTemp);
 	}
+	else if (u32ColTemp != 0)
+	{
+		/* An RGB bulb shows the colour of the black body instead */
+		vBULB_MiredToRGB(u32ColTemp, &u32Red, &u32Green, &u32Blue);
+		if (DriverBulb_vSet12BitColour)
+		{
+			DriverBulb_vSet12BitColour(u32Red, u32Green, u32Blue);
+		}
+		else
+		{
+			vBULB_SetColour(TO_8BIT(u32Red), TO_8BIT(u32Green), TO_8BIT(u32Blue));
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_MiredToRGB
+ *
+ * DESCRIPTION:		12 bit RGB of a colour temperature in mired, interpolated
+ *                  between the entries of the generated table on either
+ *                  side. Integer only, so cheap enough to run at the LI rate.
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_MiredToRGB(uint32 u32Mired, uint32 *pu32Red, uint32 *pu32Green, uint32 *pu32Blue)
+{
+	const uint16 *pu16Low;
+	const uint16 *pu16High;
+	uint32 u32Frac;
+
+	u32Mired = MIN(MAX(u32Mired, MIRED_TABLE_MIN), MIRED_TABLE_MAX) - MIRED_TABLE_MIN;
+	pu16Low  = au16MiredTable[u32Mired >> MIRED_TABLE_STEP_BITS];
+	pu16High = au16MiredTable[MIN((u32Mired >> MIRED_TABLE_STEP_BITS) + 1, MIRED_TABLE_SIZE)];
+	u32Frac  = u32Mired & (MIRED_TABLE_STEP - 1);
+
+	*pu32Red   = pu16Low[0] + ((((int32)pu16High[0] - (int32)pu16Low[0]) * (int32)u32Frac) >> MIRED_TABLE_STEP_BITS);
+	*pu32Green = pu16Low[1] + ((((int32)pu16High[1] - (int32)pu16Low[1]) * (int32)u32Frac) >> MIRED_TABLE_STEP_BITS);
+	*pu32Blue  = pu16Low[2] + ((((int32)pu16High[2] - (int32)pu16Low[2]) * (int32)u32Frac) >> MIRED_TABLE_STEP_BITS);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_SetState
+ *
+ * DESCRIPTION:		Commits level, colour and colour temperature together so
+ *                  the driver programs the hardware at most once. Drivers
+ *                  without a batched entry point get the individual calls;
+ *                  only a tunable white one is given the colour temperature,
+ *                  as on an RGB one it would replace the colour just set.
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_SetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp)
+{
+	if (DriverBulb_vSetState)
+	{
+		DriverBulb_vSetState(u32Level, u32Red, u32Green, u32Blue, (int32)u32ColTemp);
+	}
+	else
+	{
+		vBULB_SetColour(u32Red, u32Green, u32Blue);
+		vBULB_SetLevel(u32Level);
+		if (DriverBulb_vSetTunableWhiteColourTemperature)
+		{
+			DriverBulb_vSetTunableWhiteColourTemperature(u32ColTemp);
+		}
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_Set12BitState
+ *
+ * DESCRIPTION:		As vBULB_SetState with 12 bit level and colour. Drivers
+ *                  without 12 bit support get the top 8 bits
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_Set12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp)
+{
+	if (DriverBulb_vSet12BitState)
+	{
+		DriverBulb_vSet12BitState(u32Level, u32Red, u32Green, u32Blue, (int32)u32ColTemp);
+	}
+	else
+	{
+		vBULB_SetState(TO_8BIT(u32Level), TO_8BIT(u32Red), TO_8BIT(u32Green), TO_8BIT(u32Blue), u32ColTemp);
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_Set12BitLevel
+ *
+ * DESCRIPTION:		12 bit level alone, for lights that have no colour to
+ *                  pass with it. Drivers without 12 bit support get the top
+ *                  8 bits
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_Set12BitLevel(uint32 u32Level)
+{
+	if (DriverBulb_vSet12BitLevel)
+	{
+		DriverBulb_vSet12BitLevel(u32Level);
+	}
+	else
+	{
+		vBULB_SetLevel(TO_8BIT(u32Level));
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_Tick
+ *
+ * DESCRIPTION:		10ms tick for drivers that need timing, e.g. dithering
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_Tick(void)
+{
+	if (DriverBulb_vTick)
+	{
+		DriverBulb_vTick();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_TickPending
+ *
+ * DESCRIPTION:		Whether the driver needs the next 10ms tick, such as
+ *                  to step a dither or start a frame. A driver with a tick
+ *                  that can't say is given every one
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_TickPending(void)
+{
+	if (DriverBulb_bTickPending)
+	{
+		return DriverBulb_bTickPending();
+	}
+	return (DriverBulb_vTick != NULL);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_Tick1Sec, u32BULB_GetWritesPerSecond
+ *
+ * DESCRIPTION:		Samples the driver output count once a second so the
+ *                  hardware write rate can be read back
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_Tick1Sec(void)
+{
+	uint32 u32OutputCount;
+
+	if (DriverBulb_u32GetOutputCount)
+	{
+		u32OutputCount     = DriverBulb_u32GetOutputCount();
+		u32WritesPerSecond = u32OutputCount - u32LastOutputCount;
+		u32LastOutputCount = u32OutputCount;
+	}
+}
+
+PUBLIC uint32 u32BULB_GetWritesPerSecond(void)
+{
+	return u32WritesPerSecond;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_SetPixel, vBULB_SetSegmentColour, bBULB_MapSegment
+ *
+ * DESCRIPTION:		Per pixel and per segment colour for addressable strips.
+ *                  Ignored by drivers with a single colour output
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_SetPixel(uint16 u16Pixel, uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	if (DriverBulb_vSetPixel)
+	{
+		DriverBulb_vSetPixel(u16Pixel, u32Red, u32Green, u32Blue);
+	}
+}
+
+PUBLIC void vBULB_SetSegmentColour(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue)
+{
+	if (DriverBulb_vSetSegmentColour)
+	{
+		DriverBulb_vSetSegmentColour(u8Segment, u32Red, u32Green, u32Blue);
+	}
+}
+
+PUBLIC bool_t bBULB_MapSegment(uint8 u8Segment, uint16 u16First, uint16 u16Count)
+{
+	if (DriverBulb_bMapSegment)
+	{
+		return DriverBulb_bMapSegment(u8Segment, u16First, u16Count);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_LoadSettings
+ *
+ * DESCRIPTION:		Lets the driver restore its settings from PDM. Called
+ *                  once PDM is initialised, after the early vBULB_Init
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_LoadSettings(void)
+{
+	if (DriverBulb_vLoadSettings)
+	{
+		DriverBulb_vLoadSettings();
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_CheckStripProfile
+ *
+ * DESCRIPTION:		Checks the driver would take a strip profile, leaving
+ *                  the one in use as it is
+ *
+ * RETURNS:         TRUE if the driver would accept the profile
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_CheckStripProfile(const tsStripProfile *psProfile)
+{
+	if (DriverBulb_bCheckStripProfile)
+	{
+		return DriverBulb_bCheckStripProfile(psProfile);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_SetStripProfile
+ *
+ * DESCRIPTION:		Changes and persists the length, chip, byte order and
+ *                  SPI clock of an addressable strip
+ *
+ * RETURNS:         TRUE if the driver accepted the profile
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_SetStripProfile(const tsStripProfile *psProfile)
+{
+	if (DriverBulb_bSetStripProfile)
+	{
+		return DriverBulb_bSetStripProfile(psProfile);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_GetStripProfile
+ *
+ * DESCRIPTION:		Reads back the strip profile in use, all zero for a
+ *                  driver without a strip
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_GetStripProfile(tsStripProfile *psProfile)
+{
+	if (DriverBulb_vGetStripProfile)
+	{
+		DriverBulb_vGetStripProfile(psProfile);
+		return;
+	}
+	memset(psProfile, 0, sizeof(tsStripProfile));
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_CheckColourCalibration
+ *
+ * DESCRIPTION:		Checks the driver would take a colour calibration,
+ *                  leaving the one in use as it is
+ *
+ * RETURNS:         TRUE if the driver would accept the calibration
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_CheckColourCalibration(const tsColourCalibration *psCalibration)
+{
+	if (DriverBulb_bCheckColourCalibration)
+	{
+		return DriverBulb_bCheckColourCalibration(psCalibration);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_SetColourCalibration
+ *
+ * DESCRIPTION:		Changes and persists the colour calibration matrix and
+ *                  LED gains of the fixture
+ *
+ * RETURNS:         TRUE if the driver accepted the calibration
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_SetColourCalibration(const tsColourCalibration *psCalibration)
+{
+	if (DriverBulb_bSetColourCalibration)
+	{
+		return DriverBulb_bSetColourCalibration(psCalibration);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		vBULB_GetColourCalibration
+ *
+ * DESCRIPTION:		Reads back the colour calibration in use, the identity
+ *                  for a driver that does not calibrate
+ *
+ ****************************************************************************/
+PUBLIC void vBULB_GetColourCalibration(tsColourCalibration *psCalibration)
+{
+	uint8 i, j;
+
+	if (DriverBulb_vGetColourCalibration)
+	{
+		DriverBulb_vGetColourCalibration(psCalibration);
+		return;
+	}
+	for (i = 0; i < 3; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			psCalibration->ai16Matrix[i][j] = (i == j) ? COLOUR_CAL_ONE : 0;
+		}
+		psCalibration->au16Gain[i] = COLOUR_CAL_ONE;
+	}
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_CheckPwmProfile
+ *
+ * DESCRIPTION:		Checks the driver has a PWM frequency profile, leaving
+ *                  the one in use as it is
+ *
+ * RETURNS:         TRUE if the driver would take the profile
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_CheckPwmProfile(uint8 u8Profile)
+{
+	return (DriverBulb_bSetPwmProfile != NULL) && (u8Profile < E_PWM_PROFILE_NUM);
+}
+
+/****************************************************************************
+ *
+ * NAME:       		bBULB_SetPwmProfile
+ *
+ * DESCRIPTION:		Changes and persists the PWM frequency profile
+ *
+ * RETURNS:         TRUE if the driver took the profile
+ *
+ ****************************************************************************/
+PUBLIC bool_t bBULB_SetPwmProfile(uint8 u8Profile)
+{
+	if (DriverBulb_bSetPwmProfile)
+	{
+		return DriverBulb_bSetPwmProfile(u8Profile);
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ *
+ * NAME:       		u8BULB_GetPwmProfile
+ *
+ * DESCRIPTION:		Reads back the PWM frequency profile in use, the
+ *                  standard profile for a driver without profiles
+ *
+ ****************************************************************************/
+PUBLIC uint8 u8BULB_GetPwmProfile(void)
+{
+	if (DriverBulb_u8GetPwmProfile)
+	{
+		return DriverBulb_u8GetPwmProfile();
+	}
+	return E_PWM_PROFILE_STANDARD;
 }
 /****************************************************************************/
 /***        Local Functions                                               ***/
@@ -58,6 +58,29 @@
 PUBLIC void vBULB_Init(void);
 PUBLIC void vBULB_SetOnOff(bool_t bOn);
 PUBLIC void vBULB_SetLevel(uint32 u32Level);
+PUBLIC void vBULB_SetColour(uint32 u32Red, uint32 u32Green, uint32 u32Blue);
+PUBLIC void vBULB_SetColourTemperature(uint32 u32ColTemp);
+PUBLIC void vBULB_MiredToRGB(uint32 u32Mired, uint32 *pu32Red, uint32 *pu32Green, uint32 *pu32Blue);
+PUBLIC void vBULB_SetState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp);
+PUBLIC void vBULB_Set12BitState(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp);
+PUBLIC void vBULB_Set12BitLevel(uint32 u32Level);
+PUBLIC void vBULB_Tick(void);
+PUBLIC bool_t bBULB_TickPending(void);
+PUBLIC void vBULB_Tick1Sec(void);
+PUBLIC uint32 u32BULB_GetWritesPerSecond(void);
+PUBLIC void vBULB_SetPixel(uint16 u16Pixel, uint32 u32Red, uint32 u32Green, uint32 u32Blue);
+PUBLIC void vBULB_SetSegmentColour(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue);
+PUBLIC bool_t bBULB_MapSegment(uint8 u8Segment, uint16 u16First, uint16 u16Count);
+PUBLIC void vBULB_LoadSettings(void);
+PUBLIC bool_t bBULB_CheckStripProfile(const tsStripProfile *psProfile);
+PUBLIC bool_t bBULB_SetStripProfile(const tsStripProfile *psProfile);
+PUBLIC void vBULB_GetStripProfile(tsStripProfile *psProfile);
+PUBLIC bool_t bBULB_CheckColourCalibration(const tsColourCalibration *psCalibration);
+PUBLIC bool_t bBULB_SetColourCalibration(const tsColourCalibration *psCalibration);
+PUBLIC void vBULB_GetColourCalibration(tsColourCalibration *psCalibration);
+PUBLIC bool_t bBULB_CheckPwmProfile(uint8 u8Profile);
+PUBLIC bool_t bBULB_SetPwmProfile(uint8 u8Profile);
+PUBLIC uint8 u8BULB_GetPwmProfile(void);
 
 
 /****************************************************************************/
@@ -0,0 +1,285 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_calibration.c
+ *
+ * DESCRIPTION:        ZLL Demo: Colour Calibration Cluster - Implementation
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include <string.h>
+#include "zcl.h"
+#include "zcl_options.h"
+#include "dbg.h"
+#include "app_light_calibration.h"
+#include "app_zcl_light_task.h"
+#include "DriverBulb_Shim.h"
+
+#ifdef DEBUG_LIGHT_TASK
+#define TRACE_LIGHT_TASK  TRUE
+#else
+#define TRACE_LIGHT_TASK FALSE
+#endif
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE void vApp_LightCalibration_Read(void);
+PRIVATE void vApp_LightCalibration_Get(tsColourCalibration *psCalibration);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const tsZCL_AttributeDefinition asApp_LightCalibrationAttributeDefinitions[] = {
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RR, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[0]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RG, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[1]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RB, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[2]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GR, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[3]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GG, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[4]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GB, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[5]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BR, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[6]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BG, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[7]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BB, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_INT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->ai16Matrix[8]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_RED, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_UINT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->au16Gain[0]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_GREEN, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_UINT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->au16Gain[1]), 0},
+    {E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_BLUE, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_UINT16,
+     (uint32)(&((tsAPP_LightCalibration*)(0))->au16Gain[2]), 0},
+};
+
+PRIVATE tsZCL_ClusterDefinition sApp_LightCalibrationCluster = {
+    APP_CLUSTER_ID_LIGHT_CALIBRATION,
+    TRUE,
+    E_ZCL_SECURITY_NETWORK,
+    (sizeof(asApp_LightCalibrationAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition)),
+    (tsZCL_AttributeDefinition*)asApp_LightCalibrationAttributeDefinitions,
+    NULL
+};
+
+PRIVATE uint8 au8App_LightCalibrationAttributeControlBits[(sizeof(asApp_LightCalibrationAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition))];
+
+PRIVATE tsAPP_LightCalibration sLightCalibration;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCalibration_Register
+ *
+ * DESCRIPTION:
+ * Adds the colour calibration cluster to an endpoint that is already
+ * registered, with eApp_AppendCluster, and fills its attributes from
+ * the calibration the driver loaded from PDM. The endpoint's cluster
+ * instances may already be in psClusterInstances from another
+ * manufacturer cluster.
+ *
+ * RETURNS:
+ * teZCL_Status
+ *
+ ****************************************************************************/
+PUBLIC teZCL_Status eApp_LightCalibration_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                                   tsZCL_ClusterInstance *psClusterInstances,
+                                                   uint16 u16MaxClusters)
+{
+    teZCL_Status eZCL_Status;
+
+    eZCL_Status = eApp_AppendCluster(psEndPointDefinition, psClusterInstances, u16MaxClusters,
+                                     &sApp_LightCalibrationCluster, &sLightCalibration, au8App_LightCalibrationAttributeControlBits);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    vApp_LightCalibration_Read();
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCalibration_CheckAttribute
+ *
+ * DESCRIPTION:
+ * Called as each attribute of a write to the cluster is checked, before it
+ * is stored, with the value written. The calibration in the attributes,
+ * with this value in place, is checked with the bulb driver but not
+ * handed over; one it would refuse fails the write of that attribute
+ * with INVALID_VALUE.
+ *
+ * RETURNS:
+ * teZCL_CommandStatus
+ *
+ ****************************************************************************/
+PUBLIC teZCL_CommandStatus eApp_LightCalibration_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData)
+{
+    tsColourCalibration sCalibration;
+    uint8 i;
+
+    vApp_LightCalibration_Get(&sCalibration);
+
+    if (u16AttributeId <= E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BB)
+    {
+        i = u16AttributeId - E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RR;
+        sCalibration.ai16Matrix[i / 3][i % 3] = *(int16 *)pvAttributeData;
+    }
+    else if ((u16AttributeId >= E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_RED) &&
+             (u16AttributeId <= E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_BLUE))
+    {
+        sCalibration.au16Gain[u16AttributeId - E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_RED] = *(uint16 *)pvAttributeData;
+    }
+    else
+    {
+        return E_ZCL_CMDS_SUCCESS;
+    }
+
+    if (!bBULB_CheckColourCalibration(&sCalibration))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nCalibration attribute %04x refused", u16AttributeId);
+        return E_ZCL_CMDS_INVALID_VALUE;
+    }
+    return E_ZCL_CMDS_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightCalibration_Update
+ *
+ * DESCRIPTION:
+ * Hands the calibration to the bulb driver once a write to the cluster
+ * has completed, if it changed; the driver keeps it in PDM. The
+ * attributes are then filled from what the driver has in use.
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightCalibration_Update(void)
+{
+    tsColourCalibration sCalibration;
+    tsColourCalibration sInUse;
+
+    vApp_LightCalibration_Get(&sCalibration);
+    vBULB_GetColourCalibration(&sInUse);
+    if ((memcmp(&sCalibration, &sInUse, sizeof(sCalibration)) != 0) &&
+        !bBULB_SetColourCalibration(&sCalibration))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nCalibration refused");
+    }
+
+    vApp_LightCalibration_Read();
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightCalibration_Read
+ *
+ * DESCRIPTION:
+ * Fills the attributes from the calibration in use by the driver
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_LightCalibration_Read(void)
+{
+    tsColourCalibration sCalibration;
+    uint8 i;
+
+    vBULB_GetColourCalibration(&sCalibration);
+    for (i = 0; i < 9; i++)
+    {
+        sLightCalibration.ai16Matrix[i] = sCalibration.ai16Matrix[i / 3][i % 3];
+    }
+    for (i = 0; i < 3; i++)
+    {
+        sLightCalibration.au16Gain[i] = sCalibration.au16Gain[i];
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightCalibration_Get
+ *
+ * DESCRIPTION:
+ * The calibration held in the attributes, in the driver's form
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_LightCalibration_Get(tsColourCalibration *psCalibration)
+{
+    uint8 i;
+
+    for (i = 0; i < 9; i++)
+    {
+        psCalibration->ai16Matrix[i / 3][i % 3] = sLightCalibration.ai16Matrix[i];
+    }
+    for (i = 0; i < 3; i++)
+    {
+        psCalibration->au16Gain[i] = sLightCalibration.au16Gain[i];
+    }
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_calibration.h
+ *
+ * DESCRIPTION:        ZLL Demo: Colour Calibration Cluster -Interface
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_CALIBRATION_H
+#define APP_LIGHT_CALIBRATION_H
+
+#include <jendefs.h>
+#include "zcl.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * Manufacturer specific cluster on the light endpoint holding the fixture's
+ * colour calibration: a 3x3 matrix taking the colour to the LEDs and a gain
+ * per LED, all in Q12. Each attribute written is checked with the bulb
+ * driver, and one it would refuse fails with INVALID_VALUE; once the write
+ * completes the calibration is handed over and the driver keeps it in
+ * PDM.
+ */
+#define APP_CLUSTER_ID_LIGHT_CALIBRATION    (0xFC02)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef enum
+{
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RR = 0x0000,   /* red LED from red   */
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RG,            /* red LED from green */
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_RB,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GR,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GG,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_GB,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BR,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BG,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_MATRIX_BB,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_RED   = 0x0010,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_GREEN,
+    E_APP_LIGHT_CALIBRATION_ATTR_ID_GAIN_BLUE,
+} teAPP_LightCalibrationAttributeID;
+
+typedef struct
+{
+    zint16  ai16Matrix[9];
+    zuint16 au16Gain[3];
+} tsAPP_LightCalibration;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC teZCL_Status eApp_LightCalibration_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                                   tsZCL_ClusterInstance *psClusterInstances,
+                                                   uint16 u16MaxClusters);
+PUBLIC teZCL_CommandStatus eApp_LightCalibration_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData);
+PUBLIC void vApp_LightCalibration_Update(void);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_CALIBRATION_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,374 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_colour.c
+ *
+ * DESCRIPTION:        ZLL Demo: Colour Conversion - Implementation
+ *
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include "app_light_colour.h"
+#include "DriverBulb_Shim.h"
+
+#ifdef CLD_COLOUR_CONTROL
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * xy is taken at 12 bits with z = 1 - x - y, so x + y + z is 1 and with the
+ * matrix in Q15 a channel fits 32 bits for any entry below 16 in size
+ */
+#define COLOUR_Q15              (15)
+#define COLOUR_XY_BITS          (12)
+#define COLOUR_XY_ONE           (1 << COLOUR_XY_BITS)
+
+/* A channel is scaled to its 8 bit value from between these powers of 2 */
+#define COLOUR_NORM_BITS        (23)
+
+/* Hue and saturation attributes run to 254 */
+#define COLOUR_HS_MAX           (254)
+
+/* 12 bit value back to 8 bits, 4095 -> 255 */
+#define COLOUR_TO_8BIT(u32Value) (((u32Value) - ((u32Value) >> 8)) >> 4)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct
+{
+    bool_t              bValid;
+    tsAPP_LightColour   sColour;
+    uint8               au8Rgb[3];
+} tsAPP_LightColourCache;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE bool_t bApp_LightColour_Same(const tsAPP_LightColour *psA, const tsAPP_LightColour *psB);
+PRIVATE const int32 *pi32App_LightColour_Matrix(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE tsAPP_LightColourCache sColourCache;
+
+/* XYZ to the light's RGB in Q15, row by row, built from the primaries on first use */
+PRIVATE int32 ai32ColourMatrix[9];
+PRIVATE bool_t bColourMatrixBuilt = FALSE;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: bApp_LightColour_GetRGB
+ *
+ * DESCRIPTION:
+ * The RGB of a colour, converted only when its mode or an attribute that
+ * mode uses has changed since the last call, so level and on/off updates
+ * reuse the last conversion
+ *
+ * RETURNS:
+ * TRUE, or FALSE for a colour mode this module does not convert
+ *
+ ****************************************************************************/
+PUBLIC bool_t bApp_LightColour_GetRGB(const tsAPP_LightColour *psColour,
+                                      uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue)
+{
+    uint8 *pu8Rgb = sColourCache.au8Rgb;
+
+    if ((sColourCache.bValid == FALSE) || (bApp_LightColour_Same(psColour, &sColourCache.sColour) == FALSE))
+    {
+        switch (psColour->u8ColourMode)
+        {
+        case APP_LIGHT_COLOUR_MODE_HS:
+            vApp_LightColour_HSToRGB(psColour->u8Hue, psColour->u8Saturation, &pu8Rgb[0], &pu8Rgb[1], &pu8Rgb[2]);
+            break;
+
+        case APP_LIGHT_COLOUR_MODE_XY:
+            vApp_LightColour_XYToRGB(psColour->u16X, psColour->u16Y, &pu8Rgb[0], &pu8Rgb[1], &pu8Rgb[2]);
+            break;
+
+        case APP_LIGHT_COLOUR_MODE_CT:
+            vApp_LightColour_CTToRGB(psColour->u16ColourTemperatureMired, &pu8Rgb[0], &pu8Rgb[1], &pu8Rgb[2]);
+            break;
+
+        default:
+            return FALSE;
+        }
+        sColourCache.sColour = *psColour;
+        sColourCache.bValid  = TRUE;
+    }
+
+    *pu8Red   = pu8Rgb[0];
+    *pu8Green = pu8Rgb[1];
+    *pu8Blue  = pu8Rgb[2];
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightColour_XYToRGB
+ *
+ * DESCRIPTION:
+ * Converts a CIE xy chromaticity to the light's RGB at full brightness,
+ * through its primaries in Q15. Colours outside the primaries' gamut take
+ * the nearest they can by dropping the primaries that would go negative.
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightColour_XYToRGB(uint16 u16X, uint16 u16Y,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue)
+{
+    const int32 *pi32Matrix = pi32App_LightColour_Matrix();
+    int32  ai32Xyz[3];
+    uint32 au32Rgb[3];
+    uint32 u32Max = 0;
+    uint32 u32Scale;
+    int32  i32Channel;
+    uint8  i;
+
+    ai32Xyz[0] = u16X >> (16 - COLOUR_XY_BITS);
+    ai32Xyz[1] = u16Y >> (16 - COLOUR_XY_BITS);
+    ai32Xyz[2] = MAX(COLOUR_XY_ONE - ai32Xyz[0] - ai32Xyz[1], 0);
+
+    for (i = 0; i < 3; i++, pi32Matrix += 3)
+    {
+        i32Channel = pi32Matrix[0] * ai32Xyz[0] + pi32Matrix[1] * ai32Xyz[1] + pi32Matrix[2] * ai32Xyz[2];
+        au32Rgb[i] = MAX(i32Channel, 0);
+        u32Max     = MAX(u32Max, au32Rgb[i]);
+    }
+
+    if (u32Max == 0)
+    {
+        *pu8Red = *pu8Green = *pu8Blue = 0;
+        return;
+    }
+
+    /* Bring the brightest channel to 255 with a single divide */
+    while (u32Max >= (1UL << COLOUR_NORM_BITS))
+    {
+        u32Max >>= 1;
+        au32Rgb[0] >>= 1; au32Rgb[1] >>= 1; au32Rgb[2] >>= 1;
+    }
+    while (u32Max < (1UL << (COLOUR_NORM_BITS - 1)))
+    {
+        u32Max <<= 1;
+        au32Rgb[0] <<= 1; au32Rgb[1] <<= 1; au32Rgb[2] <<= 1;
+    }
+    u32Scale = (255UL << COLOUR_NORM_BITS) / u32Max;
+
+    *pu8Red   = (au32Rgb[0] * u32Scale + (1UL << (COLOUR_NORM_BITS - 1))) >> COLOUR_NORM_BITS;
+    *pu8Green = (au32Rgb[1] * u32Scale + (1UL << (COLOUR_NORM_BITS - 1))) >> COLOUR_NORM_BITS;
+    *pu8Blue  = (au32Rgb[2] * u32Scale + (1UL << (COLOUR_NORM_BITS - 1))) >> COLOUR_NORM_BITS;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightColour_HSToRGB
+ *
+ * DESCRIPTION:
+ * Converts a hue and saturation to RGB at full brightness, in Q15 turns
+ * round the colour wheel of the light's own primaries
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightColour_HSToRGB(uint8 u8Hue, uint8 u8Saturation,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue)
+{
+    uint32 u32Hue6 = ((u8Hue % COLOUR_HS_MAX) * (6UL << COLOUR_Q15)) / COLOUR_HS_MAX;
+    uint32 u32Sat  = (MIN(u8Saturation, COLOUR_HS_MAX) << COLOUR_Q15) / COLOUR_HS_MAX;
+    uint32 u32Part = u32Hue6 & ((1UL << COLOUR_Q15) - 1);
+    uint8  u8P     = 255 - ((255 * u32Sat + (1UL << (COLOUR_Q15 - 1))) >> COLOUR_Q15);
+    uint8  u8Q     = 255 - ((255 * ((u32Sat * u32Part) >> COLOUR_Q15) + (1UL << (COLOUR_Q15 - 1))) >> COLOUR_Q15);
+    uint8  u8T     = 255 - ((255 * ((u32Sat * ((1UL << COLOUR_Q15) - u32Part)) >> COLOUR_Q15) +
+                             (1UL << (COLOUR_Q15 - 1))) >> COLOUR_Q15);
+
+    switch (u32Hue6 >> COLOUR_Q15)
+    {
+    case 0:  *pu8Red = 255; *pu8Green = u8T; *pu8Blue = u8P; break;
+    case 1:  *pu8Red = u8Q; *pu8Green = 255; *pu8Blue = u8P; break;
+    case 2:  *pu8Red = u8P; *pu8Green = 255; *pu8Blue = u8T; break;
+    case 3:  *pu8Red = u8P; *pu8Green = u8Q; *pu8Blue = 255; break;
+    case 4:  *pu8Red = u8T; *pu8Green = u8P; *pu8Blue = 255; break;
+    default: *pu8Red = 255; *pu8Green = u8P; *pu8Blue = u8Q; break;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightColour_CTToRGB
+ *
+ * DESCRIPTION:
+ * Converts a colour temperature to RGB at full brightness from the bulb
+ * layer's black body table, so an RGB light follows colour temperature
+ * commands without a tunable white channel
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightColour_CTToRGB(uint16 u16Mired,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue)
+{
+    uint32 u32Red;
+    uint32 u32Green;
+    uint32 u32Blue;
+
+    vBULB_MiredToRGB(u16Mired, &u32Red, &u32Green, &u32Blue);
+    *pu8Red   = COLOUR_TO_8BIT(u32Red);
+    *pu8Green = COLOUR_TO_8BIT(u32Green);
+    *pu8Blue  = COLOUR_TO_8BIT(u32Blue);
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: bApp_LightColour_Same
+ *
+ * DESCRIPTION:
+ * Whether two colours convert alike: the same mode, and the same values of
+ * the attributes that mode is converted from
+ *
+ * RETURNS:
+ * bool_t
+ *
+ ****************************************************************************/
+PRIVATE bool_t bApp_LightColour_Same(const tsAPP_LightColour *psA, const tsAPP_LightColour *psB)
+{
+    if (psA->u8ColourMode != psB->u8ColourMode)
+    {
+        return FALSE;
+    }
+
+    switch (psA->u8ColourMode)
+    {
+    case APP_LIGHT_COLOUR_MODE_HS:
+        return (psA->u8Hue == psB->u8Hue) && (psA->u8Saturation == psB->u8Saturation);
+
+    case APP_LIGHT_COLOUR_MODE_XY:
+        return (psA->u16X == psB->u16X) && (psA->u16Y == psB->u16Y);
+
+    default:
+        return (psA->u16ColourTemperatureMired == psB->u16ColourTemperatureMired);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: pi32App_LightColour_Matrix
+ *
+ * DESCRIPTION:
+ * The xyz to RGB matrix of the primaries and white point in zcl_options.h,
+ * worked out once in floating point on first use and kept in Q15
+ *
+ * RETURNS:
+ * The matrix, row by row
+ *
+ ****************************************************************************/
+PRIVATE const int32 *pi32App_LightColour_Matrix(void)
+{
+    const float afX[4] = { CLD_COLOURCONTROL_RED_X, CLD_COLOURCONTROL_GREEN_X,
+                           CLD_COLOURCONTROL_BLUE_X, CLD_COLOURCONTROL_WHITE_X };
+    const float afY[4] = { CLD_COLOURCONTROL_RED_Y, CLD_COLOURCONTROL_GREEN_Y,
+                           CLD_COLOURCONTROL_BLUE_Y, CLD_COLOURCONTROL_WHITE_Y };
+    float afP[9];
+    float afInv[9];
+    float fWhite;
+    uint8 i;
+    uint8 j;
+
+    if (bColourMatrixBuilt)
+    {
+        return ai32ColourMatrix;
+    }
+
+    /* Primaries as XYZ columns, each scaled to y so z = 1 - x - y */
+    for (j = 0; j < 3; j++)
+    {
+        afP[0 + j] = afX[j];
+        afP[3 + j] = afY[j];
+        afP[6 + j] = 1.0f - afX[j] - afY[j];
+    }
+
+    afInv[0] =  afP[4] * afP[8] - afP[5] * afP[7];
+    afInv[1] = -(afP[1] * afP[8] - afP[2] * afP[7]);
+    afInv[2] =  afP[1] * afP[5] - afP[2] * afP[4];
+    afInv[3] = -(afP[3] * afP[8] - afP[5] * afP[6]);
+    afInv[4] =  afP[0] * afP[8] - afP[2] * afP[6];
+    afInv[5] = -(afP[0] * afP[5] - afP[2] * afP[3]);
+    afInv[6] =  afP[3] * afP[7] - afP[4] * afP[6];
+    afInv[7] = -(afP[0] * afP[7] - afP[1] * afP[6]);
+    afInv[8] =  afP[0] * afP[4] - afP[1] * afP[3];
+
+    /*
+     * The adjugate above is the inverse times its determinant, which the
+     * white balance divides out again: each row is scaled so the white
+     * point comes out equal in all three primaries
+     */
+    for (i = 0; i < 3; i++)
+    {
+        fWhite = afInv[i * 3 + 0] * afX[3] + afInv[i * 3 + 1] * afY[3] + afInv[i * 3 + 2] * (1.0f - afX[3] - afY[3]);
+        for (j = 0; j < 3; j++)
+        {
+            float fEntry = afInv[i * 3 + j] / fWhite;
+
+            ai32ColourMatrix[i * 3 + j] = (int32)(fEntry * (1 << COLOUR_Q15) + ((fEntry < 0) ? -0.5f : 0.5f));
+        }
+    }
+    bColourMatrixBuilt = TRUE;
+    return ai32ColourMatrix;
+}
+
+#endif /* CLD_COLOUR_CONTROL */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
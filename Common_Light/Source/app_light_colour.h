@@ -0,0 +1,87 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_colour.h
+ *
+ * DESCRIPTION:        ZLL Demo: Colour Conversion - Interface
+ *
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_COLOUR_H
+#define APP_LIGHT_COLOUR_H
+
+#include <jendefs.h>
+#include "zcl_options.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Colour modes, as the values of the colour control ColourMode attribute */
+#define APP_LIGHT_COLOUR_MODE_HS        (0)
+#define APP_LIGHT_COLOUR_MODE_XY        (1)
+#define APP_LIGHT_COLOUR_MODE_CT        (2)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* The colour control attributes a colour is converted from */
+typedef struct
+{
+    uint8   u8ColourMode;
+    uint8   u8Hue;
+    uint8   u8Saturation;
+    uint16  u16X;
+    uint16  u16Y;
+    uint16  u16ColourTemperatureMired;
+} tsAPP_LightColour;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC bool_t bApp_LightColour_GetRGB(const tsAPP_LightColour *psColour,
+                                      uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue);
+PUBLIC void vApp_LightColour_XYToRGB(uint16 u16X, uint16 u16Y,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue);
+PUBLIC void vApp_LightColour_HSToRGB(uint8 u8Hue, uint8 u8Saturation,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue);
+PUBLIC void vApp_LightColour_CTToRGB(uint16 u16Mired,
+                                     uint8 *pu8Red, uint8 *pu8Green, uint8 *pu8Blue);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_COLOUR_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,260 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_curve.c
+ *
+ * DESCRIPTION:        ZLL Demo: Transition Curve Cluster - Implementation
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include <string.h>
+#include "zcl.h"
+#include "zcl_options.h"
+#include "dbg.h"
+#include "pdm.h"
+#include "PDM_IDs.h"
+#include "app_light_curve.h"
+#include "app_zcl_light_task.h"
+#include "DriverBulb_Shim.h"
+
+#ifdef DEBUG_LIGHT_TASK
+#define TRACE_LIGHT_TASK  TRUE
+#else
+#define TRACE_LIGHT_TASK FALSE
+#endif
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* The attributes kept in PDM; the PWM profile is kept by the bulb driver */
+typedef struct
+{
+    uint8   u8TransitionCurve;
+    uint8   u8ColourSpace;
+} tsAPP_LightCurveSaved;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const tsZCL_AttributeDefinition asApp_LightCurveAttributeDefinitions[] = {
+    {E_APP_LIGHT_CURVE_ATTR_ID_TRANSITION_CURVE, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_ENUM8,
+     (uint32)(&((tsAPP_LightCurve*)(0))->u8TransitionCurve), 0},
+    {E_APP_LIGHT_CURVE_ATTR_ID_COLOUR_SPACE, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_ENUM8,
+     (uint32)(&((tsAPP_LightCurve*)(0))->u8ColourSpace), 0},
+    {E_APP_LIGHT_CURVE_ATTR_ID_PWM_PROFILE, (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), E_ZCL_ENUM8,
+     (uint32)(&((tsAPP_LightCurve*)(0))->u8PwmProfile), 0},
+};
+
+PRIVATE tsZCL_ClusterDefinition sApp_LightCurveCluster = {
+    APP_CLUSTER_ID_LIGHT_CURVE,
+    TRUE,
+    E_ZCL_SECURITY_NETWORK,
+    (sizeof(asApp_LightCurveAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition)),
+    (tsZCL_AttributeDefinition*)asApp_LightCurveAttributeDefinitions,
+    NULL
+};
+
+PRIVATE uint8 au8App_LightCurveAttributeControlBits[(sizeof(asApp_LightCurveAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition))];
+
+PRIVATE tsAPP_LightCurve sLightCurve = { E_LI_CURVE_LINEAR, E_LI_COLOUR_RGB, E_PWM_PROFILE_STANDARD };
+
+/* As last saved in PDM */
+PRIVATE tsAPP_LightCurveSaved sSavedCurve = { E_LI_CURVE_LINEAR, E_LI_COLOUR_RGB };
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCurve_Register
+ *
+ * DESCRIPTION:
+ * Adds the transition curve cluster to an endpoint that is already
+ * registered, after the device's own cluster instances in
+ * psClusterInstances, which has room for u16MaxClusters, and restores
+ * its attributes from PDM. The PWM profile is read from the bulb driver,
+ * which has loaded its own from PDM.
+ *
+ * RETURNS:
+ * teZCL_Status
+ *
+ ****************************************************************************/
+PUBLIC teZCL_Status eApp_LightCurve_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                             tsZCL_ClusterInstance *psClusterInstances,
+                                             uint16 u16MaxClusters)
+{
+    teZCL_Status eZCL_Status;
+    tsAPP_LightCurveSaved sSaved;
+    uint16 u16BytesRead;
+
+    eZCL_Status = eApp_AppendCluster(psEndPointDefinition, psClusterInstances, u16MaxClusters,
+                                     &sApp_LightCurveCluster, &sLightCurve, au8App_LightCurveAttributeControlBits);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    if ((PDM_eReadDataFromRecord(PDM_ID_APP_LIGHT_CURVE, &sSaved, sizeof(sSaved), &u16BytesRead) == PDM_E_STATUS_OK) &&
+        (u16BytesRead == sizeof(sSaved)))
+    {
+        sLightCurve.u8TransitionCurve = sSaved.u8TransitionCurve;
+        sLightCurve.u8ColourSpace = sSaved.u8ColourSpace;
+        sSavedCurve = sSaved;
+    }
+    sLightCurve.u8PwmProfile = u8BULB_GetPwmProfile();
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCurve_CheckAttribute
+ *
+ * DESCRIPTION:
+ * Called as each attribute of a write to the cluster is checked, before it
+ * is stored, with the value written. A PWM profile the bulb driver does
+ * not have fails the write of that attribute with INVALID_VALUE; the
+ * curve and colour space take any value.
+ *
+ * RETURNS:
+ * teZCL_CommandStatus
+ *
+ ****************************************************************************/
+PUBLIC teZCL_CommandStatus eApp_LightCurve_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData)
+{
+    if ((u16AttributeId == E_APP_LIGHT_CURVE_ATTR_ID_PWM_PROFILE) &&
+        !bBULB_CheckPwmProfile(*(uint8 *)pvAttributeData))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nPWM profile %d refused", *(uint8 *)pvAttributeData);
+        return E_ZCL_CMDS_INVALID_VALUE;
+    }
+    return E_ZCL_CMDS_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightCurve_Update
+ *
+ * DESCRIPTION:
+ * Saves the curve and colour space in PDM once a write to the cluster has
+ * completed, if they changed, and hands a changed PWM profile to the bulb
+ * driver, which keeps it in PDM. The profile is only handed over when it
+ * changes, as switching restarts the PWM timers.
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightCurve_Update(void)
+{
+    if ((sLightCurve.u8TransitionCurve != sSavedCurve.u8TransitionCurve) ||
+        (sLightCurve.u8ColourSpace != sSavedCurve.u8ColourSpace))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nCurve %d space %d", sLightCurve.u8TransitionCurve, sLightCurve.u8ColourSpace);
+        sSavedCurve.u8TransitionCurve = sLightCurve.u8TransitionCurve;
+        sSavedCurve.u8ColourSpace = sLightCurve.u8ColourSpace;
+        PDM_eSaveRecordData(PDM_ID_APP_LIGHT_CURVE, &sSavedCurve, sizeof(sSavedCurve));
+    }
+
+    if ((sLightCurve.u8PwmProfile != u8BULB_GetPwmProfile()) &&
+        !bBULB_SetPwmProfile(sLightCurve.u8PwmProfile))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nPWM profile %d refused", sLightCurve.u8PwmProfile);
+    }
+    sLightCurve.u8PwmProfile = u8BULB_GetPwmProfile();
+}
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCurve_Get
+ *
+ * DESCRIPTION:
+ * The curve for the next transition, linear for any value the attribute
+ * was written with that LI does not know
+ *
+ * RETURNS:
+ * teLI_Curve
+ *
+ ****************************************************************************/
+PUBLIC teLI_Curve eApp_LightCurve_Get(void)
+{
+    if (sLightCurve.u8TransitionCurve >= E_LI_CURVE_NUM)
+    {
+        return E_LI_CURVE_LINEAR;
+    }
+    return (teLI_Curve)sLightCurve.u8TransitionCurve;
+}
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightCurve_GetColourSpace
+ *
+ * DESCRIPTION:
+ * The space colour transitions are interpolated in, RGB for any value the
+ * attribute was written with that LI does not know
+ *
+ * RETURNS:
+ * teLI_ColourSpace
+ *
+ ****************************************************************************/
+PUBLIC teLI_ColourSpace eApp_LightCurve_GetColourSpace(void)
+{
+    if (sLightCurve.u8ColourSpace >= E_LI_COLOUR_NUM)
+    {
+        return E_LI_COLOUR_RGB;
+    }
+    return (teLI_ColourSpace)sLightCurve.u8ColourSpace;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_curve.h
+ *
+ * DESCRIPTION:        ZLL Demo: Transition Curve Cluster - Interface
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_CURVE_H
+#define APP_LIGHT_CURVE_H
+
+#include <jendefs.h>
+#include "zcl.h"
+#include "app_light_interpolation.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * Manufacturer specific cluster on the light endpoint holding the curve
+ * the light's own transitions take, and the colour space colour
+ * transitions are interpolated in. Both are kept in PDM rather than in
+ * the scenes, so the scene records keep their size; a scene stored or
+ * added keeps the curve in its own PDM record, keyed by group and scene
+ * ID, and its level transition takes that curve when it is recalled. The PWM frequency
+ * profile of the fixture is written here too, on every light, and is
+ * kept in PDM by the bulb driver; one the driver does not have fails
+ * with INVALID_VALUE.
+ */
+#define APP_CLUSTER_ID_LIGHT_CURVE          (0xFC01)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef enum
+{
+    E_APP_LIGHT_CURVE_ATTR_ID_TRANSITION_CURVE = 0x0000,  /* teLI_Curve */
+    E_APP_LIGHT_CURVE_ATTR_ID_COLOUR_SPACE     = 0x0001,  /* teLI_ColourSpace */
+    E_APP_LIGHT_CURVE_ATTR_ID_PWM_PROFILE      = 0x0010,  /* tePwmProfile */
+} teAPP_LightCurveAttributeID;
+
+typedef struct
+{
+    zenum8  u8TransitionCurve;
+    zenum8  u8ColourSpace;
+    zenum8  u8PwmProfile;
+} tsAPP_LightCurve;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC teZCL_Status eApp_LightCurve_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                             tsZCL_ClusterInstance *psClusterInstances,
+                                             uint16 u16MaxClusters);
+PUBLIC teZCL_CommandStatus eApp_LightCurve_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData);
+PUBLIC void vApp_LightCurve_Update(void);
+PUBLIC teLI_Curve eApp_LightCurve_Get(void);
+PUBLIC teLI_ColourSpace eApp_LightCurve_GetColourSpace(void);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_CURVE_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,264 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_diagnostics.c
+ *
+ * DESCRIPTION:        ZLL Demo: Tick Diagnostics Cluster - Implementation
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include <string.h>
+#include "zcl.h"
+#include "zcl_options.h"
+#include "app_light_diagnostics.h"
+#include "app_zcl_light_task.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define APP_LIGHT_DIAGNOSTICS_ATTR(u16Id, u8Flags, eType, member) \
+    {(u16Id), ((u8Flags)|E_ZCL_AF_MS), (eType), (uint32)(&((tsAPP_LightDiagnostics*)(0))->member), 0}
+
+#define APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(eTimed, eAttr) \
+    APP_LIGHT_DIAGNOSTICS_ATTR(APP_LIGHT_DIAGNOSTICS_ATTR_TIMED_BASE + (eTimed) * APP_LIGHT_DIAGNOSTICS_ATTR_TIMED_STEP + (eAttr), \
+                               E_ZCL_AF_RD, E_ZCL_UINT32, au32Timed[eTimed][eAttr])
+
+/* Tick timer counts to the units of the attributes */
+#define APP_LIGHT_DIAGNOSTICS_US(u32Counts)     ((u32Counts) / APP_TICK_COUNTS_PER_US)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE uint32 u32App_LightDiagnostics_Mean(const tsAPP_TickTiming *psTiming);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+PRIVATE const tsZCL_AttributeDefinition asApp_LightDiagnosticsAttributeDefinitions[] = {
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_WAKES,         E_ZCL_AF_RD, E_ZCL_UINT32, u32Wakes),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_TICKS,         E_ZCL_AF_RD, E_ZCL_UINT32, u32Ticks),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_IDLE_WAKES,    E_ZCL_AF_RD, E_ZCL_UINT32, u32IdleWakes),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_EARLY_WAKES,   E_ZCL_AF_RD, E_ZCL_UINT32, u32EarlyWakes),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LONGEST_SLEEP, E_ZCL_AF_RD, E_ZCL_UINT32, u32LongestSleep),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MIN,      E_ZCL_AF_RD, E_ZCL_UINT32, u32LateMin),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MAX,      E_ZCL_AF_RD, E_ZCL_UINT32, u32LateMax),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MEAN,     E_ZCL_AF_RD, E_ZCL_UINT32, u32LateMean),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_INTERVAL_MIN,  E_ZCL_AF_RD, E_ZCL_UINT32, u32IntervalMin),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_INTERVAL_MAX,  E_ZCL_AF_RD, E_ZCL_UINT32, u32IntervalMax),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_MADE_UP,       E_ZCL_AF_RD, E_ZCL_UINT32, u32MadeUp),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_DROPPED,       E_ZCL_AF_RD, E_ZCL_UINT32, u32Dropped),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_COALESCED,     E_ZCL_AF_RD, E_ZCL_UINT32, u32Coalesced),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 0, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[0]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 1, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[1]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 2, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[2]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 3, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[3]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 4, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[4]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 5, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[5]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 6, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[6]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM + 7, E_ZCL_AF_RD, E_ZCL_UINT32, au32LateHistogram[7]),
+    APP_LIGHT_DIAGNOSTICS_ATTR(E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_RESET,         (E_ZCL_AF_RD|E_ZCL_AF_WR), E_ZCL_BOOL, bReset),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_UPDATE_100MS, E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_UPDATE_100MS, E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_UPDATE_100MS, E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_UPDATE_100MS, E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_LI, E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_LI, E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_LI, E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_LI, E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_BULB, E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_BULB, E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_BULB, E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_BULB, E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_OTA, E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_OTA, E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_OTA, E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_OTA, E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_ZCL_TIMER, E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_ZCL_TIMER, E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_ZCL_TIMER, E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX),
+    APP_LIGHT_DIAGNOSTICS_TIMED_ATTR(E_APP_TICK_TIMED_ZCL_TIMER, E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN),
+};
+
+PRIVATE tsZCL_ClusterDefinition sApp_LightDiagnosticsCluster = {
+    APP_CLUSTER_ID_LIGHT_DIAGNOSTICS,
+    TRUE,
+    E_ZCL_SECURITY_NETWORK,
+    (sizeof(asApp_LightDiagnosticsAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition)),
+    (tsZCL_AttributeDefinition*)asApp_LightDiagnosticsAttributeDefinitions,
+    NULL
+};
+
+PRIVATE uint8 au8App_LightDiagnosticsAttributeControlBits[(sizeof(asApp_LightDiagnosticsAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition))];
+
+PRIVATE tsAPP_LightDiagnostics sLightDiagnostics;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightDiagnostics_Register
+ *
+ * DESCRIPTION:
+ * Adds the diagnostics cluster to an endpoint that is already registered,
+ * after any other manufacturer cluster in psClusterInstances, with
+ * eApp_AppendCluster
+ *
+ * RETURNS:
+ * teZCL_Status
+ *
+ ****************************************************************************/
+PUBLIC teZCL_Status eApp_LightDiagnostics_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                                   tsZCL_ClusterInstance *psClusterInstances,
+                                                   uint16 u16MaxClusters)
+{
+    teZCL_Status eZCL_Status;
+
+    eZCL_Status = eApp_AppendCluster(psEndPointDefinition, psClusterInstances, u16MaxClusters,
+                                     &sApp_LightDiagnosticsCluster, &sLightDiagnostics, au8App_LightDiagnosticsAttributeControlBits);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    vApp_LightDiagnostics_Refresh();
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightDiagnostics_Refresh
+ *
+ * DESCRIPTION:
+ * Fills the attributes from the tick statistics and timings, converted to
+ * ms and us. Called on the 1Hz tick rather than on every read
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightDiagnostics_Refresh(void)
+{
+    tsAPP_TickStats sStats;
+    tsAPP_TickDiag  sDiag;
+    uint8 i;
+
+    vApp_Tick_GetStats(&sStats);
+    vApp_Tick_GetDiag(&sDiag);
+
+    sLightDiagnostics.u32Wakes        = sStats.u32Wakes;
+    sLightDiagnostics.u32Ticks        = sStats.u32Ticks;
+    sLightDiagnostics.u32IdleWakes    = sStats.u32IdleWakes;
+    sLightDiagnostics.u32EarlyWakes   = sStats.u32EarlyWakes;
+    sLightDiagnostics.u32LongestSleep = sStats.u32LongestSleep * APP_TICK_TIME_MS;
+
+    sLightDiagnostics.u32LateMin      = APP_LIGHT_DIAGNOSTICS_US(sDiag.sLate.u32Min);
+    sLightDiagnostics.u32LateMax      = APP_LIGHT_DIAGNOSTICS_US(sDiag.sLate.u32Max);
+    sLightDiagnostics.u32LateMean     = u32App_LightDiagnostics_Mean(&sDiag.sLate);
+    sLightDiagnostics.u32IntervalMin  = APP_LIGHT_DIAGNOSTICS_US(sDiag.sInterval.u32Min);
+    sLightDiagnostics.u32IntervalMax  = APP_LIGHT_DIAGNOSTICS_US(sDiag.sInterval.u32Max);
+    sLightDiagnostics.u32MadeUp       = sDiag.u32MadeUp;
+    sLightDiagnostics.u32Dropped      = sDiag.u32Dropped;
+    sLightDiagnostics.u32Coalesced    = sDiag.u32Coalesced;
+    memcpy(sLightDiagnostics.au32LateHistogram, sDiag.au32LateHistogram, sizeof(sDiag.au32LateHistogram));
+
+    for (i = 0; i < E_APP_TICK_TIMED_NUM; i++)
+    {
+        sLightDiagnostics.au32Timed[i][E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT] = sDiag.asTimed[i].u32Count;
+        sLightDiagnostics.au32Timed[i][E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN]   = APP_LIGHT_DIAGNOSTICS_US(sDiag.asTimed[i].u32Min);
+        sLightDiagnostics.au32Timed[i][E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX]   = APP_LIGHT_DIAGNOSTICS_US(sDiag.asTimed[i].u32Max);
+        sLightDiagnostics.au32Timed[i][E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN]  = u32App_LightDiagnostics_Mean(&sDiag.asTimed[i]);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightDiagnostics_Update
+ *
+ * DESCRIPTION:
+ * Clears the statistics and timings once a write of TRUE to Reset has
+ * completed
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightDiagnostics_Update(void)
+{
+    if (sLightDiagnostics.bReset)
+    {
+        sLightDiagnostics.bReset = FALSE;
+        vApp_Tick_ResetDiag();
+        vApp_LightDiagnostics_Refresh();
+    }
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: u32App_LightDiagnostics_Mean
+ *
+ * DESCRIPTION:
+ * Mean of a timing in us
+ *
+ * RETURNS:
+ * uint32
+ *
+ ****************************************************************************/
+PRIVATE uint32 u32App_LightDiagnostics_Mean(const tsAPP_TickTiming *psTiming)
+{
+    if (psTiming->u32Count == 0)
+    {
+        return 0;
+    }
+    return (uint32)(psTiming->u64Total / psTiming->u32Count / APP_TICK_COUNTS_PER_US);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
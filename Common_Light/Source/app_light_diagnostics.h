@@ -0,0 +1,128 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_diagnostics.h
+ *
+ * DESCRIPTION:        ZLL Demo: Tick Diagnostics Cluster - Interface
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_DIAGNOSTICS_H
+#define APP_LIGHT_DIAGNOSTICS_H
+
+#include <jendefs.h>
+#include "zcl.h"
+#include "app_light_tick.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * Manufacturer specific cluster on the light endpoint reporting how
+ * Tick_Task is keeping time: its wakes, how late each run began, the time
+ * between runs, the stage runs late runs made up or dropped and what each
+ * part of a run took, in us. The attributes are
+ * refreshed on the 1Hz tick; writing TRUE to Reset clears them.
+ */
+#define APP_CLUSTER_ID_LIGHT_DIAGNOSTICS    (0xFC03)
+
+/* Attribute of the first timed part; each part has 0x10 IDs from here */
+#define APP_LIGHT_DIAGNOSTICS_ATTR_TIMED_BASE   (0x0100)
+#define APP_LIGHT_DIAGNOSTICS_ATTR_TIMED_STEP   (0x0010)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef enum
+{
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_WAKES = 0x0000,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_TICKS,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_IDLE_WAKES,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_EARLY_WAKES,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LONGEST_SLEEP,          /* ms */
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MIN = 0x0010,      /* us */
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MAX,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_MEAN,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_INTERVAL_MIN,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_INTERVAL_MAX,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_MADE_UP,                /* stage runs */
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_DROPPED,
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_COALESCED,              /* cluster updates */
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_LATE_HISTOGRAM = 0x0020, /* to 0x0027, runs per bucket */
+    E_APP_LIGHT_DIAGNOSTICS_ATTR_ID_RESET = 0x00F0,
+} teAPP_LightDiagnosticsAttributeID;
+
+/* Per timed part, added to its base */
+typedef enum
+{
+    E_APP_LIGHT_DIAGNOSTICS_TIMED_COUNT,
+    E_APP_LIGHT_DIAGNOSTICS_TIMED_MIN,                      /* us */
+    E_APP_LIGHT_DIAGNOSTICS_TIMED_MAX,
+    E_APP_LIGHT_DIAGNOSTICS_TIMED_MEAN,
+} teAPP_LightDiagnosticsTimedAttribute;
+
+typedef struct
+{
+    zuint32 u32Wakes;
+    zuint32 u32Ticks;
+    zuint32 u32IdleWakes;
+    zuint32 u32EarlyWakes;
+    zuint32 u32LongestSleep;
+    zuint32 u32LateMin;
+    zuint32 u32LateMax;
+    zuint32 u32LateMean;
+    zuint32 u32IntervalMin;
+    zuint32 u32IntervalMax;
+    zuint32 u32MadeUp;
+    zuint32 u32Dropped;
+    zuint32 u32Coalesced;
+    zuint32 au32LateHistogram[APP_TICK_LATE_BUCKETS];
+    zbool   bReset;
+    zuint32 au32Timed[E_APP_TICK_TIMED_NUM][4];
+} tsAPP_LightDiagnostics;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC teZCL_Status eApp_LightDiagnostics_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                                   tsZCL_ClusterInstance *psClusterInstances,
+                                                   uint16 u16MaxClusters);
+PUBLIC void vApp_LightDiagnostics_Refresh(void);
+PUBLIC void vApp_LightDiagnostics_Update(void);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_DIAGNOSTICS_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
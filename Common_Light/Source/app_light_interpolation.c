@@ -38,6 +38,7 @@
 /***        Include files                                                 ***/
 /****************************************************************************/
 #include <jendefs.h>
+#include <string.h>
 #include "app_light_interpolation.h"
 #include "DriverBulb_Shim.h"
 
@@ -47,32 +48,156 @@
 #define INTPOINTS	(10)
 #define SCALE 		(7)
 
+/* Fixed point channel value to 12 bits for the driver, 255.0 -> 4095 */
+#define LI_TO_12BIT(u32Value)	(((u32Value) >> (SCALE - 4)) + ((u32Value) >> (SCALE + 4)))
+
+/*
+ * Channels are packed two to a word in 16 bit lanes, SIMD within a register.
+ * The value lanes hold a channel in their low 15 bits (8.7 fixed point for
+ * level and colour) with the top bit as a guard that stops a carry or borrow
+ * reaching the next lane. A second word holds a 15 bit fraction per lane, so
+ * a point adds a 31 bit two's complement step to every channel of a word at
+ * once and even a 30 minute fade moves every point.
+ */
+#define LI_LANE_BITS	(16)
+#define LI_LANE_MASK	(0x7FFF)
+#define LI_FRAC_BITS	(15)
+#define LI_GUARD		(0x80008000UL)
+#define LI_HUE_TURN		(LI_LANE_MASK + 1)
+
+/* Lane of each channel carried for this light */
+#define LI_LANE_LEVEL	(0)
+#if (defined LI_RGB)
+#define LI_LANE_RED		(1)
+#define LI_LANE_GREEN	(2)
+#define LI_LANE_BLUE	(3)
+#define LI_LANES		(4)
+/* The colour lanes in HSV, hue LI_HUE_TURN to a turn so it wraps with the lane */
+#define LI_LANE_HUE		LI_LANE_RED
+#define LI_LANE_SAT		LI_LANE_GREEN
+#define LI_LANE_VAL		LI_LANE_BLUE
+#define LI_COLOUR_LANES	((1 << LI_LANE_RED) | (1 << LI_LANE_GREEN) | (1 << LI_LANE_BLUE))
+#elif (defined LI_COLTEMP)
+#define LI_LANE_COLTEMP	(1)
+#define LI_LANES		(2)
+#else
+#define LI_LANES		(1)
+#endif
+#define LI_WORDS		((LI_LANES + 1) / 2)
+
+#define LI_LANE_SHIFT(u8Lane)			(((u8Lane) & 1) * LI_LANE_BITS)
+#define LI_LANE(pu32Words, u8Lane)		(((pu32Words)[(u8Lane) >> 1] >> LI_LANE_SHIFT(u8Lane)) & LI_LANE_MASK)
+
+/*
+ * A shaped transition is rendered as this many linear pieces, each stepped
+ * by the packed adds above. Only the piece boundaries follow the curve, so
+ * the shape costs nothing per point.
+ */
+#define LI_CURVE_PIECES	(16)
+
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 typedef struct
 {
-	uint32 u32Current;
-	uint32 u32Target;
-	int32  i32Delta;
-}tsLI_Params;
+	uint32 au32Value[LI_WORDS];		/* current value lanes                */
+	uint32 au32Frac[LI_WORDS];		/* and their fractions                */
+	uint32 au32Step[LI_WORDS];		/* per point step, whole part lanes   */
+	uint32 au32StepFrac[LI_WORDS];	/* and fraction lanes                 */
+	uint32 au32Target[LI_WORDS];	/* value lanes at the last point      */
+}tsLI_Packed;
 
+/*
+ * Each channel runs its own transition at its own point rate, timed in LI
+ * ticks counted from when LI was last idle. The packed step of a channel
+ * that is not moving is zero, so while every moving channel outputs a
+ * point each tick they are all stepped together, and a channel only needs
+ * looking at on the ticks its transition ends or its curve turns.
+ */
 typedef struct
 {
-	tsLI_Params sLevel;
-	tsLI_Params sRed;
-	tsLI_Params sGreen;
-	tsLI_Params sBlue;
-	tsLI_Params sColTemp;
-	uint32      u32PointsAdded;
+	uint32      u32Begin;			/* tick its transition started on     */
+	uint32      u32End;				/* tick it lands on its target        */
+	uint32      u32PieceEnd;		/* tick that ends its current piece   */
+	uint16      u16Start;			/* value a shaped transition left     */
+	uint8       u8Piece;			/* piece of a shaped transition       */
+	uint8       u8Curve;			/* teLI_Curve                         */
+	uint8       u8TicksPerPoint;
+	uint8       u8TickCount;
+	bool_t      bDirect;			/* started by vLI_StartTransition     */
+}tsLI_Timeline;
+
+/* Only the channels selected in app_light_interpolation.h are carried */
+typedef struct
+{
+	tsLI_Packed   sChannels;
+	tsLI_Timeline asTimeline[LI_LANES];
+	uint32      u32Tick;			/* ticks gone by since LI was idle    */
+	uint32      u32NextEvent;		/* first tick a channel needs seeing to */
+	uint8       u8Active;			/* lanes with a transition running    */
+	uint8       u8Slow;				/* moving lanes not stepped every tick */
+#ifdef LI_RGB
+	uint8       u8ColourSpace;		/* teLI_ColourSpace of the colour lanes */
+	uint16      au16Rgb[3];			/* colour the colour lanes are heading for */
+#endif
 
 }tsLI_Vars;
 
+/*
+ * Weight of the first piece of a curve and its first and second forward
+ * differences; u8Growth, when set, also grows the weight by 1/2^u8Growth
+ * each piece. Summed over the pieces these give the curve at each piece
+ * boundary with adds and shifts alone: linear 16, quadratic 16^2,
+ * smoothstep 3*16*k^2 - 2*k^3 so 16^3, and a 5/4 geometric series.
+ */
+typedef struct
+{
+	int16  i16Weight;
+	int16  i16Diff1;
+	int16  i16Diff2;
+	uint8  u8Growth;
+}tsLI_CurveDiffs;
+
+#ifdef LI_SEGMENTS
+/* Red, green and blue in lanes 0 to 2 */
+typedef struct
+{
+	tsLI_Packed sChannels;
+	uint32      u32Points;
+	uint32      u32PointsAdded;
+	uint32      u32TicksPerPoint;
+	uint32      u32TickCount;
+	bool_t      bOwned;				/* colour differs from the whole light */
+}tsLI_Segment;
+#endif
+
 /****************************************************************************/
 /***        Local Function Prototypes                                     ***/
 /****************************************************************************/
 
-PRIVATE void vLI_InitVar(tsLI_Params *psLI_Params, uint32 u32NewTarget);
+PRIVATE void vLI_Begin(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp,
+                       uint8 u8Channels, uint32 u32Points, uint32 u32TicksPerPoint, teLI_Curve eCurve, bool_t bDirect);
+PRIVATE void vLI_InitLane(tsLI_Packed *psPacked, uint8 u8Lane, uint32 u32NewTarget, uint32 u32Points, bool_t bWrap);
+PRIVATE void vLI_AimLane(tsLI_Packed *psPacked, uint8 u8Lane, uint32 u32Aim, uint32 u32Points, bool_t bWrap);
+#ifdef LI_RGB
+PRIVATE bool_t bLI_Wraps(uint8 u8Lane);
+PRIVATE void vLI_GetRGB(uint32 *pu32Rgb);
+PRIVATE void vLI_RGBToHSV(uint32 *pu32Colour);
+PRIVATE void vLI_HSVToRGB(uint32 u32Hue, uint32 u32Sat, uint32 u32Val, uint32 *pu32Rgb);
+#endif
+PRIVATE const uint16 *pu16LI_Curve(teLI_Curve eCurve);
+PRIVATE void vLI_StartPiece(uint8 u8Lane);
+PRIVATE void vLI_ServiceLanes(void);
+PRIVATE void vLI_NextEvent(void);
+PRIVATE void vLI_SetLane(uint32 *pu32Words, uint8 u8Lane, uint32 u32Value);
+PRIVATE void vLI_StepPacked(tsLI_Packed *psPacked);
+PRIVATE bool_t bLI_StepDueLanes(void);
+PRIVATE void vLI_StepLane(tsLI_Packed *psPacked, uint8 u8Lane);
+PRIVATE void vLI_LandLane(tsLI_Packed *psPacked, uint8 u8Lane);
+#ifdef LI_SEGMENTS
+PRIVATE void vLI_LandPacked(tsLI_Packed *psPacked);
+PRIVATE void vLI_CreateSegmentPoints(uint32 u32Ticks, bool_t bUpdated);
+#endif
 PRIVATE uint32  u32divu10(uint32 n);
 
 /****************************************************************************/
@@ -83,12 +208,38 @@ PRIVATE uint32  u32divu10(uint32 n);
 /***        Local Variables                                               ***/
 /****************************************************************************/
 
-PRIVATE tsLI_Vars sLI_Vars = {.sLevel.i32Delta   = 0,
-		                      .sRed.i32Delta     = 0,
-                              .sGreen.i32Delta   = 0,
-                              .sBlue.i32Delta    = 0,
-                              .sColTemp.i32Delta = 0,
-                              .u32PointsAdded  = INTPOINTS};
+PRIVATE tsLI_Vars sLI_Vars = {.u8Active = 0,
+                              .u8Slow   = 0};
+
+/* Channel of each lane, as given to vLI_StartTransition */
+PRIVATE const uint8 au8LI_LaneChannel[LI_LANES] =
+{
+	[LI_LANE_LEVEL]   = LI_CHANNEL_LEVEL,
+#ifdef LI_RGB
+	[LI_LANE_RED]     = LI_CHANNEL_RED,
+	[LI_LANE_GREEN]   = LI_CHANNEL_GREEN,
+	[LI_LANE_BLUE]    = LI_CHANNEL_BLUE,
+#endif
+#ifdef LI_COLTEMP
+	[LI_LANE_COLTEMP] = LI_CHANNEL_COLTEMP,
+#endif
+};
+
+PRIVATE const tsLI_CurveDiffs asLI_CurveDiffs[E_LI_CURVE_NUM] =
+{
+	[E_LI_CURVE_LINEAR]      = { 1,                       0,                       0,   0 },
+	[E_LI_CURVE_EASE_IN]     = { 1,                       2,                       0,   0 },
+	[E_LI_CURVE_EASE_OUT]    = { 2 * LI_CURVE_PIECES - 1, -2,                      0,   0 },
+	[E_LI_CURVE_S_CURVE]     = { 3 * LI_CURVE_PIECES - 2, 6 * LI_CURVE_PIECES - 12, -12, 0 },
+	[E_LI_CURVE_EXPONENTIAL] = { 64,                      0,                       0,   2 },
+};
+
+/* Progress of each curve at each piece boundary, filled in on first use */
+PRIVATE uint16 au16LI_Curve[E_LI_CURVE_NUM][LI_CURVE_PIECES + 1];
+
+#ifdef LI_SEGMENTS
+PRIVATE tsLI_Segment asLI_Segment[LI_SEGMENTS];
+#endif
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -102,56 +253,326 @@ PRIVATE tsLI_Vars sLI_Vars = {.sLevel.i32Delta   = 0,
  ****************************************************************************/
 PUBLIC void vLI_SetCurrentValues(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp)
 {
-	sLI_Vars.sLevel.u32Current   += u32Level   << SCALE;
-	sLI_Vars.sRed.u32Current     += u32Red     << SCALE;
-	sLI_Vars.sGreen.u32Current   += u32Blue    << SCALE;
-    sLI_Vars.sBlue.u32Current    += u32Green   << SCALE;
-    sLI_Vars.sColTemp.u32Current += u32ColTemp << SCALE;
+	tsLI_Packed *psPacked = &sLI_Vars.sChannels;
 
+#ifdef LI_RGB
+	uint32 au32Colour[3] = { u32Red << SCALE, u32Green << SCALE, u32Blue << SCALE };
+
+	sLI_Vars.au16Rgb[0] = au32Colour[0];
+	sLI_Vars.au16Rgb[1] = au32Colour[1];
+	sLI_Vars.au16Rgb[2] = au32Colour[2];
+	if (sLI_Vars.u8ColourSpace == E_LI_COLOUR_HSV)
+	{
+		vLI_RGBToHSV(au32Colour);
+	}
+#endif
+
+	vLI_SetLane(psPacked->au32Value, LI_LANE_LEVEL,   u32Level   << SCALE);
+#ifdef LI_RGB
+	vLI_SetLane(psPacked->au32Value, LI_LANE_RED,     au32Colour[0]);
+	vLI_SetLane(psPacked->au32Value, LI_LANE_GREEN,   au32Colour[1]);
+	vLI_SetLane(psPacked->au32Value, LI_LANE_BLUE,    au32Colour[2]);
+#endif
+#ifdef LI_COLTEMP
+	vLI_SetLane(psPacked->au32Value, LI_LANE_COLTEMP, MIN(u32ColTemp, LI_LANE_MASK));
+#endif
+}
+
+/****************************************************************************
+ * NAME: vLI_GetCurrentValues
+ *
+ * DESCRIPTION:
+ * Gets the values last passed to the driver, level and colour at 12 bits.
+ * Channels this light does not carry read as 0.
+ ****************************************************************************/
+PUBLIC void vLI_GetCurrentValues(uint32 *pu32Level, uint32 *pu32Red, uint32 *pu32Green, uint32 *pu32Blue, uint32 *pu32ColTemp)
+{
+	const uint32 *pu32Value = sLI_Vars.sChannels.au32Value;
+#ifdef LI_RGB
+	uint32 au32Rgb[3];
+
+	vLI_GetRGB(au32Rgb);
+#endif
+
+	*pu32Level   = LI_TO_12BIT(LI_LANE(pu32Value, LI_LANE_LEVEL));
+#ifdef LI_RGB
+	*pu32Red     = LI_TO_12BIT(au32Rgb[0]);
+	*pu32Green   = LI_TO_12BIT(au32Rgb[1]);
+	*pu32Blue    = LI_TO_12BIT(au32Rgb[2]);
+#else
+	*pu32Red     = 0;
+	*pu32Green   = 0;
+	*pu32Blue    = 0;
+#endif
+#ifdef LI_COLTEMP
+	*pu32ColTemp = LI_LANE(pu32Value, LI_LANE_COLTEMP);
+#else
+	*pu32ColTemp = 0;
+#endif
 }
 
 /****************************************************************************
  * NAME: vLI_Start
  *
  * DESCRIPTION:
- * Starts the linear interpolation process between successive ZCL updates
+ * Starts the linear interpolation process between successive ZCL updates,
+ * i.e. a transition to the new cluster values over the next 100ms. Only
+ * channels whose cluster value has moved are retargeted, and channels in
+ * a transition of their own from vLI_StartTransition are left to finish it.
  ****************************************************************************/
 PUBLIC void vLI_Start(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp)
 {
-	vLI_InitVar(&sLI_Vars.sLevel,    u32Level);
-	vLI_InitVar(&sLI_Vars.sRed,      u32Red);
-	vLI_InitVar(&sLI_Vars.sGreen,    u32Green);
-    vLI_InitVar(&sLI_Vars.sBlue,     u32Blue);
-    vLI_InitVar(&sLI_Vars.sColTemp,  u32ColTemp);
-    vLI_UpdateDriver();
-    sLI_Vars.u32PointsAdded  = 1;
+	vLI_Begin(u32Level, u32Red, u32Green, u32Blue, u32ColTemp, LI_CHANNEL_ALL, INTPOINTS, 1, E_LI_CURVE_LINEAR, FALSE);
 }
 
+/****************************************************************************
+ * NAME: vLI_StartTransition
+ *
+ * DESCRIPTION:
+ * Starts a transition of the channels in u8Channels from their current
+ * values to the given targets that lasts u32TimeMs, producing u32RateHz
+ * output points per second. Other channels carry on with whatever they
+ * were doing. It is rendered from vLI_CreatePoints alone and does not need
+ * the ZCL cluster to be updated while it runs. Every channel follows
+ * eCurve; one shorter than LI_CURVE_PIECES points is too short to show a
+ * shape and is linear. The rate is kept with each channel, so a later
+ * start of other channels does not change it.
+ ****************************************************************************/
+PUBLIC void vLI_StartTransition(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp,
+		                        uint8 u8Channels, uint32 u32TimeMs, uint32 u32RateHz, teLI_Curve eCurve)
+{
+	uint32 u32Points;
+
+	u32RateHz = MAX(1, MIN(u32RateHz, LI_TICK_RATE_HZ));
+	u32Points = MAX(1, (u32TimeMs * u32RateHz) / 1000);
+
+	vLI_Begin(u32Level, u32Red, u32Green, u32Blue, u32ColTemp, u8Channels, u32Points,
+	          LI_TICK_RATE_HZ / u32RateHz, eCurve, TRUE);
+}
+
+#ifdef LI_SEGMENTS
+/****************************************************************************
+ * NAME: vLI_StartSegmentTransition
+ *
+ * DESCRIPTION:
+ * As vLI_StartTransition for the colour of one segment of an addressable
+ * strip. The segment starts from the colour of the whole light unless it
+ * already has its own, and keeps its own until the colour of the whole
+ * light is next changed.
+ ****************************************************************************/
+PUBLIC void vLI_StartSegmentTransition(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue,
+                                       uint32 u32TimeMs, uint32 u32RateHz)
+{
+	tsLI_Segment *psSegment;
+	const uint32 *pu32Frac = sLI_Vars.sChannels.au32Frac;
+	uint32 au32Rgb[3];
+	uint32 u32Points;
+
+	if (u8Segment >= LI_SEGMENTS)
+	{
+		return;
+	}
+	psSegment = &asLI_Segment[u8Segment];
+
+	/* Segments fade in RGB, from the colour the light shows */
+	if (psSegment->bOwned == FALSE)
+	{
+		bool_t bRgb = (sLI_Vars.u8ColourSpace == E_LI_COLOUR_RGB);
+
+		vLI_GetRGB(au32Rgb);
+		vLI_SetLane(psSegment->sChannels.au32Value, 0, au32Rgb[0]);
+		vLI_SetLane(psSegment->sChannels.au32Value, 1, au32Rgb[1]);
+		vLI_SetLane(psSegment->sChannels.au32Value, 2, au32Rgb[2]);
+		vLI_SetLane(psSegment->sChannels.au32Frac,  0, bRgb ? LI_LANE(pu32Frac, LI_LANE_RED)   : 0);
+		vLI_SetLane(psSegment->sChannels.au32Frac,  1, bRgb ? LI_LANE(pu32Frac, LI_LANE_GREEN) : 0);
+		vLI_SetLane(psSegment->sChannels.au32Frac,  2, bRgb ? LI_LANE(pu32Frac, LI_LANE_BLUE)  : 0);
+		psSegment->bOwned = TRUE;
+	}
+
+	u32RateHz = MAX(1, MIN(u32RateHz, LI_TICK_RATE_HZ));
+	u32Points = MAX(1, (u32TimeMs * u32RateHz) / 1000);
+
+	vLI_InitLane(&psSegment->sChannels, 0, u32Red   << SCALE, u32Points, FALSE);
+	vLI_InitLane(&psSegment->sChannels, 1, u32Green << SCALE, u32Points, FALSE);
+	vLI_InitLane(&psSegment->sChannels, 2, u32Blue  << SCALE, u32Points, FALSE);
+	psSegment->u32Points        = u32Points;
+	psSegment->u32PointsAdded   = 0;
+	psSegment->u32TickCount     = 0;
+	psSegment->u32TicksPerPoint = LI_TICK_RATE_HZ / u32RateHz;
+}
+#endif
+
+/****************************************************************************
+ * NAME: vLI_SetColourSpace
+ *
+ * DESCRIPTION:
+ * Selects the space colour transitions are interpolated in. A colour
+ * transition under way stops where it is, and the next cluster update or
+ * transition carries on from there.
+ ****************************************************************************/
+PUBLIC void vLI_SetColourSpace(teLI_ColourSpace eColourSpace)
+{
+#ifdef LI_RGB
+	tsLI_Packed *psPacked = &sLI_Vars.sChannels;
+	uint32 au32Colour[3];
+	uint8  u8Lane;
+
+	if ((eColourSpace >= E_LI_COLOUR_NUM) || (eColourSpace == sLI_Vars.u8ColourSpace))
+	{
+		return;
+	}
+
+	vLI_GetRGB(au32Colour);
+	sLI_Vars.au16Rgb[0] = au32Colour[0];
+	sLI_Vars.au16Rgb[1] = au32Colour[1];
+	sLI_Vars.au16Rgb[2] = au32Colour[2];
+	sLI_Vars.u8ColourSpace = eColourSpace;
+	if (eColourSpace == E_LI_COLOUR_HSV)
+	{
+		vLI_RGBToHSV(au32Colour);
+	}
+
+	for (u8Lane = LI_LANE_RED; u8Lane <= LI_LANE_BLUE; u8Lane++)
+	{
+		vLI_SetLane(psPacked->au32Value,    u8Lane, au32Colour[u8Lane - LI_LANE_RED]);
+		vLI_SetLane(psPacked->au32Target,   u8Lane, au32Colour[u8Lane - LI_LANE_RED]);
+		vLI_SetLane(psPacked->au32Frac,     u8Lane, 0);
+		vLI_SetLane(psPacked->au32Step,     u8Lane, 0);
+		vLI_SetLane(psPacked->au32StepFrac, u8Lane, 0);
+	}
+	sLI_Vars.u8Active &= ~LI_COLOUR_LANES;
+	vLI_NextEvent();
+#endif
+}
+
+/****************************************************************************
+ * NAME: vLI_Stop
+ *
+ * DESCRIPTION:
+ * Stops every channel where it is
+ ****************************************************************************/
 PUBLIC void vLI_Stop(void)
 {
-    sLI_Vars.u32PointsAdded = INTPOINTS;
+	memset(sLI_Vars.sChannels.au32Step,     0, sizeof(sLI_Vars.sChannels.au32Step));
+	memset(sLI_Vars.sChannels.au32StepFrac, 0, sizeof(sLI_Vars.sChannels.au32StepFrac));
+	sLI_Vars.u8Active = 0;
+}
+
+/****************************************************************************
+ * NAME: vLI_StopChannels
+ *
+ * DESCRIPTION:
+ * Stops the channels in u8Channels where they are, ending any transition
+ * of their own, so the next cluster update takes them on from there
+ ****************************************************************************/
+PUBLIC void vLI_StopChannels(uint8 u8Channels)
+{
+	tsLI_Packed *psPacked = &sLI_Vars.sChannels;
+	uint8 u8Lane;
+
+	for (u8Lane = 0; u8Lane < LI_LANES; u8Lane++)
+	{
+		if (u8Channels & au8LI_LaneChannel[u8Lane])
+		{
+			vLI_SetLane(psPacked->au32Step,     u8Lane, 0);
+			vLI_SetLane(psPacked->au32StepFrac, u8Lane, 0);
+			vLI_SetLane(psPacked->au32Target,   u8Lane, LI_LANE(psPacked->au32Value, u8Lane));
+			sLI_Vars.asTimeline[u8Lane].bDirect = FALSE;
+			sLI_Vars.u8Active &= ~(1 << u8Lane);
+		}
+	}
+	vLI_NextEvent();
+}
+
+/****************************************************************************
+ * NAME: bLI_TransitionActive
+ *
+ * DESCRIPTION:
+ * Whether any of u8Channels is still in a transition started by
+ * vLI_StartTransition
+ ****************************************************************************/
+PUBLIC bool_t bLI_TransitionActive(uint8 u8Channels)
+{
+	uint8 u8Lane;
+
+	for (u8Lane = 0; u8Lane < LI_LANES; u8Lane++)
+	{
+		if ((u8Channels & au8LI_LaneChannel[u8Lane]) &&
+			(sLI_Vars.u8Active & (1 << u8Lane)) &&
+			sLI_Vars.asTimeline[u8Lane].bDirect)
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/****************************************************************************
+ * NAME: bLI_Busy
+ *
+ * DESCRIPTION:
+ * Whether vLI_CreatePoints still has points to output, for the light or
+ * any segment, so the tick can't be put off
+ ****************************************************************************/
+PUBLIC bool_t bLI_Busy(void)
+{
+#ifdef LI_SEGMENTS
+	uint8 u8Segment;
+
+	for (u8Segment = 0; u8Segment < LI_SEGMENTS; u8Segment++)
+	{
+		if (asLI_Segment[u8Segment].u32PointsAdded < asLI_Segment[u8Segment].u32Points)
+		{
+			return TRUE;
+		}
+	}
+#endif
+	return (sLI_Vars.u8Active != 0);
 }
 
 /****************************************************************************
  * NAME: vLI_CreatePoints
  *
  * DESCRIPTION:
- * Provides multiple LI points in time/value pairs between
- * successive  ZCL updates.  This provides smooth 100Hz updates
- * on colour and level transitions
+ * Called with the LI ticks (LI_TICK_RATE_HZ) gone by since it was last
+ * called, one unless Tick_Task was held up; outputs the latest point while
+ * any channel is moving. Every channel of the light is stepped together by
+ * a few adds on the packed words, and each lands exactly on its target
+ * however long its transition is. Channels are only looked at one by one
+ * on the ticks one of them ends or turns a piece of its curve, or while
+ * one runs at less than LI_TICK_RATE_HZ. Points a late tick passed over
+ * are stepped through but not output, so the transition still ends on the
+ * tick it was timed for.
  ****************************************************************************/
-PUBLIC void vLI_CreatePoints(void)
+PUBLIC void vLI_CreatePoints(uint32 u32Ticks)
 {
-    if (sLI_Vars.u32PointsAdded < INTPOINTS)
-    {
-    	sLI_Vars.u32PointsAdded++;
-        sLI_Vars.sLevel.u32Current   += sLI_Vars.sLevel.i32Delta;
-        sLI_Vars.sRed.u32Current     += sLI_Vars.sRed.i32Delta;
-        sLI_Vars.sGreen.u32Current   += sLI_Vars.sGreen.i32Delta;
-        sLI_Vars.sBlue.u32Current    += sLI_Vars.sBlue.i32Delta;
-        sLI_Vars.sColTemp.u32Current += sLI_Vars.sColTemp.i32Delta;
-        vLI_UpdateDriver();
-    }
+	bool_t bUpdated = FALSE;
+	uint32 u32Tick;
+
+	for (u32Tick = 0; (u32Tick < u32Ticks) && sLI_Vars.u8Active; u32Tick++)
+	{
+		if (sLI_Vars.u8Slow == 0)
+		{
+			vLI_StepPacked(&sLI_Vars.sChannels);
+			bUpdated = TRUE;
+		}
+		else if (bLI_StepDueLanes())
+		{
+			bUpdated = TRUE;
+		}
+		if (++sLI_Vars.u32Tick == sLI_Vars.u32NextEvent)
+		{
+			vLI_ServiceLanes();
+		}
+	}
+	if (bUpdated)
+	{
+		vLI_UpdateDriver();
+	}
+
+#ifdef LI_SEGMENTS
+	vLI_CreateSegmentPoints(u32Ticks, bUpdated);
+#endif
 }
 
 /****************************************************************************
@@ -163,13 +584,23 @@ PUBLIC void vLI_CreatePoints(void)
  ****************************************************************************/
 PUBLIC void vLI_UpdateDriver(void)
 {
-	 vBULB_SetColour(sLI_Vars.sRed.u32Current   >> SCALE,
-			         sLI_Vars.sGreen.u32Current >> SCALE,
-			         sLI_Vars.sBlue.u32Current  >> SCALE);
+	const uint32 *pu32Value = sLI_Vars.sChannels.au32Value;
 
-	 vBULB_SetLevel(sLI_Vars.sLevel.u32Current  >> SCALE);
+#if (defined LI_RGB)
+	uint32 au32Rgb[3];
 
-	 vBULB_SetColourTemperature(sLI_Vars.sColTemp.u32Current >> SCALE);
+	vLI_GetRGB(au32Rgb);
+	 vBULB_Set12BitState(LI_TO_12BIT(LI_LANE(pu32Value, LI_LANE_LEVEL)),
+			             LI_TO_12BIT(au32Rgb[0]),
+			             LI_TO_12BIT(au32Rgb[1]),
+			             LI_TO_12BIT(au32Rgb[2]),
+			             0);
+#elif (defined LI_COLTEMP)
+	 vBULB_Set12BitState(LI_TO_12BIT(LI_LANE(pu32Value, LI_LANE_LEVEL)), 0, 0, 0,
+			             LI_LANE(pu32Value, LI_LANE_COLTEMP));
+#else
+	 vBULB_Set12BitLevel(LI_TO_12BIT(LI_LANE(pu32Value, LI_LANE_LEVEL)));
+#endif
 }
 
 /****************************************************************************/
@@ -177,26 +608,640 @@ PUBLIC void vLI_UpdateDriver(void)
 /****************************************************************************/
 
 /****************************************************************************
- * NAME:	vLI_InitVar
+ * NAME:	vLI_Begin
+ *
+ * DESCRIPTION:
+ *			Starts a transition of u32Points points, one every
+ *			u32TicksPerPoint ticks, for each channel in u8Channels. One
+ *			from the cluster (bDirect FALSE) leaves alone a channel in a
+ *			direct transition, or one already heading for the same
+ *			target. A new colour for the whole light ends any segment
+ *			colours. In HSV the colour lanes move as one, from a hue
+ *			that does not show while there is no saturation.
+ ****************************************************************************/
+PRIVATE void vLI_Begin(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp,
+                       uint8 u8Channels, uint32 u32Points, uint32 u32TicksPerPoint, teLI_Curve eCurve, bool_t bDirect)
+{
+	tsLI_Packed *psPacked = &sLI_Vars.sChannels;
+	tsLI_Timeline *psTimeline;
+	uint32 au32Target[LI_LANES];
+	uint8  u8Lane;
+	uint8  u8Bit;
+#ifdef LI_RGB
+	bool_t bHsv = (sLI_Vars.u8ColourSpace == E_LI_COLOUR_HSV);
+	bool_t bColourMoved = FALSE;
+#endif
+#ifdef LI_SEGMENTS
+	uint8 u8Segment;
+
+	if ((u8Channels & LI_CHANNEL_COLOUR) &&
+		((u32Red   << SCALE) != sLI_Vars.au16Rgb[0] ||
+		 (u32Green << SCALE) != sLI_Vars.au16Rgb[1] ||
+		 (u32Blue  << SCALE) != sLI_Vars.au16Rgb[2]))
+	{
+		for (u8Segment = 0; u8Segment < LI_SEGMENTS; u8Segment++)
+		{
+			asLI_Segment[u8Segment].u32PointsAdded = asLI_Segment[u8Segment].u32Points;
+			asLI_Segment[u8Segment].bOwned = FALSE;
+		}
+	}
+#endif
+
+	au32Target[LI_LANE_LEVEL]   = MIN(u32Level << SCALE, LI_LANE_MASK);
+#ifdef LI_RGB
+	au32Target[LI_LANE_RED]     = MIN(u32Red   << SCALE, LI_LANE_MASK);
+	au32Target[LI_LANE_GREEN]   = MIN(u32Green << SCALE, LI_LANE_MASK);
+	au32Target[LI_LANE_BLUE]    = MIN(u32Blue  << SCALE, LI_LANE_MASK);
+#endif
+#ifdef LI_COLTEMP
+	au32Target[LI_LANE_COLTEMP] = MIN(u32ColTemp,        LI_LANE_MASK);
+#endif
+#ifdef LI_RGB
+	if (bHsv && (u8Channels & LI_CHANNEL_COLOUR))
+	{
+		u8Channels |= LI_CHANNEL_COLOUR;
+		vLI_RGBToHSV(&au32Target[LI_LANE_RED]);
+		if (au32Target[LI_LANE_SAT] == 0)
+		{
+			au32Target[LI_LANE_HUE] = LI_LANE(psPacked->au32Value, LI_LANE_HUE);
+		}
+		else if (LI_LANE(psPacked->au32Value, LI_LANE_SAT) == 0)
+		{
+			vLI_SetLane(psPacked->au32Value, LI_LANE_HUE, au32Target[LI_LANE_HUE]);
+			vLI_SetLane(psPacked->au32Frac,  LI_LANE_HUE, 0);
+		}
+	}
+#endif
+
+	/* Nothing moving, so ticks can be counted from here again */
+	if (sLI_Vars.u8Active == 0)
+	{
+		sLI_Vars.u32Tick = 0;
+	}
+
+	if ((eCurve >= E_LI_CURVE_NUM) || (u32Points < LI_CURVE_PIECES))
+	{
+		eCurve = E_LI_CURVE_LINEAR;
+	}
+
+	for (u8Lane = 0, psTimeline = sLI_Vars.asTimeline; u8Lane < LI_LANES; u8Lane++, psTimeline++)
+	{
+		u8Bit = 1 << u8Lane;
+		if ((u8Channels & au8LI_LaneChannel[u8Lane]) == 0)
+		{
+			continue;
+		}
+		if (bDirect == FALSE)
+		{
+			if ((sLI_Vars.u8Active & u8Bit) ?
+				(psTimeline->bDirect || (au32Target[u8Lane] == LI_LANE(psPacked->au32Target, u8Lane))) :
+				(au32Target[u8Lane] == LI_LANE(psPacked->au32Value, u8Lane)))
+			{
+				continue;
+			}
+		}
+
+		psTimeline->u16Start = LI_LANE(psPacked->au32Value, u8Lane);
+#ifdef LI_RGB
+		vLI_InitLane(psPacked, u8Lane, au32Target[u8Lane], u32Points, bLI_Wraps(u8Lane));
+		if (u8Bit & LI_COLOUR_LANES)
+		{
+			bColourMoved = TRUE;
+			if (bHsv == FALSE)
+			{
+				sLI_Vars.au16Rgb[u8Lane - LI_LANE_RED] = au32Target[u8Lane];
+			}
+		}
+#else
+		vLI_InitLane(psPacked, u8Lane, au32Target[u8Lane], u32Points, FALSE);
+#endif
+		psTimeline->u32Begin        = sLI_Vars.u32Tick;
+		psTimeline->u32End          = sLI_Vars.u32Tick + u32Points * u32TicksPerPoint;
+		psTimeline->u32PieceEnd     = psTimeline->u32End;
+		psTimeline->u8Curve         = eCurve;
+		psTimeline->u8TicksPerPoint = u32TicksPerPoint;
+		psTimeline->u8TickCount     = 0;
+		psTimeline->bDirect         = bDirect;
+		sLI_Vars.u8Active      |= u8Bit;
+
+		if (eCurve != E_LI_CURVE_LINEAR)
+		{
+			psTimeline->u8Piece = 0;
+			vLI_StartPiece(u8Lane);
+		}
+	}
+
+#ifdef LI_RGB
+	if (bHsv && bColourMoved)
+	{
+		sLI_Vars.au16Rgb[0] = MIN(u32Red   << SCALE, LI_LANE_MASK);
+		sLI_Vars.au16Rgb[1] = MIN(u32Green << SCALE, LI_LANE_MASK);
+		sLI_Vars.au16Rgb[2] = MIN(u32Blue  << SCALE, LI_LANE_MASK);
+	}
+#endif
+	vLI_NextEvent();
+}
+
+/****************************************************************************
+ * NAME:	pu16LI_Curve
+ *
+ * DESCRIPTION:
+ *			The progress of eCurve at each piece boundary, summed on first
+ *			use from its piece weights, forward differenced from
+ *			asLI_CurveDiffs
+ ****************************************************************************/
+PRIVATE const uint16 *pu16LI_Curve(teLI_Curve eCurve)
+{
+	const tsLI_CurveDiffs *psDiffs = &asLI_CurveDiffs[eCurve];
+	uint16 *pu16Curve = au16LI_Curve[eCurve];
+	int32 i32Weight;
+	int32 i32Diff1;
+	uint8 u8Piece;
+
+	if (pu16Curve[LI_CURVE_PIECES] == 0)
+	{
+		i32Weight = psDiffs->i16Weight;
+		i32Diff1  = psDiffs->i16Diff1;
+		for (u8Piece = 0; u8Piece < LI_CURVE_PIECES; u8Piece++)
+		{
+			pu16Curve[u8Piece + 1] = pu16Curve[u8Piece] + i32Weight;
+			i32Weight += i32Diff1;
+			if (psDiffs->u8Growth)
+			{
+				i32Weight += i32Weight >> psDiffs->u8Growth;
+			}
+			i32Diff1  += psDiffs->i16Diff2;
+		}
+	}
+	return pu16Curve;
+}
+
+/****************************************************************************
+ * NAME:	vLI_StartPiece
+ *
+ * DESCRIPTION:
+ *			Aims a channel at its curve's value for the end of its next
+ *			piece, from wherever the last piece left it so rounding does not
+ *			build up. Pieces end on one of the channel's points, and the
+ *			last on the target itself. The exponential curve is rising
+ *			in perceived brightness, so a falling channel takes it
+ *			reversed.
+ ****************************************************************************/
+PRIVATE void vLI_StartPiece(uint8 u8Lane)
+{
+	tsLI_Packed *psPacked = &sLI_Vars.sChannels;
+	tsLI_Timeline *psTimeline = &sLI_Vars.asTimeline[u8Lane];
+	const uint16 *pu16Curve = pu16LI_Curve((teLI_Curve)psTimeline->u8Curve);
+	uint32 u32Total = pu16Curve[LI_CURVE_PIECES];
+	uint32 u32Start = psTimeline->u16Start;
+	uint32 u32Target = LI_LANE(psPacked->au32Target, u8Lane);
+	uint32 u32Ticks = psTimeline->u8TicksPerPoint;
+	uint32 u32Points = (psTimeline->u32End - psTimeline->u32Begin) / u32Ticks;
+	uint32 u32Aim;
+	uint8  u8End;
+	bool_t bWrap = FALSE;
+
+	u8End = ++psTimeline->u8Piece;
+	psTimeline->u32PieceEnd = psTimeline->u32Begin + u32Ticks * ((u8End * u32Points) / LI_CURVE_PIECES);
+
+#ifdef LI_RGB
+	/* Hue turns the short way, so may go past 256.0 or below 0 */
+	bWrap = bLI_Wraps(u8Lane);
+	if (bWrap && (((u32Target - u32Start) & LI_LANE_MASK) < (LI_HUE_TURN / 2)))
+	{
+		u32Target = u32Start + ((u32Target - u32Start) & LI_LANE_MASK);
+	}
+	else if (bWrap)
+	{
+		u32Start += LI_HUE_TURN;
+		u32Target = u32Start - ((u32Start - u32Target) & LI_LANE_MASK);
+	}
+#endif
+
+	if (u32Target >= u32Start)
+	{
+		u32Aim = u32Start + ((u32Target - u32Start) * pu16Curve[u8End]) / u32Total;
+	}
+	else if (psTimeline->u8Curve == E_LI_CURVE_EXPONENTIAL)
+	{
+		u32Aim = u32Target + ((u32Start - u32Target) * pu16Curve[LI_CURVE_PIECES - u8End]) / u32Total;
+	}
+	else
+	{
+		u32Aim = u32Start - ((u32Start - u32Target) * pu16Curve[u8End]) / u32Total;
+	}
+	vLI_AimLane(psPacked, u8Lane, u32Aim & (bWrap ? LI_LANE_MASK : 0xFFFFFFFF),
+	            (psTimeline->u32PieceEnd - sLI_Vars.u32Tick) / u32Ticks, bWrap);
+}
+
+/****************************************************************************
+ * NAME:	vLI_ServiceLanes
+ *
+ * DESCRIPTION:
+ *			Lands the channels whose transition ends on this tick and
+ *			starts the next piece of those whose curve turns on it
+ ****************************************************************************/
+PRIVATE void vLI_ServiceLanes(void)
+{
+	tsLI_Timeline *psTimeline;
+	uint8 u8Lane;
+
+	for (u8Lane = 0, psTimeline = sLI_Vars.asTimeline; u8Lane < LI_LANES; u8Lane++, psTimeline++)
+	{
+		if ((sLI_Vars.u8Active & (1 << u8Lane)) && (psTimeline->u32PieceEnd == sLI_Vars.u32Tick))
+		{
+			if (psTimeline->u32End == sLI_Vars.u32Tick)
+			{
+				vLI_LandLane(&sLI_Vars.sChannels, u8Lane);
+				sLI_Vars.u8Active &= ~(1 << u8Lane);
+			}
+			else
+			{
+				vLI_StartPiece(u8Lane);
+			}
+		}
+	}
+	vLI_NextEvent();
+}
+
+/****************************************************************************
+ * NAME:	vLI_NextEvent
  *
  * DESCRIPTION:
- *	 		Initialises a single LI variable to the output(s) from
- *	        ZCL cluster, converts to big integer and calculates the adjustment
- *	        needed on each of the successive LI points
+ *			Finds the first tick a moving channel ends or turns on, and
+ *			the moving channels that do not output a point every tick
  ****************************************************************************/
-PRIVATE void vLI_InitVar(tsLI_Params *psLI_Params, uint32 u32NewTarget)
+PRIVATE void vLI_NextEvent(void)
 {
-	psLI_Params->u32Target = u32NewTarget << SCALE;
+	uint8 u8Lane;
 
-	if (psLI_Params->u32Target < psLI_Params->u32Current)
+	sLI_Vars.u32NextEvent = 0xFFFFFFFF;
+	sLI_Vars.u8Slow = 0;
+	for (u8Lane = 0; u8Lane < LI_LANES; u8Lane++)
 	{
-		psLI_Params->i32Delta = -(u32divu10(psLI_Params->u32Current - psLI_Params->u32Target));
+		if (sLI_Vars.u8Active & (1 << u8Lane))
+		{
+			sLI_Vars.u32NextEvent = MIN(sLI_Vars.u32NextEvent, sLI_Vars.asTimeline[u8Lane].u32PieceEnd);
+			if (sLI_Vars.asTimeline[u8Lane].u8TicksPerPoint > 1)
+			{
+				sLI_Vars.u8Slow |= (1 << u8Lane);
+			}
+		}
+	}
+}
+
+#ifdef LI_RGB
+/****************************************************************************
+ * NAME:	bLI_Wraps
+ *
+ * DESCRIPTION:
+ *			Whether a lane of the light is the hue, which wraps round
+ ****************************************************************************/
+PRIVATE bool_t bLI_Wraps(uint8 u8Lane)
+{
+	return (sLI_Vars.u8ColourSpace == E_LI_COLOUR_HSV) && (u8Lane == LI_LANE_HUE);
+}
+
+/****************************************************************************
+ * NAME:	vLI_GetRGB
+ *
+ * DESCRIPTION:
+ *			The colour the light shows, in 8.7 RGB. In HSV the lanes are
+ *			converted once per point; a colour that has arrived is given
+ *			exactly as it was asked for, not as it came back from HSV.
+ ****************************************************************************/
+PRIVATE void vLI_GetRGB(uint32 *pu32Rgb)
+{
+	const tsLI_Packed *psPacked = &sLI_Vars.sChannels;
+	uint8 u8Lane;
+
+	if (sLI_Vars.u8ColourSpace == E_LI_COLOUR_RGB)
+	{
+		for (u8Lane = LI_LANE_RED; u8Lane <= LI_LANE_BLUE; u8Lane++)
+		{
+			pu32Rgb[u8Lane - LI_LANE_RED] = LI_LANE(psPacked->au32Value, u8Lane);
+		}
+	}
+	else if ((LI_LANE(psPacked->au32Value, LI_LANE_HUE) == LI_LANE(psPacked->au32Target, LI_LANE_HUE)) &&
+	         (LI_LANE(psPacked->au32Value, LI_LANE_SAT) == LI_LANE(psPacked->au32Target, LI_LANE_SAT)) &&
+	         (LI_LANE(psPacked->au32Value, LI_LANE_VAL) == LI_LANE(psPacked->au32Target, LI_LANE_VAL)))
+	{
+		pu32Rgb[0] = sLI_Vars.au16Rgb[0];
+		pu32Rgb[1] = sLI_Vars.au16Rgb[1];
+		pu32Rgb[2] = sLI_Vars.au16Rgb[2];
 	}
 	else
 	{
-		psLI_Params->i32Delta = u32divu10(psLI_Params->u32Target - psLI_Params->u32Current);;
+		vLI_HSVToRGB(LI_LANE(psPacked->au32Value, LI_LANE_HUE),
+		             LI_LANE(psPacked->au32Value, LI_LANE_SAT),
+		             LI_LANE(psPacked->au32Value, LI_LANE_VAL),
+		             pu32Rgb);
 	}
-	psLI_Params->u32Current += psLI_Params->i32Delta;
+}
+
+/****************************************************************************
+ * NAME:	vLI_RGBToHSV
+ *
+ * DESCRIPTION:
+ *			Converts an 8.7 RGB colour to hue, saturation and value in
+ *			place. The hue is LI_HUE_TURN to a turn, saturation 255.0 when
+ *			full. Only done when a transition starts, so it may divide.
+ ****************************************************************************/
+PRIVATE void vLI_RGBToHSV(uint32 *pu32Colour)
+{
+	int32 i32Red   = pu32Colour[0];
+	int32 i32Green = pu32Colour[1];
+	int32 i32Blue  = pu32Colour[2];
+	int32 i32Max   = MAX(i32Red, MAX(i32Green, i32Blue));
+	int32 i32Delta = i32Max - MIN(i32Red, MIN(i32Green, i32Blue));
+	int32 i32Hue;
+
+	if (i32Delta == 0)
+	{
+		i32Hue = 0;
+	}
+	else if (i32Max == i32Red)
+	{
+		i32Hue = ((i32Green - i32Blue) * LI_HUE_TURN) / (6 * i32Delta);
+	}
+	else if (i32Max == i32Green)
+	{
+		i32Hue = (LI_HUE_TURN / 3) + ((i32Blue - i32Red) * LI_HUE_TURN) / (6 * i32Delta);
+	}
+	else
+	{
+		i32Hue = (2 * LI_HUE_TURN / 3) + ((i32Red - i32Green) * LI_HUE_TURN) / (6 * i32Delta);
+	}
+
+	pu32Colour[0] = (uint32)i32Hue & LI_LANE_MASK;
+	pu32Colour[1] = (i32Max == 0) ? 0 : (uint32)((i32Delta * (255 << SCALE)) / i32Max);
+	pu32Colour[2] = i32Max;
+}
+
+/****************************************************************************
+ * NAME:	vLI_HSVToRGB
+ *
+ * DESCRIPTION:
+ *			Converts a point of an HSV transition back to 8.7 RGB for the
+ *			driver, with shifts and multiplies only as it runs every point
+ ****************************************************************************/
+PRIVATE void vLI_HSVToRGB(uint32 u32Hue, uint32 u32Sat, uint32 u32Val, uint32 *pu32Rgb)
+{
+	uint32 u32Sat15  = u32Sat + (u32Sat >> 8);		/* 255.0 to nearly 1 << 15 */
+	uint32 u32Hue6   = u32Hue * 6;
+	uint32 u32Part   = u32Hue6 & LI_LANE_MASK;
+	uint32 u32P      = u32Val - ((u32Val * u32Sat15) >> 15);
+	uint32 u32Q      = u32Val - ((u32Val * ((u32Sat15 * u32Part) >> 15)) >> 15);
+	uint32 u32T      = u32Val - ((u32Val * ((u32Sat15 * (LI_HUE_TURN - u32Part)) >> 15)) >> 15);
+
+	switch (u32Hue6 >> 15)
+	{
+	case 0:  pu32Rgb[0] = u32Val; pu32Rgb[1] = u32T;   pu32Rgb[2] = u32P;   break;
+	case 1:  pu32Rgb[0] = u32Q;   pu32Rgb[1] = u32Val; pu32Rgb[2] = u32P;   break;
+	case 2:  pu32Rgb[0] = u32P;   pu32Rgb[1] = u32Val; pu32Rgb[2] = u32T;   break;
+	case 3:  pu32Rgb[0] = u32P;   pu32Rgb[1] = u32Q;   pu32Rgb[2] = u32Val; break;
+	case 4:  pu32Rgb[0] = u32T;   pu32Rgb[1] = u32P;   pu32Rgb[2] = u32Val; break;
+	default: pu32Rgb[0] = u32Val; pu32Rgb[1] = u32P;   pu32Rgb[2] = u32Q;   break;
+	}
+}
+#endif
+
+#ifdef LI_SEGMENTS
+/****************************************************************************
+ * NAME:	vLI_CreateSegmentPoints
+ *
+ * DESCRIPTION:
+ *			Steps the segments with their own colour as vLI_CreatePoints
+ *			does the whole light, and restores them over the whole light's
+ *			colour whenever that has just been output
+ ****************************************************************************/
+PRIVATE void vLI_CreateSegmentPoints(uint32 u32Ticks, bool_t bUpdated)
+{
+	tsLI_Segment *psSegment;
+	uint32 u32Tick;
+	uint8  u8Segment;
+
+	for (u8Segment = 0, psSegment = asLI_Segment; u8Segment < LI_SEGMENTS; u8Segment++, psSegment++)
+	{
+		bool_t bStep = FALSE;
+
+		for (u32Tick = 0; (u32Tick < u32Ticks) && (psSegment->u32PointsAdded < psSegment->u32Points); u32Tick++)
+		{
+			if (++psSegment->u32TickCount >= psSegment->u32TicksPerPoint)
+			{
+				psSegment->u32TickCount = 0;
+				if (++psSegment->u32PointsAdded < psSegment->u32Points)
+				{
+					vLI_StepPacked(&psSegment->sChannels);
+				}
+				else
+				{
+					vLI_LandPacked(&psSegment->sChannels);
+				}
+				bStep = TRUE;
+			}
+		}
+		if (bStep || (bUpdated && psSegment->bOwned))
+		{
+			vBULB_SetSegmentColour(u8Segment,
+								   LI_LANE(psSegment->sChannels.au32Value, 0) >> SCALE,
+								   LI_LANE(psSegment->sChannels.au32Value, 1) >> SCALE,
+								   LI_LANE(psSegment->sChannels.au32Value, 2) >> SCALE);
+		}
+	}
+}
+#endif
+
+/****************************************************************************
+ * NAME:	vLI_InitLane
+ *
+ * DESCRIPTION:
+ *	 		Initialises a single packed channel to a new target reached
+ *	 		over u32Points
+ ****************************************************************************/
+PRIVATE void vLI_InitLane(tsLI_Packed *psPacked, uint8 u8Lane, uint32 u32NewTarget, uint32 u32Points, bool_t bWrap)
+{
+	u32NewTarget = MIN(u32NewTarget, LI_LANE_MASK);
+	vLI_AimLane(psPacked, u8Lane, u32NewTarget, u32Points, bWrap);
+	vLI_SetLane(psPacked->au32Target, u8Lane, u32NewTarget);
+}
+
+/****************************************************************************
+ * NAME:	vLI_AimLane
+ *
+ * DESCRIPTION:
+ *	 		Sets the step of a single packed channel, splitting the span
+ *	        from its current value and fraction to u32Aim over u32Points
+ *	        into a 31 bit two's complement step. The step is rounded
+ *	        towards zero so no point passes the aim before the last. A
+ *	        lane that wraps, the hue, takes the shorter way round.
+ ****************************************************************************/
+PRIVATE void vLI_AimLane(tsLI_Packed *psPacked, uint8 u8Lane, uint32 u32Aim, uint32 u32Points, bool_t bWrap)
+{
+	uint32 u32Current;
+	uint32 u32Target;
+	uint32 u32Step;
+	bool_t bDown;
+
+	u32Current   = (LI_LANE(psPacked->au32Value, u8Lane) << LI_FRAC_BITS) | LI_LANE(psPacked->au32Frac, u8Lane);
+	u32Target    = u32Aim << LI_FRAC_BITS;
+	if (bWrap)
+	{
+		u32Step  = (u32Target - u32Current) & ((LI_HUE_TURN << LI_FRAC_BITS) - 1);
+		bDown    = (u32Step >= (LI_HUE_TURN << (LI_FRAC_BITS - 1)));
+		u32Step  = (bDown) ? ((LI_HUE_TURN << LI_FRAC_BITS) - u32Step) : u32Step;
+	}
+	else
+	{
+		bDown    = (u32Target < u32Current);
+		u32Step  = (bDown) ? (u32Current - u32Target) : (u32Target - u32Current);
+	}
+
+	/* Cluster driven transitions are always INTPOINTS long, keep those cheap */
+	if (u32Points == INTPOINTS)
+	{
+		u32Step = u32divu10(u32Step);
+	}
+	else
+	{
+		u32Step = u32Step / u32Points;
+	}
+	if (bDown)
+	{
+		u32Step = 0 - u32Step;
+	}
+
+	vLI_SetLane(psPacked->au32Step,     u8Lane, u32Step >> LI_FRAC_BITS);
+	vLI_SetLane(psPacked->au32StepFrac, u8Lane, u32Step & LI_LANE_MASK);
+}
+
+/****************************************************************************
+ * NAME:	vLI_SetLane
+ *
+ * DESCRIPTION:
+ *	 		Writes the low 16 bits of u32Value to one lane of a packed word.
+ *	 		Only a whole step lane uses the top bit, as its sign.
+ ****************************************************************************/
+PRIVATE void vLI_SetLane(uint32 *pu32Words, uint8 u8Lane, uint32 u32Value)
+{
+	uint32 u32Shift = LI_LANE_SHIFT(u8Lane);
+	uint32 u32Mask  = 0xFFFFUL << u32Shift;
+
+	pu32Words[u8Lane >> 1] = (pu32Words[u8Lane >> 1] & ~u32Mask) | ((u32Value << u32Shift) & u32Mask);
+}
+
+/****************************************************************************
+ * NAME:	vLI_StepPacked
+ *
+ * DESCRIPTION:
+ *	 		Advances every channel of a packed set by one point. Fractions
+ *	 		are added with their carries collected from the guard bits,
+ *	 		then the whole steps and carries are added below the guard
+ *	 		bits and the guard bits corrected, so no carry or borrow can
+ *	 		cross into the next lane
+ ****************************************************************************/
+PRIVATE void vLI_StepPacked(tsLI_Packed *psPacked)
+{
+	uint32 u32Frac;
+	uint32 u32Value;
+	uint32 u32Step;
+	uint8  i;
+
+	for (i = 0; i < LI_WORDS; i++)
+	{
+		u32Frac  = psPacked->au32Frac[i] + psPacked->au32StepFrac[i];
+		u32Value = psPacked->au32Value[i];
+		u32Step  = psPacked->au32Step[i];
+
+		psPacked->au32Frac[i]  = u32Frac & ~LI_GUARD;
+		psPacked->au32Value[i] = ((u32Value & ~LI_GUARD) + (u32Step & ~LI_GUARD) +
+		                          ((u32Frac & LI_GUARD) >> (LI_LANE_BITS - 1))) ^
+		                         ((u32Value ^ u32Step) & LI_GUARD);
+	}
+}
+
+/****************************************************************************
+ * NAME:	bLI_StepDueLanes
+ *
+ * DESCRIPTION:
+ *	 		Advances, one by one, the moving channels whose next point
+ *	 		falls on this tick, for when some run at less than
+ *	 		LI_TICK_RATE_HZ. Returns whether any of them moved.
+ ****************************************************************************/
+PRIVATE bool_t bLI_StepDueLanes(void)
+{
+	tsLI_Timeline *psTimeline;
+	bool_t bStepped = FALSE;
+	uint8 u8Lane;
+
+	for (u8Lane = 0, psTimeline = sLI_Vars.asTimeline; u8Lane < LI_LANES; u8Lane++, psTimeline++)
+	{
+		if ((sLI_Vars.u8Active & (1 << u8Lane)) &&
+			(++psTimeline->u8TickCount >= psTimeline->u8TicksPerPoint))
+		{
+			psTimeline->u8TickCount = 0;
+			vLI_StepLane(&sLI_Vars.sChannels, u8Lane);
+			bStepped = TRUE;
+		}
+	}
+	return bStepped;
+}
+
+/****************************************************************************
+ * NAME:	vLI_StepLane
+ *
+ * DESCRIPTION:
+ *	 		Advances one channel of a packed set by one point, as
+ *	 		vLI_StepPacked does them all. Value and fraction are added as
+ *	 		one 30 bit number, so the hue wraps as it does in the lane.
+ ****************************************************************************/
+PRIVATE void vLI_StepLane(tsLI_Packed *psPacked, uint8 u8Lane)
+{
+	uint32 u32Shift = LI_LANE_SHIFT(u8Lane);
+	uint32 u32Value;
+	uint32 u32Step;
+
+	u32Value = (LI_LANE(psPacked->au32Value, u8Lane) << LI_FRAC_BITS) | LI_LANE(psPacked->au32Frac, u8Lane);
+	u32Step  = (((psPacked->au32Step[u8Lane >> 1] >> u32Shift) & 0xFFFF) << LI_FRAC_BITS) |
+	           LI_LANE(psPacked->au32StepFrac, u8Lane);
+	u32Value = (u32Value + u32Step) & ((1UL << (2 * LI_FRAC_BITS)) - 1);
+
+	vLI_SetLane(psPacked->au32Value, u8Lane, u32Value >> LI_FRAC_BITS);
+	vLI_SetLane(psPacked->au32Frac,  u8Lane, u32Value & LI_LANE_MASK);
+}
+
+#ifdef LI_SEGMENTS
+/****************************************************************************
+ * NAME:	vLI_LandPacked
+ *
+ * DESCRIPTION:
+ *	 		Makes the last point of a packed set its targets exactly
+ ****************************************************************************/
+PRIVATE void vLI_LandPacked(tsLI_Packed *psPacked)
+{
+	uint8 i;
+
+	for (i = 0; i < LI_WORDS; i++)
+	{
+		psPacked->au32Value[i] = psPacked->au32Target[i];
+		psPacked->au32Frac[i]  = 0;
+	}
+}
+#endif
+
+/****************************************************************************
+ * NAME:	vLI_LandLane
+ *
+ * DESCRIPTION:
+ *	 		Makes one channel of a packed set its target exactly and
+ *	 		stops it there
+ ****************************************************************************/
+PRIVATE void vLI_LandLane(tsLI_Packed *psPacked, uint8 u8Lane)
+{
+	vLI_SetLane(psPacked->au32Value,    u8Lane, LI_LANE(psPacked->au32Target, u8Lane));
+	vLI_SetLane(psPacked->au32Frac,     u8Lane, 0);
+	vLI_SetLane(psPacked->au32Step,     u8Lane, 0);
+	vLI_SetLane(psPacked->au32StepFrac, u8Lane, 0);
 }
 
 /****************************************************************************
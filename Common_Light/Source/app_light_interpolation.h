@@ -36,22 +36,88 @@
 #ifndef APP_LI_H
 #define APP_LI_H
 
+#include "zcl_options.h"
+
 /****************************************************************************/
 /***        Macro Definitions                                             ***/
 /****************************************************************************/
 
+/* Rate at which vLI_CreatePoints is called from Tick_Task */
+#define LI_TICK_RATE_HZ     (100)
+
+/*
+ * Channels interpolated for this light, from its cluster options. Only the
+ * channels a build drives are carried and stepped on every tick; the level
+ * is always interpolated. RGB drivers take no colour temperature, tunable
+ * white bulbs no colour.
+ */
+#if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic) && !(defined JN516X_TUNABLEWHITE)
+#define LI_RGB
+#elif (defined CLD_COLOUR_CONTROL)
+#define LI_COLTEMP
+#endif
+
+#if (defined LI_RGB) && (defined JN516X_SPI_RGB)
+/* Segments of an addressable strip with their own colour transitions */
+#define LI_SEGMENTS         (4)
+#endif
+
+/* Channels a transition moves; each runs its own, so they can overlap */
+#define LI_CHANNEL_LEVEL    (1 << 0)
+#define LI_CHANNEL_RED      (1 << 1)
+#define LI_CHANNEL_GREEN    (1 << 2)
+#define LI_CHANNEL_BLUE     (1 << 3)
+#define LI_CHANNEL_COLTEMP  (1 << 4)
+#define LI_CHANNEL_COLOUR   (LI_CHANNEL_RED | LI_CHANNEL_GREEN | LI_CHANNEL_BLUE)
+#define LI_CHANNEL_ALL      (LI_CHANNEL_LEVEL | LI_CHANNEL_COLOUR | LI_CHANNEL_COLTEMP)
+
 /****************************************************************************/
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 
+/* Shape of a transition started by vLI_StartTransition */
+typedef enum
+{
+    E_LI_CURVE_LINEAR,
+    E_LI_CURVE_EASE_IN,         /* quadratic, slow start                  */
+    E_LI_CURVE_EASE_OUT,        /* quadratic, slow finish                 */
+    E_LI_CURVE_S_CURVE,         /* smoothstep, slow start and finish      */
+    E_LI_CURVE_EXPONENTIAL,     /* even steps in perceived brightness     */
+    E_LI_CURVE_NUM
+} teLI_Curve;
+
+/*
+ * Space colour transitions are interpolated in. RGB moves each primary in a
+ * straight line, so between saturated colours it passes through dimmer,
+ * greyer mixes; HSV keeps brightness and saturation and turns the hue the
+ * short way round the colour wheel.
+ */
+typedef enum
+{
+    E_LI_COLOUR_RGB,
+    E_LI_COLOUR_HSV,
+    E_LI_COLOUR_NUM
+} teLI_ColourSpace;
+
 /****************************************************************************/
 /***        Exported Functions                                            ***/
 /****************************************************************************/
 
 PUBLIC void vLI_SetCurrentValues(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp);
+PUBLIC void vLI_GetCurrentValues(uint32 *pu32Level, uint32 *pu32Red, uint32 *pu32Green, uint32 *pu32Blue, uint32 *pu32ColTemp);
 PUBLIC void vLI_Start(uint32 u32Level,uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp);
+PUBLIC void vLI_StartTransition(uint32 u32Level, uint32 u32Red, uint32 u32Green, uint32 u32Blue, uint32 u32ColTemp,
+                                uint8 u8Channels, uint32 u32TimeMs, uint32 u32RateHz, teLI_Curve eCurve);
+#ifdef LI_SEGMENTS
+PUBLIC void vLI_StartSegmentTransition(uint8 u8Segment, uint32 u32Red, uint32 u32Green, uint32 u32Blue,
+                                       uint32 u32TimeMs, uint32 u32RateHz);
+#endif
+PUBLIC void vLI_SetColourSpace(teLI_ColourSpace eColourSpace);
 PUBLIC void vLI_Stop(void);
-PUBLIC void vLI_CreatePoints(void);
+PUBLIC void vLI_StopChannels(uint8 u8Channels);
+PUBLIC bool_t bLI_TransitionActive(uint8 u8Channels);
+PUBLIC bool_t bLI_Busy(void);
+PUBLIC void vLI_CreatePoints(uint32 u32Ticks);
 PUBLIC void vLI_UpdateDriver(void);
 
 /****************************************************************************/
@@ -0,0 +1,369 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_strip.c
+ *
+ * DESCRIPTION:        ZLL Demo: Strip Profile Cluster - Implementation
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include <string.h>
+#include "zcl.h"
+#include "zcl_options.h"
+#include "dbg.h"
+#include "app_light_strip.h"
+#include "app_zcl_light_task.h"
+#include "DriverBulb_Shim.h"
+
+#ifdef DEBUG_LIGHT_TASK
+#define TRACE_LIGHT_TASK  TRUE
+#else
+#define TRACE_LIGHT_TASK FALSE
+#endif
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define APP_LIGHT_STRIP_ATTR(u16Id, eType, member) \
+    {(u16Id), (E_ZCL_AF_RD|E_ZCL_AF_WR|E_ZCL_AF_MS), (eType), (uint32)(&((tsAPP_LightStrip*)(0))->member), 0}
+
+#define APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, eAttr, eType, member) \
+    APP_LIGHT_STRIP_ATTR(APP_LIGHT_STRIP_ATTR_SEGMENT_BASE + (u8Segment) * APP_LIGHT_STRIP_ATTR_SEGMENT_STEP + (eAttr), \
+                         eType, asSegment[u8Segment].member)
+
+#define APP_LIGHT_STRIP_SEGMENT_ATTRS(u8Segment) \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_FIRST,           E_ZCL_UINT16, u16First), \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_COUNT,           E_ZCL_UINT16, u16Count), \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_RED,             E_ZCL_UINT8,  u8Red), \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_GREEN,           E_ZCL_UINT8,  u8Green), \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_BLUE,            E_ZCL_UINT8,  u8Blue), \
+    APP_LIGHT_STRIP_SEGMENT_ATTR(u8Segment, E_APP_LIGHT_STRIP_SEGMENT_TRANSITION_TIME, E_ZCL_UINT16, u16TransitionTime)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE void vApp_LightStrip_Read(void);
+PRIVATE void vApp_LightStrip_Get(tsStripProfile *psProfile);
+PRIVATE void vApp_LightStrip_Split(uint16 u16NumLeds);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* One line of segment attributes for each of the LI_SEGMENTS segments */
+PRIVATE const tsZCL_AttributeDefinition asApp_LightStripAttributeDefinitions[] = {
+    APP_LIGHT_STRIP_ATTR(E_APP_LIGHT_STRIP_ATTR_ID_NUM_LEDS, E_ZCL_UINT16, u16NumLeds),
+    APP_LIGHT_STRIP_ATTR(E_APP_LIGHT_STRIP_ATTR_ID_CHIP,     E_ZCL_ENUM8,  u8Chip),
+    APP_LIGHT_STRIP_ATTR(E_APP_LIGHT_STRIP_ATTR_ID_ORDER,    E_ZCL_ENUM8,  u8Order),
+    APP_LIGHT_STRIP_ATTR(E_APP_LIGHT_STRIP_ATTR_ID_SPI_HZ,   E_ZCL_UINT32, u32SpiHz),
+    APP_LIGHT_STRIP_SEGMENT_ATTRS(0),
+    APP_LIGHT_STRIP_SEGMENT_ATTRS(1),
+    APP_LIGHT_STRIP_SEGMENT_ATTRS(2),
+    APP_LIGHT_STRIP_SEGMENT_ATTRS(3),
+};
+
+PRIVATE tsZCL_ClusterDefinition sApp_LightStripCluster = {
+    APP_CLUSTER_ID_LIGHT_STRIP,
+    TRUE,
+    E_ZCL_SECURITY_NETWORK,
+    (sizeof(asApp_LightStripAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition)),
+    (tsZCL_AttributeDefinition*)asApp_LightStripAttributeDefinitions,
+    NULL
+};
+
+PRIVATE uint8 au8App_LightStripAttributeControlBits[(sizeof(asApp_LightStripAttributeDefinitions) / sizeof(tsZCL_AttributeDefinition))];
+
+PRIVATE tsAPP_LightStrip sLightStrip;
+
+/* The map the driver has, and the colours last faded to */
+PRIVATE tsAPP_LightStripSegment asSegmentInUse[LI_SEGMENTS];
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightStrip_Register
+ *
+ * DESCRIPTION:
+ * Adds the strip profile cluster to an endpoint that is already
+ * registered, with eApp_AppendCluster, and fills its attributes from
+ * the profile the driver loaded from PDM, with the segments on equal
+ * parts of the strip.
+ *
+ * RETURNS:
+ * teZCL_Status
+ *
+ ****************************************************************************/
+PUBLIC teZCL_Status eApp_LightStrip_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                             tsZCL_ClusterInstance *psClusterInstances,
+                                             uint16 u16MaxClusters)
+{
+    teZCL_Status eZCL_Status;
+
+    eZCL_Status = eApp_AppendCluster(psEndPointDefinition, psClusterInstances, u16MaxClusters,
+                                     &sApp_LightStripCluster, &sLightStrip, au8App_LightStripAttributeControlBits);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    vApp_LightStrip_Read();
+    vApp_LightStrip_Split(sLightStrip.u16NumLeds);
+    memcpy(sLightStrip.asSegment, asSegmentInUse, sizeof(asSegmentInUse));
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: eApp_LightStrip_CheckAttribute
+ *
+ * DESCRIPTION:
+ * Called as each attribute of a write to the cluster is checked, before it
+ * is stored, with the value written. The profile in the attributes, with
+ * this value in place, is checked with the bulb driver but not handed
+ * over; one it would refuse, or a segment first LED or count past the
+ * end of the strip, fails the write of that attribute with INVALID_VALUE.
+ * Segment colours and transition times take any value.
+ *
+ * RETURNS:
+ * teZCL_CommandStatus
+ *
+ ****************************************************************************/
+PUBLIC teZCL_CommandStatus eApp_LightStrip_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData)
+{
+    tsStripProfile sProfile;
+    uint16 u16Offset;
+
+    if (u16AttributeId >= APP_LIGHT_STRIP_ATTR_SEGMENT_BASE)
+    {
+        u16Offset = (u16AttributeId - APP_LIGHT_STRIP_ATTR_SEGMENT_BASE) % APP_LIGHT_STRIP_ATTR_SEGMENT_STEP;
+        if (((u16Offset == E_APP_LIGHT_STRIP_SEGMENT_FIRST) || (u16Offset == E_APP_LIGHT_STRIP_SEGMENT_COUNT)) &&
+            (*(uint16 *)pvAttributeData > sLightStrip.u16NumLeds))
+        {
+            DBG_vPrintf(TRACE_LIGHT_TASK, "\nStrip attribute %04x refused", u16AttributeId);
+            return E_ZCL_CMDS_INVALID_VALUE;
+        }
+        return E_ZCL_CMDS_SUCCESS;
+    }
+
+    vApp_LightStrip_Get(&sProfile);
+
+    switch (u16AttributeId)
+    {
+    case E_APP_LIGHT_STRIP_ATTR_ID_NUM_LEDS:
+        sProfile.u16NumLeds = *(uint16 *)pvAttributeData;
+        break;
+
+    case E_APP_LIGHT_STRIP_ATTR_ID_CHIP:
+        sProfile.u8Chip = *(uint8 *)pvAttributeData;
+        break;
+
+    case E_APP_LIGHT_STRIP_ATTR_ID_ORDER:
+        sProfile.u8Order = *(uint8 *)pvAttributeData;
+        break;
+
+    case E_APP_LIGHT_STRIP_ATTR_ID_SPI_HZ:
+        sProfile.u32SpiHz = *(uint32 *)pvAttributeData;
+        break;
+
+    default:
+        return E_ZCL_CMDS_SUCCESS;
+    }
+
+    if (!bBULB_CheckStripProfile(&sProfile))
+    {
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nStrip attribute %04x refused", u16AttributeId);
+        return E_ZCL_CMDS_INVALID_VALUE;
+    }
+    return E_ZCL_CMDS_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightStrip_Update
+ *
+ * DESCRIPTION:
+ * Hands the profile to the bulb driver once a write to the cluster has
+ * completed, if it changed; the driver keeps it in PDM, and splits the
+ * strip into equal segments again. Otherwise a segment map that changed
+ * is handed over, and a segment whose colour changed fades to it. The
+ * attributes are then filled from what the driver has in use.
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_LightStrip_Update(void)
+{
+    tsStripProfile sProfile;
+    tsStripProfile sInUse;
+    tsAPP_LightStripSegment *psSegment;
+    tsAPP_LightStripSegment *psInUse;
+    bool_t bSplit = FALSE;
+    uint8 i;
+
+    vApp_LightStrip_Get(&sProfile);
+    vBULB_GetStripProfile(&sInUse);
+    if (memcmp(&sProfile, &sInUse, sizeof(sProfile)) != 0)
+    {
+        bSplit = bBULB_SetStripProfile(&sProfile);
+        if (!bSplit)
+        {
+            DBG_vPrintf(TRACE_LIGHT_TASK, "\nStrip profile refused");
+        }
+    }
+    vApp_LightStrip_Read();
+
+    if (bSplit)
+    {
+        vApp_LightStrip_Split(sLightStrip.u16NumLeds);
+    }
+
+    for (i = 0; i < LI_SEGMENTS; i++)
+    {
+        psSegment = &sLightStrip.asSegment[i];
+        psInUse = &asSegmentInUse[i];
+
+        if (!bSplit &&
+            ((psSegment->u16First != psInUse->u16First) || (psSegment->u16Count != psInUse->u16Count)))
+        {
+            if (bBULB_MapSegment(i, psSegment->u16First, psSegment->u16Count))
+            {
+                psInUse->u16First = psSegment->u16First;
+                psInUse->u16Count = psSegment->u16Count;
+            }
+            else
+            {
+                DBG_vPrintf(TRACE_LIGHT_TASK, "\nSegment %d map refused", i);
+            }
+        }
+
+        if ((psSegment->u8Red != psInUse->u8Red) || (psSegment->u8Green != psInUse->u8Green) ||
+            (psSegment->u8Blue != psInUse->u8Blue))
+        {
+            vLI_StartSegmentTransition(i, psSegment->u8Red, psSegment->u8Green, psSegment->u8Blue,
+                                       (uint32)psSegment->u16TransitionTime * 100, LI_TICK_RATE_HZ);
+        }
+        psInUse->u8Red = psSegment->u8Red;
+        psInUse->u8Green = psSegment->u8Green;
+        psInUse->u8Blue = psSegment->u8Blue;
+        psInUse->u16TransitionTime = psSegment->u16TransitionTime;
+    }
+
+    memcpy(sLightStrip.asSegment, asSegmentInUse, sizeof(asSegmentInUse));
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightStrip_Read
+ *
+ * DESCRIPTION:
+ * Fills the attributes from the profile in use by the driver
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_LightStrip_Read(void)
+{
+    tsStripProfile sProfile;
+
+    vBULB_GetStripProfile(&sProfile);
+    sLightStrip.u16NumLeds = sProfile.u16NumLeds;
+    sLightStrip.u8Chip     = sProfile.u8Chip;
+    sLightStrip.u8Order    = sProfile.u8Order;
+    sLightStrip.u32SpiHz   = sProfile.u32SpiHz;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightStrip_Get
+ *
+ * DESCRIPTION:
+ * The profile held in the attributes, in the driver's form
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_LightStrip_Get(tsStripProfile *psProfile)
+{
+    memset(psProfile, 0, sizeof(tsStripProfile));
+    psProfile->u16NumLeds = sLightStrip.u16NumLeds;
+    psProfile->u8Chip     = sLightStrip.u8Chip;
+    psProfile->u8Order    = sLightStrip.u8Order;
+    psProfile->u32SpiHz   = sLightStrip.u32SpiHz;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_LightStrip_Split
+ *
+ * DESCRIPTION:
+ * Maps the segments in use onto equal parts of a strip u16NumLeds long,
+ * as the driver does when it takes a profile
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_LightStrip_Split(uint16 u16NumLeds)
+{
+    uint8 i;
+
+    for (i = 0; i < LI_SEGMENTS; i++)
+    {
+        asSegmentInUse[i].u16First = (i * u16NumLeds) / LI_SEGMENTS;
+        asSegmentInUse[i].u16Count = ((i + 1) * u16NumLeds) / LI_SEGMENTS - asSegmentInUse[i].u16First;
+    }
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
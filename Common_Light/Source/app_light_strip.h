@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_strip.h
+ *
+ * DESCRIPTION:        ZLL Demo: Strip Profile Cluster -Interface
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_STRIP_H
+#define APP_LIGHT_STRIP_H
+
+#include <jendefs.h>
+#include "zcl.h"
+#include "app_light_interpolation.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * Manufacturer specific cluster on the light endpoint of a strip build
+ * (JN516X_SPI_RGB) holding the fixture profile of the addressable strip:
+ * its length, chip, colour byte order and SPI clock. Each attribute
+ * written is checked with the bulb driver, and one it would refuse fails
+ * with INVALID_VALUE; once the write completes the profile is handed
+ * over and the driver keeps it in PDM.
+ *
+ * Each of the LI_SEGMENTS segments has the first LED and count it is
+ * mapped to, and a colour it fades to over its transition time, in tenths
+ * of a second, when a new one is written. A map that runs off the end of
+ * the strip is refused once the write completes and reads back as before.
+ * A change of profile maps the segments onto equal parts of the strip
+ * again. Neither the map nor the colours are kept in PDM.
+ */
+#define APP_CLUSTER_ID_LIGHT_STRIP          (0xFC04)
+
+/* Attribute of segment 0; each segment has 0x10 IDs from here */
+#define APP_LIGHT_STRIP_ATTR_SEGMENT_BASE   (0x0100)
+#define APP_LIGHT_STRIP_ATTR_SEGMENT_STEP   (0x0010)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef enum
+{
+    E_APP_LIGHT_STRIP_ATTR_ID_NUM_LEDS = 0x0000,
+    E_APP_LIGHT_STRIP_ATTR_ID_CHIP,                     /* teStripChip */
+    E_APP_LIGHT_STRIP_ATTR_ID_ORDER,                    /* teStripOrder */
+    E_APP_LIGHT_STRIP_ATTR_ID_SPI_HZ,
+} teAPP_LightStripAttributeID;
+
+/* Per segment, added to its base */
+typedef enum
+{
+    E_APP_LIGHT_STRIP_SEGMENT_FIRST,
+    E_APP_LIGHT_STRIP_SEGMENT_COUNT,
+    E_APP_LIGHT_STRIP_SEGMENT_RED,
+    E_APP_LIGHT_STRIP_SEGMENT_GREEN,
+    E_APP_LIGHT_STRIP_SEGMENT_BLUE,
+    E_APP_LIGHT_STRIP_SEGMENT_TRANSITION_TIME,            /* 1/10s */
+} teAPP_LightStripSegmentAttribute;
+
+typedef struct
+{
+    zuint16 u16First;
+    zuint16 u16Count;
+    zuint8  u8Red;
+    zuint8  u8Green;
+    zuint8  u8Blue;
+    zuint16 u16TransitionTime;
+} tsAPP_LightStripSegment;
+
+typedef struct
+{
+    zuint16 u16NumLeds;
+    zenum8  u8Chip;
+    zenum8  u8Order;
+    zuint32 u32SpiHz;
+    tsAPP_LightStripSegment asSegment[LI_SEGMENTS];
+} tsAPP_LightStrip;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC teZCL_Status eApp_LightStrip_Register(tsZCL_EndPointDefinition *psEndPointDefinition,
+                                             tsZCL_ClusterInstance *psClusterInstances,
+                                             uint16 u16MaxClusters);
+PUBLIC teZCL_CommandStatus eApp_LightStrip_CheckAttribute(uint16 u16AttributeId, void *pvAttributeData);
+PUBLIC void vApp_LightStrip_Update(void);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_STRIP_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
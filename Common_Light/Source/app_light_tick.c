@@ -0,0 +1,516 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_tick.c
+ *
+ * DESCRIPTION:        ZLL Demo: Tick Scheduling - Implementation
+ *
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <jendefs.h>
+#include <string.h>
+#include <AppHardwareApi.h>
+#include "os.h"
+#include "os_gen.h"
+#include "app_timer_driver.h"
+#include "app_light_tick.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Tick timer counts per tick, and ticks before the stages repeat */
+#define APP_TICK_PERIOD         APP_TIME_MS(APP_TICK_TIME_MS)
+#define APP_TICK_CYCLE          (1000 / APP_TICK_TIME_MS)
+#define APP_TICK_NUM_STAGES     (sizeof(asApp_TickStages) / sizeof(asApp_TickStages[0]))
+
+/* u32WokenAt with no wake since the last run */
+#define APP_TICK_NOT_WOKEN      (0xFFFFFFFF)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* A stage falls on the ticks where tick % u8Period == u8Phase, and a late
+ * run makes up to u8CatchUp of the times it fell due */
+typedef struct
+{
+    uint8   u8Stage;
+    uint8   u8Period;
+    uint8   u8Phase;
+    uint8   u8CatchUp;
+} tsAPP_TickStage;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE uint32 u32App_Tick_ToNext(const tsAPP_TickStage *psStage);
+PRIVATE void vApp_Tick_Record(tsAPP_TickTiming *psTiming, uint32 u32Counts);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* The ZCL timer event only runs once however late */
+PRIVATE const tsAPP_TickStage asApp_TickStages[] =
+{
+    { APP_TICK_STAGE_10MS,  1,              0,  APP_TICK_CATCH_UP_10MS  },
+    { APP_TICK_STAGE_100MS, 10,             0,  APP_TICK_CATCH_UP_100MS },
+    { APP_TICK_STAGE_1SEC,  APP_TICK_CYCLE, 0,  1 },
+};
+
+PRIVATE uint32 u32Tick;             /* tick of the last run, in the cycle    */
+PRIVATE uint32 u32TickAt;           /* tick timer count it fell due at       */
+PRIVATE uint32 u32Armed;            /* ticks on the timer is armed for       */
+PRIVATE uint8  u8ArmedStages;       /* stages it was armed for               */
+PRIVATE bool_t bWoken;              /* new work since the run began          */
+PRIVATE uint32 u32WokenAt;          /* ticks after the last run of the first
+                                     * wake since, APP_TICK_NOT_WOKEN if none */
+PRIVATE uint32 au32DueRuns[APP_TICK_NUM_STAGES]; /* runs due of each stage    */
+PRIVATE bool_t bIdleSleep;          /* armed for the 1Hz stages alone        */
+PRIVATE bool_t bLightDirty;         /* light changed since its outputs were
+                                     * last worked out                       */
+PRIVATE tsAPP_TickStats sTickStats;
+
+/* Lateness histogram bounds in us */
+PRIVATE const uint32 au32App_TickLateBounds[APP_TICK_LATE_BUCKETS] = APP_TICK_LATE_BOUNDS_US;
+PRIVATE uint32 u32LastRun;          /* tick timer count the last run began   */
+PRIVATE tsAPP_TickDiag sTickDiag;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_Start
+ *
+ * DESCRIPTION:
+ * Starts the tick timer for the first tick, on which the 100ms and 1
+ * second stages fall as they did with the old tick counters, and clears
+ * the statistics and timings
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_Start(void)
+{
+    u32Tick    = APP_TICK_CYCLE - 1;
+    u32TickAt  = u32AHI_TickTimerRead();
+    u32Armed   = 1;
+    u8ArmedStages = APP_TICK_STAGE_10MS | APP_TICK_STAGES_ALWAYS;
+    bWoken     = FALSE;
+    bIdleSleep = FALSE;
+    u32WokenAt = APP_TICK_NOT_WOKEN;
+    vApp_Tick_ResetDiag();
+    u32LastRun = u32TickAt;
+
+    OS_eStartSWTimer(APP_TickTimer, APP_TICK_PERIOD, NULL);
+}
+
+/****************************************************************************
+ *
+ * NAME: u8App_Tick_Due
+ *
+ * DESCRIPTION:
+ * Called first thing in Tick_Task. Works out from the tick timer how many
+ * ticks have gone by since the last run, which may be many after a sleep,
+ * and how late this run began after the tick it fell due on.
+ * A stage is due as many times as it fell on a tick since it was wanted:
+ * since the last run if the timer was armed for it, since the first wake
+ * if work arrived while the tick slept, otherwise only if it falls on this
+ * tick. A run held up past more ticks than the stage's catch up limit
+ * drops the rest
+ *
+ * RETURNS:
+ * APP_TICK_STAGE_ bits of the stages to run
+ *
+ ****************************************************************************/
+PUBLIC uint8 u8App_Tick_Due(void)
+{
+    const tsAPP_TickStage *psStage;
+    uint32 u32Now = u32AHI_TickTimerRead();
+    uint32 u32Elapsed;
+    uint32 u32From;
+    uint32 u32First;
+    uint32 u32Runs;
+    int32  i32Late;
+    uint8  u8Due = 0;
+    uint8  i;
+
+    u32Elapsed = (u32Now - u32TickAt + APP_TICK_PERIOD / 2) / APP_TICK_PERIOD;
+    u32Elapsed = MAX(1, u32Elapsed);
+
+    for (i = 0, psStage = asApp_TickStages; i < APP_TICK_NUM_STAGES; i++, psStage++)
+    {
+        /* The ticks after u32From count */
+        if (u8ArmedStages & psStage->u8Stage)
+        {
+            u32From = 0;
+        }
+        else
+        {
+            u32From = MIN(u32WokenAt, u32Elapsed - 1);
+        }
+        u32First = u32App_Tick_ToNext(psStage);
+        if (u32First <= u32From)
+        {
+            u32First += ((u32From - u32First) / psStage->u8Period + 1) * psStage->u8Period;
+        }
+
+        au32DueRuns[i] = 0;
+        if (u32Elapsed >= u32First)
+        {
+            u32Runs = (u32Elapsed - u32First) / psStage->u8Period + 1;
+            au32DueRuns[i] = MIN(u32Runs, psStage->u8CatchUp);
+            sTickDiag.u32MadeUp  += au32DueRuns[i] - 1;
+            sTickDiag.u32Dropped += u32Runs - au32DueRuns[i];
+            u8Due |= psStage->u8Stage;
+        }
+    }
+
+    u32TickAt += u32Elapsed * APP_TICK_PERIOD;
+    u32Tick    = (u32Tick + u32Elapsed) % APP_TICK_CYCLE;
+    u32Armed   = 0;
+    bWoken     = FALSE;
+    u32WokenAt = APP_TICK_NOT_WOKEN;
+
+    sTickStats.u32Ticks += u32Elapsed;
+    sTickStats.u32Wakes++;
+    if (bIdleSleep)
+    {
+        sTickStats.u32IdleWakes++;
+    }
+
+    /* A timer rounded short reads as a little early */
+    i32Late = MAX(0, (int32)(u32Now - u32TickAt));
+    vApp_Tick_Record(&sTickDiag.sLate, (uint32)i32Late);
+    for (i = 0; (i < APP_TICK_LATE_BUCKETS - 1) &&
+                ((uint32)i32Late / APP_TICK_COUNTS_PER_US >= au32App_TickLateBounds[i]); i++);
+    sTickDiag.au32LateHistogram[i]++;
+    vApp_Tick_Record(&sTickDiag.sInterval, u32Now - u32LastRun);
+    u32LastRun = u32Now;
+
+    return u8Due;
+}
+
+/****************************************************************************
+ *
+ * NAME: u32App_Tick_Runs
+ *
+ * DESCRIPTION:
+ * Times a stage fell due for this run, up to its catch up limit: 1 for a
+ * run on time, more for one that was held up, 0 if the stage is not due.
+ * The caller runs the stage that many times, or for LI points creates
+ * that many, so its work ends on the tick it was timed for
+ *
+ * RETURNS:
+ * uint32
+ *
+ ****************************************************************************/
+PUBLIC uint32 u32App_Tick_Runs(uint8 u8Stage)
+{
+    uint8 i;
+
+    for (i = 0; i < APP_TICK_NUM_STAGES; i++)
+    {
+        if (asApp_TickStages[i].u8Stage == u8Stage)
+        {
+            return au32DueRuns[i];
+        }
+    }
+    return 0;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_Sleep
+ *
+ * DESCRIPTION:
+ * Called last thing in Tick_Task with the stages its pending work needs,
+ * to which it adds the next tick if the outputs are still to be worked
+ * out after a change to the light. Arms the tick timer for the next tick any of them, or a 1Hz stage,
+ * falls on. The time is taken from the tick of this run rather than from
+ * now, so the grid does not drift however long the run took. Work that
+ * arrived during the run gets the next tick.
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_Sleep(uint8 u8Stages)
+{
+    uint32 u32Ticks = APP_TICK_CYCLE;
+    int32  i32Delay;
+    uint8  i;
+
+    if (bWoken)
+    {
+        u8Stages |= APP_TICK_STAGE_10MS;
+        bWoken = FALSE;
+    }
+    if (bLightDirty)
+    {
+        u8Stages |= APP_TICK_STAGE_10MS;
+    }
+    bIdleSleep = ((u8Stages & ~APP_TICK_STAGES_ALWAYS) == 0);
+    u8Stages  |= APP_TICK_STAGES_ALWAYS;
+
+    for (i = 0; i < APP_TICK_NUM_STAGES; i++)
+    {
+        if (u8Stages & asApp_TickStages[i].u8Stage)
+        {
+            u32Ticks = MIN(u32Ticks, u32App_Tick_ToNext(&asApp_TickStages[i]));
+        }
+    }
+    u32Armed      = u32Ticks;
+    u8ArmedStages = u8Stages;
+    sTickStats.u32LongestSleep = MAX(sTickStats.u32LongestSleep, u32Ticks);
+
+    /* Already past it if the run overran, so fire at once */
+    i32Delay = (int32)(u32TickAt + u32Ticks * APP_TICK_PERIOD - u32AHI_TickTimerRead());
+    OS_eStartSWTimer(APP_TickTimer, (uint32)MAX(1, i32Delay), NULL);
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_Wake
+ *
+ * DESCRIPTION:
+ * New work for Tick_Task, from a command or a timer other than the tick.
+ * If the tick timer is armed past the next tick it is brought forward to
+ * it; during a run, the run arms it for the next tick when it ends. The
+ * stages count the ticks from here if the next run is late
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_Wake(void)
+{
+    uint32 u32Now;
+    uint32 u32Ticks;
+
+    u32Now     = u32AHI_TickTimerRead();
+    u32Ticks   = (u32Now - u32TickAt) / APP_TICK_PERIOD + 1;
+    u32WokenAt = MIN(u32WokenAt, u32Ticks - 1);
+    bWoken     = TRUE;
+    if (u32Ticks < u32Armed)
+    {
+        u32Armed   = u32Ticks;
+        bIdleSleep = FALSE;
+        sTickStats.u32EarlyWakes++;
+        OS_eStartSWTimer(APP_TickTimer, u32TickAt + u32Ticks * APP_TICK_PERIOD - u32Now, NULL);
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_GetStats
+ *
+ * DESCRIPTION:
+ * Reads the wake statistics since the tick timer was started
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_GetStats(tsAPP_TickStats *psStats)
+{
+    *psStats = sTickStats;
+}
+
+/****************************************************************************
+ *
+ * NAME: u32App_Tick_Timed
+ *
+ * DESCRIPTION:
+ * Records the time a part of Tick_Task took since u32Start. Returns the
+ * tick timer count it ended at, so the parts of a run can be timed one
+ * after another with one read each
+ *
+ * RETURNS:
+ * uint32
+ *
+ ****************************************************************************/
+PUBLIC uint32 u32App_Tick_Timed(teAPP_TickTimed eTimed, uint32 u32Start)
+{
+    uint32 u32Now = u32AHI_TickTimerRead();
+
+    vApp_Tick_Record(&sTickDiag.asTimed[eTimed], u32Now - u32Start);
+    return u32Now;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_LightChanged
+ *
+ * DESCRIPTION:
+ * Marks the light's outputs to be worked out on the next tick, after a
+ * cluster update or a command that changed it. A change while one is
+ * already pending is left to that one and counted as coalesced
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_LightChanged(void)
+{
+    if (bLightDirty)
+    {
+        sTickDiag.u32Coalesced++;
+    }
+    bLightDirty = TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME: bApp_Tick_LightPending
+ *
+ * DESCRIPTION:
+ * Whether the light has changed since its outputs were last worked out
+ *
+ * RETURNS:
+ * bool_t
+ *
+ ****************************************************************************/
+PUBLIC bool_t bApp_Tick_LightPending(void)
+{
+    return bLightDirty;
+}
+
+/****************************************************************************
+ *
+ * NAME: bApp_Tick_CommitLight
+ *
+ * DESCRIPTION:
+ * Called from Tick_Task before it works out the outputs. Clears the
+ * pending change, so one arriving while they are worked out waits for
+ * the next tick
+ *
+ * RETURNS:
+ * TRUE if the light changed and its outputs are to be worked out
+ *
+ ****************************************************************************/
+PUBLIC bool_t bApp_Tick_CommitLight(void)
+{
+    bool_t bDirty = bLightDirty;
+
+    bLightDirty = FALSE;
+    return bDirty;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_GetDiag
+ *
+ * DESCRIPTION:
+ * Reads the lateness, interval and part timings since they were reset
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_GetDiag(tsAPP_TickDiag *psDiag)
+{
+    *psDiag = sTickDiag;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_ResetDiag
+ *
+ * DESCRIPTION:
+ * Clears the wake statistics and the timings
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vApp_Tick_ResetDiag(void)
+{
+    memset(&sTickStats, 0, sizeof(sTickStats));
+    memset(&sTickDiag, 0, sizeof(sTickDiag));
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME: u32App_Tick_ToNext
+ *
+ * DESCRIPTION:
+ * Ticks from the last run to the next tick the stage falls on, 1 to its
+ * period
+ *
+ * RETURNS:
+ * uint32
+ *
+ ****************************************************************************/
+PRIVATE uint32 u32App_Tick_ToNext(const tsAPP_TickStage *psStage)
+{
+    return ((psStage->u8Phase + psStage->u8Period - (u32Tick % psStage->u8Period) - 1) % psStage->u8Period) + 1;
+}
+
+/****************************************************************************
+ *
+ * NAME: vApp_Tick_Record
+ *
+ * DESCRIPTION:
+ * Adds one measurement to a timing
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vApp_Tick_Record(tsAPP_TickTiming *psTiming, uint32 u32Counts)
+{
+    if ((psTiming->u32Count == 0) || (u32Counts < psTiming->u32Min))
+    {
+        psTiming->u32Min = u32Counts;
+    }
+    psTiming->u32Max    = MAX(psTiming->u32Max, u32Counts);
+    psTiming->u64Total += u32Counts;
+    psTiming->u32Count++;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
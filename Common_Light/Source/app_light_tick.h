@@ -0,0 +1,148 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          app_light_tick.h
+ *
+ * DESCRIPTION:        ZLL Demo: Tick Scheduling - Interface
+ *
+ *
+ ****************************************************************************
+ *
+ * This software is owned by NXP B.V. and/or its supplier and is protected
+ * under applicable copyright laws. All rights are reserved. We grant You,
+ * and any third parties, a license to use this software solely and
+ * exclusively on NXP products [NXP Microcontrollers such as JN5168, JN5164,
+ * JN5161, JN5148, JN5142, JN5139].
+ * You, and any third parties must reproduce the copyright and warranty notice
+ * and any other legend of ownership on each copy or partial copy of the
+ * software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Copyright NXP B.V. 2014. All rights reserved
+ *
+ ***************************************************************************/
+
+#ifndef APP_LIGHT_TICK_H
+#define APP_LIGHT_TICK_H
+
+#include <jendefs.h>
+#include "zcl_options.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/*
+ * Tick_Task runs on a 10ms grid but only on the ticks its work needs. Each
+ * stage has a period and a phase in ticks; the tick timer is armed for the
+ * next tick a wanted stage falls on, so a static light wakes only for the
+ * 1Hz stages.
+ */
+#define APP_TICK_TIME_MS        (10)
+
+#define APP_TICK_STAGE_10MS     (1 << 0)    /* every tick: LI points, dither */
+#define APP_TICK_STAGE_100MS    (1 << 1)    /* eZLL_Update100mS              */
+#define APP_TICK_STAGE_1SEC     (1 << 2)    /* ZCL timer event, 1Hz          */
+
+/* Stages every tick timer arming takes account of, whatever is pending */
+#define APP_TICK_STAGES_ALWAYS  (APP_TICK_STAGE_1SEC)
+
+/*
+ * Ticks are counted on the grid, not by the runs, so a run held up by a
+ * long callback or a blocking SPI frame finds how many times each stage
+ * fell due while it waited (u32App_Tick_Runs). Up to a stage's catch up
+ * limit they are made up in that run; any more are dropped and counted.
+ */
+#define APP_TICK_CATCH_UP_10MS  (100)       /* a second of LI points         */
+#define APP_TICK_CATCH_UP_100MS (10)        /* a second of cluster updates   */
+
+/* Tick timer counts per microsecond, for the timings below */
+#define APP_TICK_COUNTS_PER_US  (16)
+
+/* Buckets of the lateness histogram, each below its bound in us */
+#define APP_TICK_LATE_BOUNDS_US { 50, 100, 250, 500, 1000, 2500, 5000, 0xFFFFFFFF }
+#define APP_TICK_LATE_BUCKETS   (8)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+/* How much of the time Tick_Task was left asleep. Every tick was a wake
+ * before, so u32Ticks - u32Wakes is the wakes saved */
+typedef struct
+{
+    uint32  u32Ticks;           /* 10ms ticks gone by                      */
+    uint32  u32Wakes;           /* Tick_Task runs                          */
+    uint32  u32IdleWakes;       /* runs for the 1Hz stages alone           */
+    uint32  u32EarlyWakes;      /* sleeps cut short by new work            */
+    uint32  u32LongestSleep;    /* longest the timer was armed for, ticks  */
+} tsAPP_TickStats;
+
+/* Parts of Tick_Task, and the OTA state machine, timed by the tick timer */
+typedef enum
+{
+    E_APP_TICK_TIMED_UPDATE_100MS,  /* eZLL_Update100mS, then the outputs   */
+    E_APP_TICK_TIMED_LI,            /* vLI_CreatePoints                     */
+    E_APP_TICK_TIMED_BULB,          /* vBULB_Tick                           */
+    E_APP_TICK_TIMED_OTA,           /* vRunAppOTAStateMachine, APP_OTA_Task */
+    E_APP_TICK_TIMED_ZCL_TIMER,     /* 1Hz bulb tick and ZCL timer event    */
+    E_APP_TICK_TIMED_NUM
+} teAPP_TickTimed;
+
+/* Spread of one measurement, in tick timer counts */
+typedef struct
+{
+    uint32  u32Count;
+    uint32  u32Min;
+    uint32  u32Max;
+    uint64  u64Total;
+} tsAPP_TickTiming;
+
+typedef struct
+{
+    tsAPP_TickTiming sLate;         /* run start after the tick it was due  */
+    tsAPP_TickTiming sInterval;     /* from one run start to the next       */
+    uint32  au32LateHistogram[APP_TICK_LATE_BUCKETS];
+    uint32  u32MadeUp;              /* stage runs made up by a late run     */
+    uint32  u32Dropped;             /* and those past its catch up limit    */
+    uint32  u32Coalesced;           /* cluster updates folded into another  */
+    tsAPP_TickTiming asTimed[E_APP_TICK_TIMED_NUM];
+} tsAPP_TickDiag;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+PUBLIC void vApp_Tick_Start(void);
+PUBLIC uint8 u8App_Tick_Due(void);
+PUBLIC uint32 u32App_Tick_Runs(uint8 u8Stage);
+PUBLIC void vApp_Tick_Sleep(uint8 u8Stages);
+PUBLIC void vApp_Tick_Wake(void);
+PUBLIC void vApp_Tick_GetStats(tsAPP_TickStats *psStats);
+PUBLIC uint32 u32App_Tick_Timed(teAPP_TickTimed eTimed, uint32 u32Start);
+PUBLIC void vApp_Tick_LightChanged(void);
+PUBLIC bool_t bApp_Tick_LightPending(void);
+PUBLIC bool_t bApp_Tick_CommitLight(void);
+PUBLIC void vApp_Tick_GetDiag(tsAPP_TickDiag *psDiag);
+PUBLIC void vApp_Tick_ResetDiag(void);
+
+/****************************************************************************/
+/***        External Variables                                            ***/
+/****************************************************************************/
+
+#endif /* APP_LIGHT_TICK_H */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -39,6 +39,7 @@
 
 #include <jendefs.h>
 #include <appapi.h>
+#include <AppHardwareApi.h>
 #include "os.h"
 #include "os_gen.h"
 #include "pdum_apl.h"
@@ -73,7 +74,15 @@
 
 #include "app_events.h"
 #include "app_light_interpolation.h"
-#include "DriverBulb.h"
+#include "app_light_curve.h"
+#include "app_light_calibration.h"
+#include "app_light_tick.h"
+#include "app_light_diagnostics.h"
+#include "app_scenes.h"
+#ifdef JN516X_SPI_RGB
+#include "app_light_strip.h"
+#endif
+#include "DriverBulb_Shim.h"
 
 #include <string.h>
 
@@ -106,7 +115,6 @@
 /***        Type Definitions                                              ***/
 /****************************************************************************/
 
-#define ZCL_TICK_TIME           APP_TIME_MS(100)
 
 
 /****************************************************************************/
@@ -115,6 +123,15 @@
 PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent);
 PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent);
 PRIVATE void APP_ZCL_cbZllCommissionCallback(tsZCL_CallBackEvent *psEvent);
+#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)
+PRIVATE void vHandleMoveToLevel(uint8 u8Level, uint16 u16TransitionTime, teLI_Curve eCurve);
+PRIVATE void vCancelLevelTransition(void);
+#if (defined CLD_SCENES) && (defined SCENES_SERVER)
+PRIVATE void vHandleSceneCommand(tsCLD_ScenesCallBackMessage *psCallBackMessage);
+#endif
+#endif
+PRIVATE void vCommitLightState(void);
+PRIVATE uint8 u8TickStagesPending(void);
 
 
 
@@ -130,6 +147,9 @@ PRIVATE void APP_ZCL_cbZllCommissionCallback(tsZCL_CallBackEvent *psEvent);
 
 PRIVATE tsZLL_CommissionEndpoint sCommissionEndpoint;
 
+/* A cluster changed an attribute since the last 100ms update */
+PRIVATE bool_t bClusterActive = FALSE;
+
 
 /****************************************************************************/
 /***        Exported Functions                                            ***/
@@ -160,7 +180,7 @@ PUBLIC void APP_ZCL_vInitialise(void)
     }
 
     /* Start the tick timer */
-    OS_eStartSWTimer(APP_TickTimer, ZCL_TICK_TIME, NULL);
+    vApp_Tick_Start();
 
     sDeviceTable.asDeviceRecords[0].u64IEEEAddr = *((uint64*)pvAppApiGetMacAddrLocation());
 
@@ -185,6 +205,7 @@ PUBLIC void APP_ZCL_vInitialise(void)
 
 #ifdef CLD_OTA
     vAppInitOTA();
+    OS_eStartSWTimer(APP_OtaTimer, APP_TIME_SEC(1), NULL);
 #endif
 
 }
@@ -204,63 +225,169 @@ PUBLIC void APP_ZCL_vInitialise(void)
 PUBLIC void APP_ZCL_vSetIdentifyTime(uint16 u16Time)
 {
     sLight.sIdentifyServerCluster.u16IdentifyTime = u16Time;
+    vApp_Tick_Wake();
 }
 
 /****************************************************************************
  *
- * NAME: Tick_Task
+ * NAME: eApp_AppendCluster
  *
  * DESCRIPTION:
- * Task kicked by the tick timer
+ * Adds a server cluster to an endpoint that is already registered, for
+ * the manufacturer specific clusters the device registration doesn't
+ * know. The endpoint's cluster instances are copied to psInstanceArray,
+ * which has room for u16Size, unless they are already there from an
+ * earlier cluster, and the new cluster follows them.
  *
  * RETURNS:
- * void
+ * teZCL_Status
  *
  ****************************************************************************/
-OS_TASK(Tick_Task)
+PUBLIC teZCL_Status eApp_AppendCluster(tsZCL_EndPointDefinition *psEndPoint,
+                                       tsZCL_ClusterInstance *psInstanceArray,
+                                       uint16 u16Size,
+                                       tsZCL_ClusterDefinition *psClusterDefinition,
+                                       void *pvEndPointSharedStruct,
+                                       uint8 *pu8AttributeControlBits)
 {
+    tsZCL_ClusterInstance *psClusterInstance;
 
-    static uint32 u32Tick10ms = 9;
-    static uint32 u32Tick1Sec = 99;
-
-    tsZCL_CallBackEvent sCallBackEvent;
-
-    OS_eContinueSWTimer(APP_TickTimer, /*TEN_HZ_TICK_TIME*/APP_TIME_MS(10), NULL);
-
-    u32Tick10ms++;
-    u32Tick1Sec++;
-
-    /* Wrap the Tick10ms counter and provide 100ms ticks to cluster */
-    if (u32Tick10ms > 9)
+    if ((psEndPoint == NULL) || (psInstanceArray == NULL))
     {
-        eZLL_Update100mS();
-        u32Tick10ms = 0;
+        return E_ZCL_ERR_PARAMETER_NULL;
     }
-#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)  /* add in nine 10ms interpolation points */
-    else
+    if (psEndPoint->u16NumberOfClusters >= u16Size)
     {
-        vLI_CreatePoints();
+        return E_ZCL_ERR_PARAMETER_RANGE;
     }
-#endif
 
-#ifdef CLD_OTA
-    if (u32Tick1Sec == 82)   /* offset this from the 1 second roll over */
+    if (psEndPoint->psClusterInstance != psInstanceArray)
     {
-        vRunAppOTAStateMachine();
+        memcpy(psInstanceArray, psEndPoint->psClusterInstance,
+               psEndPoint->u16NumberOfClusters * sizeof(tsZCL_ClusterInstance));
+    }
+
+    psClusterInstance = &psInstanceArray[psEndPoint->u16NumberOfClusters];
+    psClusterInstance->bIsServer                  = TRUE;
+    psClusterInstance->psClusterDefinition        = psClusterDefinition;
+    psClusterInstance->pvEndPointSharedStructPtr  = pvEndPointSharedStruct;
+    psClusterInstance->pu8AttributeControlBits    = pu8AttributeControlBits;
+    psClusterInstance->pvEndPointCustomStructPtr  = NULL;
+    psClusterInstance->pCustomcallCallBackFunction = NULL;
+
+    psEndPoint->psClusterInstance = psInstanceArray;
+    psEndPoint->u16NumberOfClusters++;
+
+    return E_ZCL_SUCCESS;
+}
+
+/****************************************************************************
+ *
+ * NAME: Tick_Task
+ *
+ * DESCRIPTION:
+ * Task kicked by the tick timer. Runs the stages due since it last ran and
+ * leaves the timer armed only for the ticks its pending work needs. A run
+ * held up past its tick makes up the cluster updates and LI points it
+ * missed, so transitions end when they were commanded to
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+OS_TASK(Tick_Task)
+{
+    tsZCL_CallBackEvent sCallBackEvent;
+    tsAPP_TickStats sTickStats;
+    uint32 u32Start;
+    uint32 u32Runs;
+    uint8 u8Stages;
+
+    u8Stages = u8App_Tick_Due();
+    u32Start = u32AHI_TickTimerRead();
+
+    /* Provide 100ms ticks to cluster, then the outputs once for all its updates */
+    if ((u8Stages & APP_TICK_STAGE_100MS) || bApp_Tick_LightPending())
+    {
+        if (u8Stages & APP_TICK_STAGE_100MS)
+        {
+            bClusterActive = FALSE;
+            for (u32Runs = u32App_Tick_Runs(APP_TICK_STAGE_100MS); u32Runs > 0; u32Runs--)
+            {
+                eZLL_Update100mS();
+            }
+        }
+        if (bApp_Tick_CommitLight())
+        {
+            vCommitLightState();
+        }
+        u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_UPDATE_100MS, u32Start);
     }
+#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)  /* 10ms interpolation points, after any cluster update */
+    vLI_CreatePoints(u32App_Tick_Runs(APP_TICK_STAGE_10MS));
+    u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_LI, u32Start);
 #endif
+    vBULB_Tick();
+    u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_BULB, u32Start);
 
-    /* Wrap the 1 second  counter and provide 1Hz ticks to cluster */
-    if(u32Tick1Sec > 99)
+    /* Provide 1Hz ticks to cluster */
+    if (u8Stages & APP_TICK_STAGE_1SEC)
     {
-        u32Tick1Sec = 0;
+        vBULB_Tick1Sec();
+        vApp_Tick_GetStats(&sTickStats);
+        DBG_vPrintf(TRACE_LIGHT_TASK, "\nHW writes/s %d", u32BULB_GetWritesPerSecond());
+        DBG_vPrintf(TRACE_LIGHT_TASK, " wakes %d/%d ticks", sTickStats.u32Wakes, sTickStats.u32Ticks);
         sCallBackEvent.pZPSevent = NULL;
         sCallBackEvent.eEventType = E_ZCL_CBET_TIMER;
         vZCL_EventHandler(&sCallBackEvent);
+        u32App_Tick_Timed(E_APP_TICK_TIMED_ZCL_TIMER, u32Start);
+        vApp_LightDiagnostics_Refresh();
     }
 
+    vApp_Tick_Sleep(u8TickStagesPending());
+}
+
+/****************************************************************************
+ *
+ * NAME: APP_OTA_Task
+ *
+ * DESCRIPTION:
+ * Lowest priority task running the OTA client off the light's rendering
+ * path. Takes the server discovery responses APP_ZPR_Light_Task hands on,
+ * and steps the OTA state machine once a second on its own timer, so image
+ * queries and the flash writes they lead to never hold up Tick_Task
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+OS_TASK(APP_OTA_Task)
+{
+#ifdef CLD_OTA
+    ZPS_tsAfEvent sStackEvent;
+    uint32 u32Start;
 
+    while (OS_eCollectMessage(APP_msgOtaEvents, &sStackEvent) == OS_E_OK)
+    {
+        if (ZPS_ZDP_MATCH_DESC_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId)
+        {
+            vHandleMatchDescriptor(&sStackEvent);
+        }
+        else if (ZPS_ZDP_IEEE_ADDR_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId)
+        {
+            vHandleIeeeAddressRsp(&sStackEvent);
+        }
+        PDUM_eAPduFreeAPduInstance(sStackEvent.uEvent.sApsDataIndEvent.hAPduInst);
+    }
 
+    if (OS_eGetSWTimerStatus(APP_OtaTimer) == OS_E_SWTIMER_EXPIRED)
+    {
+        OS_eContinueSWTimer(APP_OtaTimer, APP_TIME_SEC(1), NULL);
+        u32Start = u32AHI_TickTimerRead();
+        vRunAppOTAStateMachine();
+        u32App_Tick_Timed(E_APP_TICK_TIMED_OTA, u32Start);
+    }
+#endif
 }
 
 /****************************************************************************/
@@ -374,7 +501,7 @@ PRIVATE void APP_ZCL_cbGeneralCallback(tsZCL_CallBackEvent *psEvent)
  ****************************************************************************/
 PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
 {
-    #if (defined CLD_COLOUR_CONTROL)  && !(defined DR1221) && !(defined DR1221_Dimic)
+    #if (defined CLD_COLOUR_CONTROL)  && !(defined DR1221) && !(defined DR1221_Dimic) && !(defined JN516X_TUNABLEWHITE)
         uint8 u8Red, u8Green, u8Blue;
     #endif
     DBG_vPrintf(TRACE_ZCL, "\nEntering cbZCL_EndpointCallback");
@@ -444,7 +571,7 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
 
                 }
 
-                #if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic)
+                #if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic) && !(defined JN516X_TUNABLEWHITE)
                     vApp_eCLD_ColourControl_GetRGB(&u8Red, &u8Green, &u8Blue);
 #if TRACE_LIGHT_TASK
 
@@ -476,7 +603,7 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
                             u8Red,
                             u8Green,
                             u8Blue);
-                #elif (defined CLD_COLOUR_CONTROL) && ((defined DR1221) || (defined DR1221_Dimic))
+                #elif (defined CLD_COLOUR_CONTROL) && ((defined DR1221) || (defined DR1221_Dimic) || (defined JN516X_TUNABLEWHITE))
                     DBG_vPrintf(TRACE_LIGHT_TASK, "\nOOOn =%d :L=%d T=%dK",sLight.sOnOffServerCluster.bOnOff,
                     		                                             sLight.sLevelControlServerCluster.u8CurrentLevel,
                     		                                             (1000000 / sLight.sColourControlServerCluster.u16ColourTemperatureMired));
@@ -499,6 +626,34 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
                 #endif
             }
             break;
+#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)
+            case GENERAL_CLUSTER_ID_LEVEL_CONTROL:
+            {
+                tsCLD_LevelControlCallBackMessage *psCallBackMessage = (tsCLD_LevelControlCallBackMessage*)psEvent->uMessage.sClusterCustomMessage.pvCustomData;
+
+                if ((psCallBackMessage->u8CommandId == E_CLD_LEVELCONTROL_CMD_MOVE_TO_LEVEL) ||
+                    (psCallBackMessage->u8CommandId == E_CLD_LEVELCONTROL_CMD_MOVE_TO_LEVEL_WITH_ON_OFF))
+                {
+                    vHandleMoveToLevel(psCallBackMessage->uMessage.psMoveToLevelCommandPayload->u8Level,
+                                       psCallBackMessage->uMessage.psMoveToLevelCommandPayload->u16TransitionTime,
+                                       eApp_LightCurve_Get());
+                }
+                else
+                {
+                    /* Move, step and stop are followed by the cluster updates */
+                    vCancelLevelTransition();
+                }
+            }
+            break;
+#if (defined CLD_SCENES) && (defined SCENES_SERVER)
+            case GENERAL_CLUSTER_ID_SCENES:
+            {
+                tsCLD_ScenesCallBackMessage *psCallBackMessage = (tsCLD_ScenesCallBackMessage*)psEvent->uMessage.sClusterCustomMessage.pvCustomData;
+                vHandleSceneCommand(psCallBackMessage);
+            }
+            break;
+#endif
+#endif
             case GENERAL_CLUSTER_ID_IDENTIFY:
             {
                 tsCLD_IdentifyCallBackMessage *psCallBackMessage = (tsCLD_IdentifyCallBackMessage*)psEvent->uMessage.sClusterCustomMessage.pvCustomData;
@@ -524,6 +679,32 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
         }
         break;
 
+    case E_ZCL_CBET_CHECK_ATTRIBUTE_RANGE:
+        /* The driver is asked whether it would take the calibration, PWM
+         * profile or strip profile as written; they are handed over once
+         * the write completes */
+        if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_CALIBRATION)
+        {
+            psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus =
+                eApp_LightCalibration_CheckAttribute(psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
+                                                     psEvent->uMessage.sIndividualAttributeResponse.pvAttributeData);
+        }
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_CURVE)
+        {
+            psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus =
+                eApp_LightCurve_CheckAttribute(psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
+                                               psEvent->uMessage.sIndividualAttributeResponse.pvAttributeData);
+        }
+#ifdef JN516X_SPI_RGB
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_STRIP)
+        {
+            psEvent->uMessage.sIndividualAttributeResponse.eAttributeStatus =
+                eApp_LightStrip_CheckAttribute(psEvent->uMessage.sIndividualAttributeResponse.u16AttributeEnum,
+                                               psEvent->uMessage.sIndividualAttributeResponse.pvAttributeData);
+        }
+#endif
+        break;
+
     case E_ZCL_CBET_WRITE_INDIVIDUAL_ATTRIBUTE:
         DBG_vPrintf(TRACE_ZCL, "\nEP EVT: Write Individual Attribute");
         break;
@@ -538,86 +719,339 @@ PRIVATE void APP_ZCL_cbEndpointCallback(tsZCL_CallBackEvent *psEvent)
         {
             APP_vHandleIdentify(sLight.sIdentifyServerCluster.u16IdentifyTime);
         }
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_CURVE)
+        {
+            vApp_LightCurve_Update();
+        }
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_CALIBRATION)
+        {
+            vApp_LightCalibration_Update();
+        }
+#ifdef JN516X_SPI_RGB
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_STRIP)
+        {
+            vApp_LightStrip_Update();
+        }
+#endif
+        else if (psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == APP_CLUSTER_ID_LIGHT_DIAGNOSTICS)
+        {
+            vApp_LightDiagnostics_Update();
+        }
+        else if ((psEvent->psClusterInstance->psClusterDefinition->u16ClusterEnum == GENERAL_CLUSTER_ID_LEVEL_CONTROL) &&
+                 bLI_TransitionActive(LI_CHANNEL_LEVEL))
+        {
+            /* LI is rendering the move to level itself, see vHandleMoveToLevel;
+             * any other level command cancels it first */
+        }
         else
         {
-            if (sLight.sIdentifyServerCluster.u16IdentifyTime == 0) {
-                /*
-                 * If not identifying then do the light
-                 */
-                //DBG_vPrintf(TRACE_PATH, "\nPath 2");
-                #if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic)
-                    vApp_eCLD_ColourControl_GetRGB(&u8Red, &u8Green, &u8Blue);
-#if TRACE_LIGHT_TASK
+            /* Level and colour each report every step of a transition; the
+             * outputs are worked out once for all of them at the next tick */
+            vApp_Tick_LightChanged();
+        }
+        break;
 
-                    DBG_vPrintf(TRACE_LIGHT_TASK, "\nR %d G %d B %d L %d ",
-                                          u8Red, u8Green, u8Blue, sLight.sLevelControlServerCluster.u8CurrentLevel);
-#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_HUE_SATURATION_SUPPORTED)
-                    DBG_vPrintf(TRACE_LIGHT_TASK, "Hue %d Sat %d ",
-                                         sLight.sColourControlServerCluster.u8CurrentHue,
-                                         sLight.sColourControlServerCluster.u8CurrentSaturation);
-#endif
-#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_XY_SUPPORTED)
-                    DBG_vPrintf(TRACE_LIGHT_TASK, "X %d Y %d ",
-                                          sLight.sColourControlServerCluster.u16CurrentX,
-                                          sLight.sColourControlServerCluster.u16CurrentY);
-#endif
-#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_COLOUR_TEMPERATURE_SUPPORTED)
-                    DBG_vPrintf(TRACE_LIGHT_TASK, "T %dK ",
-                                         1000000 / sLight.sColourControlServerCluster.u16ColourTemperatureMired);
-#endif
-                    DBG_vPrintf(TRACE_LIGHT_TASK, "M %d On %d OnTime %d OffTime %d",
-                                        sLight.sColourControlServerCluster.u8ColourMode,
-                                        sLight.sOnOffServerCluster.bOnOff,
-                                        sLight.sOnOffServerCluster.u16OnTime,
-                                        sLight.sOnOffServerCluster.u16OffWaitTime);
+    default:
+        DBG_vPrintf(TRACE_ZCL, "\nEP EVT: Invalid evt type 0x%x", (uint8)psEvent->eEventType);
+        break;
+
+    }
+
+
+    if (psEvent->eEventType == E_ZCL_CBET_CLUSTER_CUSTOM)
+    {
+        if (psEvent->uMessage.sClusterCustomMessage.u16ClusterId == ZLL_CLUSTER_ID_COMMISSIONING)
+        {
+            APP_ZCL_cbZllCommissionCallback(psEvent);
+        }
+    }
+
+    /* Commands and updates may start work the tick has to step */
+    if ((psEvent->eEventType == E_ZCL_CBET_CLUSTER_CUSTOM) ||
+        (psEvent->eEventType == E_ZCL_CBET_CLUSTER_UPDATE))
+    {
+        bClusterActive = (psEvent->eEventType == E_ZCL_CBET_CLUSTER_UPDATE) || bClusterActive;
+        vApp_Tick_Wake();
+    }
+}
+
+#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)
+/****************************************************************************
+ *
+ * NAME: vHandleMoveToLevel
+ *
+ * DESCRIPTION:
+ * Hands a move to level transition straight to LI, which then renders it
+ * at the full LI rate without following the 100ms cluster updates, along
+ * eCurve
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vHandleMoveToLevel(uint8 u8Level, uint16 u16TransitionTime, teLI_Curve eCurve)
+{
+    /* 0xFFFF selects the On/Off transition time attribute */
+    if (u16TransitionTime == 0xFFFF)
+    {
+#ifdef CLD_LEVELCONTROL_ATTR_ON_OFF_TRANSITION_TIME
+        u16TransitionTime = sLight.sLevelControlServerCluster.u16OnOffTransitionTime;
+#else
+        u16TransitionTime = 0;
 #endif
-                    vRGBLight_SetLevels(sLight.sOnOffServerCluster.bOnOff,
-                        sLight.sLevelControlServerCluster.u8CurrentLevel,
-                        u8Red,
-                        u8Green,
-                        u8Blue);
+    }
 
-				#elif (defined CLD_COLOUR_CONTROL) && ((defined DR1221) || (defined DR1221_Dimic))
-                    /* controllable colour temperature tunable white (CCT TW) bulbs */
-                    DBG_vPrintf(TRACE_LIGHT_TASK,"\nCU:On %d, L:%d  T:%dK",sLight.sOnOffServerCluster.bOnOff,
-                    		                                            sLight.sLevelControlServerCluster.u8CurrentLevel,
-                    		                                            (1000000 / sLight.sColourControlServerCluster.u16ColourTemperatureMired));
+    /* Instant changes and lights that are off follow the cluster as before */
+    if ((u16TransitionTime == 0) ||
+        (sLight.sOnOffServerCluster.bOnOff == FALSE) ||
+        (sLight.sIdentifyServerCluster.u16IdentifyTime != 0))
+    {
+        vCancelLevelTransition();
+        return;
+    }
 
-                    vTunableWhiteLightSetLevels(sLight.sOnOffServerCluster.bOnOff,
-                                                sLight.sLevelControlServerCluster.u8CurrentLevel,
-                                   		        sLight.sColourControlServerCluster.u16ColourTemperatureMired);
+    DBG_vPrintf(TRACE_LIGHT_TASK, "\nLI Move to level %d in %d00ms", u8Level, u16TransitionTime);
 
-                #elif ( defined MONO_WITH_LEVEL)
-                    /*
-                     * Monochrome bulb with level control
-                     */
-                    vSetBulbState(sLight.sOnOffServerCluster.bOnOff, sLight.sLevelControlServerCluster.u8CurrentLevel);
+    #if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic)
+        vRGBLight_StartLevelTransition(MAX(CLD_LEVELCONTROL_MIN_LEVEL, u8Level), (uint32)u16TransitionTime * 100,
+                                       eCurve);
+    #elif (defined MONO_WITH_LEVEL)
+        vStartBulbLevelTransition(MAX(CLD_LEVELCONTROL_MIN_LEVEL, u8Level), (uint32)u16TransitionTime * 100,
+                                  eCurve);
+    #endif
+}
 
-                #elif (defined MONO_ON_OFF)
-                    /*
-                     * mono on off bulb
-                     */
-                    DBG_vPrintf(TRACE_PATH, "\nJP on_off only bulb");
-                    vSetBulbState( sLight.sOnOffServerCluster.bOnOff);
-                #endif
+#if (defined CLD_SCENES) && (defined SCENES_SERVER)
+/****************************************************************************
+ *
+ * NAME: vHandleSceneCommand
+ *
+ * DESCRIPTION:
+ * A scene stored or added keeps the curve in the light's transition curve
+ * attribute, in a PDM record of its own. A recalled scene's level
+ * transition is handed to LI along the curve the scene kept, linear for
+ * a scene without one; the rest of the scene follows the cluster updates
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vHandleSceneCommand(tsCLD_ScenesCallBackMessage *psCallBackMessage)
+{
+    uint16 u16TransitionTime;
+    uint8 u8Level;
+    uint8 u8Curve;
+
+    switch (psCallBackMessage->u8CommandId)
+    {
+    case E_CLD_SCENES_CMD_ADD:
+        vStoreSceneCurve(psCallBackMessage->uMessage.psAddSceneRequestPayload->u16GroupId,
+                         psCallBackMessage->uMessage.psAddSceneRequestPayload->u8SceneId,
+                         (uint8)eApp_LightCurve_Get());
+        break;
+
+    case E_CLD_SCENES_CMD_STORE:
+        vStoreSceneCurve(psCallBackMessage->uMessage.psStoreSceneRequestPayload->u16GroupId,
+                         psCallBackMessage->uMessage.psStoreSceneRequestPayload->u8SceneId,
+                         (uint8)eApp_LightCurve_Get());
+        break;
+
+    case E_CLD_SCENES_CMD_RECALL:
+        if (bGetSceneLevel(psCallBackMessage->uMessage.psRecallSceneRequestPayload->u16GroupId,
+                           psCallBackMessage->uMessage.psRecallSceneRequestPayload->u8SceneId,
+                           &u8Level, &u16TransitionTime))
+        {
+            if (!bGetSceneCurve(psCallBackMessage->uMessage.psRecallSceneRequestPayload->u16GroupId,
+                                psCallBackMessage->uMessage.psRecallSceneRequestPayload->u8SceneId,
+                                &u8Curve) ||
+                (u8Curve >= E_LI_CURVE_NUM))
+            {
+                u8Curve = E_LI_CURVE_LINEAR;
             }
+            DBG_vPrintf(TRACE_LIGHT_TASK, "\nScene level %d curve %d", u8Level, u8Curve);
+            vHandleMoveToLevel(u8Level, u16TransitionTime, (teLI_Curve)u8Curve);
         }
         break;
 
     default:
-        DBG_vPrintf(TRACE_ZCL, "\nEP EVT: Invalid evt type 0x%x", (uint8)psEvent->eEventType);
         break;
+    }
+}
+#endif
 
+/****************************************************************************
+ *
+ * NAME: vCancelLevelTransition
+ *
+ * DESCRIPTION:
+ * Ends a move to level LI is rendering when another level command takes
+ * over, and has the next commit take the level on to the cluster's, so
+ * the level updates that command brings are not dropped
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vCancelLevelTransition(void)
+{
+    if (bLI_TransitionActive(LI_CHANNEL_LEVEL))
+    {
+        vLI_StopChannels(LI_CHANNEL_LEVEL);
+        vApp_Tick_LightChanged();
+        vApp_Tick_Wake();
     }
+}
+#endif
 
+/****************************************************************************
+ *
+ * NAME: vCommitLightState
+ *
+ * DESCRIPTION:
+ * Works out the outputs from the cluster attributes once for all the
+ * cluster updates since the last tick and hands them to the driver and LI
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PRIVATE void vCommitLightState(void)
+{
+    #if (defined CLD_COLOUR_CONTROL)  && !(defined DR1221) && !(defined DR1221_Dimic) && !(defined JN516X_TUNABLEWHITE)
+        uint8 u8Red, u8Green, u8Blue;
+    #endif
 
-    if (psEvent->eEventType == E_ZCL_CBET_CLUSTER_CUSTOM)
+    if (sLight.sIdentifyServerCluster.u16IdentifyTime == 0) {
+        /*
+         * If not identifying then do the light
+         */
+        //DBG_vPrintf(TRACE_PATH, "\nPath 2");
+        #if (defined CLD_COLOUR_CONTROL) && !(defined DR1221) && !(defined DR1221_Dimic) && !(defined JN516X_TUNABLEWHITE)
+            vApp_eCLD_ColourControl_GetRGB(&u8Red, &u8Green, &u8Blue);
+#if TRACE_LIGHT_TASK
+
+            DBG_vPrintf(TRACE_LIGHT_TASK, "\nR %d G %d B %d L %d ",
+                                  u8Red, u8Green, u8Blue, sLight.sLevelControlServerCluster.u8CurrentLevel);
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_HUE_SATURATION_SUPPORTED)
+            DBG_vPrintf(TRACE_LIGHT_TASK, "Hue %d Sat %d ",
+                                 sLight.sColourControlServerCluster.u8CurrentHue,
+                                 sLight.sColourControlServerCluster.u8CurrentSaturation);
+#endif
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_XY_SUPPORTED)
+            DBG_vPrintf(TRACE_LIGHT_TASK, "X %d Y %d ",
+                                  sLight.sColourControlServerCluster.u16CurrentX,
+                                  sLight.sColourControlServerCluster.u16CurrentY);
+#endif
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_COLOUR_TEMPERATURE_SUPPORTED)
+            DBG_vPrintf(TRACE_LIGHT_TASK, "T %dK ",
+                                 1000000 / sLight.sColourControlServerCluster.u16ColourTemperatureMired);
+#endif
+            DBG_vPrintf(TRACE_LIGHT_TASK, "M %d On %d OnTime %d OffTime %d",
+                                sLight.sColourControlServerCluster.u8ColourMode,
+                                sLight.sOnOffServerCluster.bOnOff,
+                                sLight.sOnOffServerCluster.u16OnTime,
+                                sLight.sOnOffServerCluster.u16OffWaitTime);
+#endif
+            vRGBLight_SetLevels(sLight.sOnOffServerCluster.bOnOff,
+                sLight.sLevelControlServerCluster.u8CurrentLevel,
+                u8Red,
+                u8Green,
+                u8Blue);
+
+        #elif (defined CLD_COLOUR_CONTROL) && ((defined DR1221) || (defined DR1221_Dimic) || (defined JN516X_TUNABLEWHITE))
+            /* controllable colour temperature tunable white (CCT TW) bulbs */
+            DBG_vPrintf(TRACE_LIGHT_TASK,"\nCU:On %d, L:%d  T:%dK",sLight.sOnOffServerCluster.bOnOff,
+            		                                            sLight.sLevelControlServerCluster.u8CurrentLevel,
+            		                                            (1000000 / sLight.sColourControlServerCluster.u16ColourTemperatureMired));
+
+            vTunableWhiteLightSetLevels(sLight.sOnOffServerCluster.bOnOff,
+                                        sLight.sLevelControlServerCluster.u8CurrentLevel,
+                           		        sLight.sColourControlServerCluster.u16ColourTemperatureMired);
+
+        #elif ( defined MONO_WITH_LEVEL)
+            /*
+             * Monochrome bulb with level control
+             */
+            vSetBulbState(sLight.sOnOffServerCluster.bOnOff, sLight.sLevelControlServerCluster.u8CurrentLevel);
+
+        #elif (defined MONO_ON_OFF)
+            /*
+             * mono on off bulb
+             */
+            DBG_vPrintf(TRACE_PATH, "\nJP on_off only bulb");
+            vSetBulbState( sLight.sOnOffServerCluster.bOnOff);
+        #endif
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME: u8TickStagesPending
+ *
+ * DESCRIPTION:
+ * The tick stages the light's pending work needs: every tick while LI has
+ * points to create or the driver has output to finish, and the 100ms
+ * updates while a cluster is counting down or moving an attribute
+ *
+ * RETURNS:
+ * APP_TICK_STAGE_ bits
+ *
+ ****************************************************************************/
+PRIVATE uint8 u8TickStagesPending(void)
+{
+    uint8 u8Stages = 0;
+
+#if ( defined CLD_LEVEL_CONTROL) && !(defined MONO_ON_OFF)
+    if (bLI_Busy())
     {
-        if (psEvent->uMessage.sClusterCustomMessage.u16ClusterId == ZLL_CLUSTER_ID_COMMISSIONING)
-        {
-            APP_ZCL_cbZllCommissionCallback(psEvent);
-        }
+        u8Stages |= APP_TICK_STAGE_10MS;
+    }
+#endif
+    if (bBULB_TickPending())
+    {
+        u8Stages |= APP_TICK_STAGE_10MS;
+    }
+
+    if (bClusterActive ||
+        (sLight.sIdentifyServerCluster.u16IdentifyTime != 0) ||
+        bIdEffectActive())
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
+    }
+#ifdef CLD_ONOFF_ATTR_ON_TIME
+    if (sLight.sOnOffServerCluster.u16OnTime != 0)
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
     }
+#endif
+#ifdef CLD_ONOFF_ATTR_OFF_WAIT_TIME
+    if (sLight.sOnOffServerCluster.u16OffWaitTime != 0)
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
+    }
+#endif
+#if (defined CLD_LEVEL_CONTROL) && (defined CLD_LEVELCONTROL_ATTR_REMAINING_TIME)
+    if (sLight.sLevelControlServerCluster.u16RemainingTime != 0)
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
+    }
+#endif
+#ifdef CLD_COLOUR_CONTROL
+#ifdef CLD_COLOURCONTROL_ATTR_REMAINING_TIME
+    if (sLight.sColourControlServerCluster.u16RemainingTime != 0)
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
+    }
+#endif
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_COLOUR_LOOP_SUPPORTED)
+    if (sLight.sColourControlServerCluster.u8ColourLoopActive != 0)
+    {
+        u8Stages |= APP_TICK_STAGE_100MS;
+    }
+#endif
+#endif
+
+    return u8Stages;
 }
 
 /****************************************************************************
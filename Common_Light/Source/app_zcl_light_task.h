@@ -69,6 +69,12 @@
 /****************************************************************************/
 PUBLIC void APP_ZCL_vInitialise(void);
 PUBLIC void APP_ZCL_vSetIdentifyTime(uint16 u16Time);
+PUBLIC teZCL_Status eApp_AppendCluster(tsZCL_EndPointDefinition *psEndPoint,
+                                       tsZCL_ClusterInstance *psInstanceArray,
+                                       uint16 u16Size,
+                                       tsZCL_ClusterDefinition *psClusterDefinition,
+                                       void *pvEndPointSharedStruct,
+                                       uint8 *pu8AttributeControlBits);
 
 
 /****************************************************************************/
@@ -72,6 +72,7 @@
 
 
 #include "DriverBulb.h"
+#include "DriverBulb_Shim.h"
 
 #include "zcl.h"
 
@@ -310,6 +311,9 @@ PUBLIC void APP_vInitialiseNode(void) {
 
     vLoadScenesNVM();
 
+    /* Fixture settings of the bulb driver, e.g. the strip profile */
+    vBULB_LoadSettings();
+
 
 
 #if DBG_EVENT
@@ -330,6 +334,7 @@ PUBLIC void APP_vInitialiseNode(void) {
 #if (defined DR1175) || (defined DR1173)
     if (bDeleteRecords) {
         PDM_vDeleteDataRecord(PDM_ID_APP_SCENES_DATA);
+        PDM_vDeleteDataRecord(PDM_ID_APP_SCENE_CURVES);
         while (APP_bButtonInitialise());
     }
 #endif
@@ -634,18 +639,20 @@ OS_TASK(APP_ZPR_Light_Task)
 
 
 				if ((sStackEvent.uEvent.sApsDataIndEvent.eStatus == ZPS_E_SUCCESS) &&
-				        (sStackEvent.uEvent.sApsDataIndEvent.u8DstEndpoint == 0))
+				        (sStackEvent.uEvent.sApsDataIndEvent.u8DstEndpoint == 0) &&
+				        ((ZPS_ZDP_MATCH_DESC_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId) ||
+				         (ZPS_ZDP_IEEE_ADDR_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId)) &&
+				        (OS_ePostMessage(APP_msgOtaEvents, &sStackEvent) == OS_E_OK))
 				{
-				    // Data Ind for ZDp Ep
-				    if (ZPS_ZDP_MATCH_DESC_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId) {
-				        vHandleMatchDescriptor(&sStackEvent);
-				    } else if (ZPS_ZDP_IEEE_ADDR_RSP_CLUSTER_ID == sStackEvent.uEvent.sApsDataIndEvent.u16ClusterId) {
-				        vHandleIeeeAddressRsp(&sStackEvent);
-				    }
+				    // Data Ind for ZDp Ep, APP_OTA_Task handles it and lets the buffer go
+				    sStackEvent.eType = ZPS_EVENT_NONE;
 				}
+				else
 #endif
-				// let the buffer go
-				PDUM_eAPduFreeAPduInstance(sStackEvent.uEvent.sApsDataIndEvent.hAPduInst);
+				{
+				    // let the buffer go
+				    PDUM_eAPduFreeAPduInstance(sStackEvent.uEvent.sApsDataIndEvent.hAPduInst);
+				}
 			}
 #endif
 
@@ -0,0 +1,107 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          AppHardwareApi.h
+ *
+ * DESCRIPTION:        Host build: stand-in for the JN516x Integrated Peripherals API
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef APPHARDWAREAPI_H_INCLUDED
+#define APPHARDWAREAPI_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Timer identifiers */
+#define E_AHI_TIMER_0               0
+#define E_AHI_TIMER_1               1
+#define E_AHI_TIMER_2               2
+#define E_AHI_TIMER_3               3
+#define E_AHI_TIMER_4               4
+#define HOST_AHI_NUM_TIMERS         5
+
+/* Timer interrupt sources returned by u8AHI_TimerFired */
+#define E_AHI_TIMER_INT_RISE        (1 << 0)
+#define E_AHI_TIMER_INT_PERIOD      (1 << 1)
+
+/* Device identifiers passed to peripheral callbacks */
+#define E_AHI_DEVICE_TIMER0         9
+#define E_AHI_DEVICE_TIMER1         23
+#define E_AHI_DEVICE_TIMER2         24
+#define E_AHI_DEVICE_TIMER3         25
+#define E_AHI_DEVICE_TIMER4         26
+#define E_AHI_DEVICE_SPIM           20
+
+/* SPI interrupt mask */
+#define E_AHI_SPIM_TX_RX_COMP       (1 << 0)
+
+/* Sleep modes */
+#define E_AHI_SLEEP_OSCON_RAMON     0
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef void (*PR_HWINT_APPCALLBACK)(uint32 u32DeviceId, uint32 u32ItemBitmap);
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* Timers */
+PUBLIC void   vAHI_TimerEnable(uint8 u8Timer, uint8 u8Prescale, bool_t bIntRiseEnable,
+                               bool_t bIntPeriodEnable, bool_t bOutputEnable);
+PUBLIC void   vAHI_TimerConfigureOutputs(uint8 u8Timer, bool_t bInvertPwmOutput, bool_t bInputDisable);
+PUBLIC void   vAHI_TimerStartRepeat(uint8 u8Timer, uint16 u16Hi, uint16 u16Lo);
+PUBLIC void   vAHI_TimerStop(uint8 u8Timer);
+PUBLIC void   vAHI_TimerDisable(uint8 u8Timer);
+PUBLIC uint8  u8AHI_TimerFired(uint8 u8Timer);
+PUBLIC void   vAHI_Timer0RegisterCallback(PR_HWINT_APPCALLBACK prTimer0Callback);
+PUBLIC void   vAHI_Timer1RegisterCallback(PR_HWINT_APPCALLBACK prTimer1Callback);
+PUBLIC void   vAHI_Timer2RegisterCallback(PR_HWINT_APPCALLBACK prTimer2Callback);
+PUBLIC void   vAHI_Timer3RegisterCallback(PR_HWINT_APPCALLBACK prTimer3Callback);
+PUBLIC void   vAHI_Timer4RegisterCallback(PR_HWINT_APPCALLBACK prTimer4Callback);
+
+/* SPI master */
+PUBLIC void   vAHI_SpiConfigure(uint8 u8SlaveEnable, bool_t bLsbFirst, bool_t bPolarity,
+                                bool_t bPhase, uint8 u8ClockDivider, bool_t bInterruptEnable,
+                                bool_t bAutoSlaveSelect);
+PUBLIC void   vAHI_SpiStartTransfer(uint8 u8CharLen, uint32 u32Out);
+PUBLIC void   vAHI_SpiWaitBusy(void);
+PUBLIC bool_t bAHI_SpiPollBusy(void);
+PUBLIC void   vAHI_SpiRegisterCallback(PR_HWINT_APPCALLBACK prSpiCallback);
+
+/* Tick timer (free running 16MHz counter) */
+PUBLIC uint32 u32AHI_TickTimerRead(void);
+
+/* System */
+PUBLIC void   vAHI_SwReset(void);
+
+#endif /* APPHARDWAREAPI_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,435 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          host_ahi.c
+ *
+ * DESCRIPTION:        Host build: fake JN516x timers, SPI master and tick timer
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <time.h>
+#include <jendefs.h>
+#include <AppHardwareApi.h>
+#include "host_fake.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+#define PERIPHERAL_CLOCK_FREQUENCY_HZ   16000000ULL
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+tsHostAhi sHostAhi;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE PR_HWINT_APPCALLBACK prSpiCallback = NULL;
+PRIVATE PR_HWINT_APPCALLBACK aprTimerCallback[HOST_AHI_NUM_TIMERS];
+PRIVATE const uint32 au32TimerDevice[HOST_AHI_NUM_TIMERS] =
+{
+    E_AHI_DEVICE_TIMER0, E_AHI_DEVICE_TIMER1, E_AHI_DEVICE_TIMER2, E_AHI_DEVICE_TIMER3, E_AHI_DEVICE_TIMER4
+};
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME:            vHost_AhiReset
+ *
+ * DESCRIPTION:     Clears the recorded counters. Peripheral configuration is
+ *                  kept, as the drivers only initialise it once, and SPI
+ *                  traffic still queued by the driver is run to completion.
+ *                  Running timers restart their period at time zero, as
+ *                  simulated time is rewound with this
+ *
+ ****************************************************************************/
+PUBLIC void vHost_AhiReset(void)
+{
+    uint8 i;
+
+    vHost_AhiSpiFlush();
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        tsHostTimer *psTimer = &sHostAhi.asTimer[i];
+
+        psTimer->u32Starts    = 0;
+        psTimer->u32Runts     = 0;
+        psTimer->u64StartedAt = 0;
+        psTimer->u64PeriodAt  = (uint64)MAX(1, psTimer->u16Lo) << psTimer->u8Prescale;
+    }
+    sHostAhi.u32SpiTransfers = 0;
+    sHostAhi.u32SpiWaits     = 0;
+    sHostAhi.u64SpiBits      = 0;
+    sHostAhi.u64SpiWireNs    = 0;
+    sHostAhi.u64SpiSpinNs    = 0;
+    sHostAhi.u64SpiIsrNs     = 0;
+    sHostAhi.u64TimerIsrNs   = 0;
+    sHostAhi.u32TimerInts    = 0;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vAHI_Timer*
+ *
+ * DESCRIPTION:     Timers record how they were last programmed and keep
+ *                  time in periods of u16Lo counts of the prescaled clock.
+ *                  Restarting a running timer anywhere but on a period
+ *                  boundary is counted as a runt: the output gets a pulse
+ *                  shorter than a whole period
+ *
+ ****************************************************************************/
+PUBLIC void vAHI_TimerEnable(uint8 u8Timer, uint8 u8Prescale, bool_t bIntRiseEnable,
+                             bool_t bIntPeriodEnable, bool_t bOutputEnable)
+{
+    tsHostTimer *psTimer = &sHostAhi.asTimer[u8Timer];
+    uint64 u64Period;
+
+    /* A running timer takes its first period interrupt at the end of the
+     * period it is in */
+    if (psTimer->bRunning && bIntPeriodEnable && !psTimer->bIntPeriod)
+    {
+        u64Period = (uint64)MAX(1, psTimer->u16Lo) << psTimer->u8Prescale;
+        psTimer->u64PeriodAt = psTimer->u64StartedAt +
+            ((u64Host_OsTime() - psTimer->u64StartedAt) / u64Period + 1) * u64Period;
+    }
+    psTimer->bEnabled   = TRUE;
+    psTimer->bIntPeriod = bIntPeriodEnable;
+    psTimer->u8Prescale = u8Prescale;
+}
+
+PUBLIC void vAHI_TimerConfigureOutputs(uint8 u8Timer, bool_t bInvertPwmOutput, bool_t bInputDisable)
+{
+    sHostAhi.asTimer[u8Timer].bInvert = bInvertPwmOutput;
+}
+
+PUBLIC void vAHI_TimerStartRepeat(uint8 u8Timer, uint16 u16Hi, uint16 u16Lo)
+{
+    tsHostTimer *psTimer = &sHostAhi.asTimer[u8Timer];
+    uint64 u64Now = u64Host_OsTime();
+    uint64 u64Period;
+
+    if (psTimer->bRunning)
+    {
+        u64Period = (uint64)MAX(1, psTimer->u16Lo) << psTimer->u8Prescale;
+        if ((u64Now - psTimer->u64StartedAt) % u64Period != 0)
+        {
+            psTimer->u32Runts++;
+        }
+    }
+    psTimer->u16Hi        = u16Hi;
+    psTimer->u16Lo        = u16Lo;
+    psTimer->u32Starts++;
+    psTimer->bRunning     = TRUE;
+    psTimer->u64StartedAt = u64Now;
+    psTimer->u64PeriodAt  = u64Now + ((uint64)MAX(1, u16Lo) << psTimer->u8Prescale);
+}
+
+PUBLIC void vAHI_TimerStop(uint8 u8Timer)
+{
+    sHostAhi.asTimer[u8Timer].bRunning = FALSE;
+}
+
+PUBLIC void vAHI_TimerDisable(uint8 u8Timer)
+{
+    sHostAhi.asTimer[u8Timer].bEnabled = FALSE;
+    sHostAhi.asTimer[u8Timer].bRunning = FALSE;
+}
+
+PUBLIC uint8 u8AHI_TimerFired(uint8 u8Timer)
+{
+    return E_AHI_TIMER_INT_PERIOD;
+}
+
+PUBLIC void vAHI_Timer0RegisterCallback(PR_HWINT_APPCALLBACK prTimer0Callback)
+{
+    aprTimerCallback[E_AHI_TIMER_0] = prTimer0Callback;
+}
+
+PUBLIC void vAHI_Timer1RegisterCallback(PR_HWINT_APPCALLBACK prTimer1Callback)
+{
+    aprTimerCallback[E_AHI_TIMER_1] = prTimer1Callback;
+}
+
+PUBLIC void vAHI_Timer2RegisterCallback(PR_HWINT_APPCALLBACK prTimer2Callback)
+{
+    aprTimerCallback[E_AHI_TIMER_2] = prTimer2Callback;
+}
+
+PUBLIC void vAHI_Timer3RegisterCallback(PR_HWINT_APPCALLBACK prTimer3Callback)
+{
+    aprTimerCallback[E_AHI_TIMER_3] = prTimer3Callback;
+}
+
+PUBLIC void vAHI_Timer4RegisterCallback(PR_HWINT_APPCALLBACK prTimer4Callback)
+{
+    aprTimerCallback[E_AHI_TIMER_4] = prTimer4Callback;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_AhiTimerPending
+ *
+ * DESCRIPTION:     Reports when the next period interrupt is due from a
+ *                  running timer that has one enabled
+ *
+ ****************************************************************************/
+PUBLIC bool_t bHost_AhiTimerPending(uint64 *pu64PeriodAt)
+{
+    bool_t bPending = FALSE;
+    uint8 i;
+
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        tsHostTimer *psTimer = &sHostAhi.asTimer[i];
+
+        if (psTimer->bRunning && psTimer->bIntPeriod && aprTimerCallback[i] != NULL &&
+            (!bPending || psTimer->u64PeriodAt < *pu64PeriodAt))
+        {
+            *pu64PeriodAt = psTimer->u64PeriodAt;
+            bPending = TRUE;
+        }
+    }
+    return bPending;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_AhiTimerPeriod
+ *
+ * DESCRIPTION:     Ends the period of every timer due now and raises its
+ *                  period interrupt
+ *
+ ****************************************************************************/
+PUBLIC void vHost_AhiTimerPeriod(void)
+{
+    uint64 u64Now = u64Host_OsTime();
+    uint64 u64Start;
+    uint8 i;
+
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        tsHostTimer *psTimer = &sHostAhi.asTimer[i];
+
+        if (psTimer->bRunning && psTimer->bIntPeriod && aprTimerCallback[i] != NULL &&
+            psTimer->u64PeriodAt <= u64Now)
+        {
+            psTimer->u64PeriodAt += (uint64)MAX(1, psTimer->u16Lo) << psTimer->u8Prescale;
+            u64Start = u64Host_CpuNs();
+            sHostAhi.u32TimerInts++;
+            aprTimerCallback[i](au32TimerDevice[i], E_AHI_TIMER_INT_PERIOD);
+            sHostAhi.u64TimerIsrNs += u64Host_CpuNs() - u64Start;
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            vAHI_Spi*
+ *
+ * DESCRIPTION:     SPI master; each transfer is accounted with the time it
+ *                  would take on the wire at the configured clock divider.
+ *                  Busy waiting completes the transfer at once but books
+ *                  the remaining wire time as spin; otherwise it completes
+ *                  as simulated time passes its end.
+ *                  The bytes sent are clocked into a model of an LPD8806
+ *                  strip: bytes with the top bit set are colour data for
+ *                  the next LED along, a zero byte latches and restarts
+ *                  from the first LED. The raw bytes are also kept for
+ *                  each frame, a frame being the transfers chained from
+ *                  the interrupt without the bus going idle
+ *
+ ****************************************************************************/
+PUBLIC void vAHI_SpiConfigure(uint8 u8SlaveEnable, bool_t bLsbFirst, bool_t bPolarity,
+                              bool_t bPhase, uint8 u8ClockDivider, bool_t bInterruptEnable,
+                              bool_t bAutoSlaveSelect)
+{
+    sHostAhi.u8SpiDivider  = u8ClockDivider;
+    sHostAhi.bSpiIntEnable = bInterruptEnable;
+}
+
+PUBLIC void vAHI_SpiStartTransfer(uint8 u8CharLen, uint32 u32Out)
+{
+    uint64 u64SpiClock = PERIPHERAL_CLOCK_FREQUENCY_HZ / (2 * MAX(1, sHostAhi.u8SpiDivider));
+
+    sHostAhi.bSpiBusy = TRUE;
+    sHostAhi.u32SpiTransfers++;
+    sHostAhi.u64SpiBits     += u8CharLen;
+    sHostAhi.u64SpiWireNs   += ((uint64)u8CharLen * 1000000000ULL) / u64SpiClock;
+    sHostAhi.u64SpiDoneAt    = u64Host_OsTime() + (uint64)u8CharLen * 2 * MAX(1, sHostAhi.u8SpiDivider);
+    sHostAhi.u32SpiLastData  = u32Out;
+
+    if (!sHostAhi.bSpiInFrame)
+    {
+        sHostAhi.bSpiInFrame    = TRUE;
+        sHostAhi.u16SpiFrameLen = 0;
+    }
+
+    while (u8CharLen >= 8)
+    {
+        uint8 u8Byte = (uint8)(u32Out >> (u8CharLen - 8));
+
+        if (sHostAhi.u16SpiFrameLen < HOST_SPI_FRAME_BYTES)
+        {
+            sHostAhi.au8SpiFrame[sHostAhi.u16SpiFrameLen++] = u8Byte;
+        }
+
+        if ((u8Byte & 0x80) == 0)
+        {
+            sHostAhi.u16StripPos = 0;
+        }
+        else if (sHostAhi.u16StripPos < HOST_STRIP_BYTES)
+        {
+            sHostAhi.au8Strip[sHostAhi.u16StripPos++] = u8Byte;
+        }
+        u8CharLen -= 8;
+    }
+}
+
+PUBLIC void vAHI_SpiWaitBusy(void)
+{
+    uint64 u64Now = u64Host_OsTime();
+
+    sHostAhi.u32SpiWaits++;
+    if (sHostAhi.bSpiBusy && sHostAhi.u64SpiDoneAt > u64Now)
+    {
+        sHostAhi.u64SpiSpinNs += ((sHostAhi.u64SpiDoneAt - u64Now) * 1000000000ULL) / PERIPHERAL_CLOCK_FREQUENCY_HZ;
+    }
+    sHostAhi.bSpiBusy = FALSE;
+}
+
+PUBLIC bool_t bAHI_SpiPollBusy(void)
+{
+    return sHostAhi.bSpiBusy;
+}
+
+PUBLIC void vAHI_SpiRegisterCallback(PR_HWINT_APPCALLBACK prCallback)
+{
+    prSpiCallback = prCallback;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_AhiSpiComplete
+ *
+ * DESCRIPTION:     Completes the transfer in flight, raising the SPI
+ *                  interrupt if the driver enabled it
+ *
+ ****************************************************************************/
+PUBLIC void vHost_AhiSpiComplete(void)
+{
+    uint64 u64Start;
+
+    if (sHostAhi.bSpiBusy)
+    {
+        sHostAhi.bSpiBusy = FALSE;
+        if (sHostAhi.bSpiIntEnable && prSpiCallback != NULL)
+        {
+            u64Start = u64Host_CpuNs();
+            prSpiCallback(E_AHI_DEVICE_SPIM, E_AHI_SPIM_TX_RX_COMP);
+            sHostAhi.u64SpiIsrNs += u64Host_CpuNs() - u64Start;
+        }
+        sHostAhi.bSpiInFrame = sHostAhi.bSpiBusy;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_AhiSpiFlush
+ *
+ * DESCRIPTION:     Runs SPI traffic queued by the driver to completion
+ *
+ ****************************************************************************/
+PUBLIC void vHost_AhiSpiFlush(void)
+{
+    while (sHostAhi.bSpiBusy)
+    {
+        vHost_AhiSpiComplete();
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_AhiSpiPending
+ *
+ * DESCRIPTION:     Reports when the transfer in flight will complete
+ *
+ ****************************************************************************/
+PUBLIC bool_t bHost_AhiSpiPending(uint64 *pu64DoneAt)
+{
+    *pu64DoneAt = sHostAhi.u64SpiDoneAt;
+    return sHostAhi.bSpiBusy;
+}
+
+/****************************************************************************
+ *
+ * NAME:            u32AHI_TickTimerRead
+ *
+ * DESCRIPTION:     Free running tick timer, driven by the fake OS clock
+ *                  and moved on by the CPU time of the running task
+ *
+ ****************************************************************************/
+PUBLIC uint32 u32AHI_TickTimerRead(void)
+{
+    return (uint32)(u64Host_OsTime() + u64Host_OsRunTicks());
+}
+
+PUBLIC void vAHI_SwReset(void)
+{
+}
+
+/****************************************************************************
+ *
+ * NAME:            u64Host_CpuNs
+ *
+ * DESCRIPTION:     CPU time consumed by the calling thread
+ *
+ ****************************************************************************/
+PUBLIC uint64 u64Host_CpuNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &sNow);
+    return ((uint64)sNow.tv_sec * 1000000000ULL) + (uint64)sNow.tv_nsec;
+}
+
+/****************************************************************************
+ *
+ * NAME:            u64Host_WallNs
+ *
+ * DESCRIPTION:     Monotonic host time, a good deal cheaper to read than
+ *                  the thread CPU time and close to it while a task runs
+ *
+ ****************************************************************************/
+PUBLIC uint64 u64Host_WallNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return ((uint64)sNow.tv_sec * 1000000000ULL) + (uint64)sNow.tv_nsec;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,133 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          host_fake.h
+ *
+ * DESCRIPTION:        Host build: inspection interface onto the fake AHI, JenOS and PDM layers
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef HOST_FAKE_H_INCLUDED
+#define HOST_FAKE_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+#include "AppHardwareApi.h"
+#include "os.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+/* Bytes of LED state held by the fake strip on the SPI bus */
+#define HOST_STRIP_BYTES    (3 * 256)
+
+/* Bytes kept of the last run of back to back SPI transfers */
+#define HOST_SPI_FRAME_BYTES (1024)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef struct
+{
+    bool_t  bEnabled;
+    bool_t  bInvert;
+    bool_t  bIntPeriod;
+    bool_t  bRunning;
+    uint8   u8Prescale;
+    uint16  u16Hi;
+    uint16  u16Lo;
+    uint32  u32Starts;
+    uint32  u32Runts;           /* restarts that cut a period short */
+    uint64  u64StartedAt;       /* OS time of the last (re)start */
+    uint64  u64PeriodAt;        /* OS time the current period ends */
+} tsHostTimer;
+
+typedef struct
+{
+    tsHostTimer asTimer[HOST_AHI_NUM_TIMERS];
+    uint8       u8SpiDivider;
+    bool_t      bSpiIntEnable;
+    bool_t      bSpiBusy;
+    uint32      u32SpiTransfers;
+    uint32      u32SpiWaits;
+    uint64      u64SpiBits;
+    uint64      u64SpiWireNs;
+    uint64      u64SpiSpinNs;       /* wire time spent busy waiting */
+    uint64      u64SpiIsrNs;        /* host CPU time in the SPI callback */
+    uint64      u64TimerIsrNs;      /* host CPU time in the timer callbacks */
+    uint32      u32TimerInts;       /* period interrupts taken */
+    uint64      u64SpiDoneAt;       /* OS time the transfer in flight ends */
+    uint32      u32SpiLastData;
+    uint8       au8Strip[HOST_STRIP_BYTES];     /* LPD8806 strip on the bus */
+    uint16      u16StripPos;
+    uint8       au8SpiFrame[HOST_SPI_FRAME_BYTES];  /* raw bytes of the last frame */
+    uint16      u16SpiFrameLen;
+    bool_t      bSpiInFrame;
+} tsHostAhi;
+
+typedef struct
+{
+    uint32      u32Saves;
+    uint32      u32Reads;
+} tsHostPdm;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/* Fake AHI */
+PUBLIC void   vHost_AhiReset(void);
+PUBLIC void   vHost_AhiSpiComplete(void);
+PUBLIC void   vHost_AhiSpiFlush(void);
+PUBLIC bool_t bHost_AhiSpiPending(uint64 *pu64DoneAt);
+PUBLIC void   vHost_AhiTimerPeriod(void);
+PUBLIC bool_t bHost_AhiTimerPending(uint64 *pu64PeriodAt);
+
+/* Fake JenOS: simulated time is kept in 16MHz tick timer counts */
+PUBLIC void   vHost_OsReset(void);
+PUBLIC void   vHost_OsSetTimerTask(OS_thSWTimer hSWTimer, OS_thTask hTask);
+PUBLIC void   vHost_OsAdvance(uint64 u64Ticks);
+PUBLIC void   vHost_OsStall(uint64 u64Ticks);
+PUBLIC uint64 u64Host_OsTime(void);
+PUBLIC uint32 u32Host_OsActivations(void);
+PUBLIC uint64 u64Host_OsRunTicks(void);
+
+/* Fake PDM */
+PUBLIC void   vHost_PdmReset(void);
+
+/* Host CPU time of the calling thread, for benchmarking, and host time */
+PUBLIC uint64 u64Host_CpuNs(void);
+PUBLIC uint64 u64Host_WallNs(void);
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+
+extern tsHostAhi sHostAhi;
+extern tsHostPdm sHostPdm;
+
+#endif /* HOST_FAKE_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
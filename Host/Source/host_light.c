@@ -0,0 +1,2528 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          host_light.c
+ *
+ * DESCRIPTION:        Host build: drives the light rendering path against the fake SDK
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jendefs.h>
+#include <AppHardwareApi.h>
+#include "os.h"
+#include "os_gen.h"
+#include "app_timer_driver.h"
+#include "pdm.h"
+#include "PDM_IDs.h"
+#include "host_fake.h"
+
+#include "app_light_interpolation.h"
+#include "app_light_colour.h"
+#include "app_light_tick.h"
+#include "DriverBulb_Shim.h"
+#include "DriverBulb_DimCurve.h"
+#include "DriverBulb_PwmProfile.h"
+#include "DriverBulb_MiredTable.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+#define HOST_FADE_TIME_MS           (10000)
+#define HOST_ZCL_STEPS              (HOST_FADE_TIME_MS / 100)
+#define HOST_SUNRISE_TIME_MS        (30 * 60 * 1000)
+
+/* Runs start a little after their tick, as on the target; a run is
+ * allowed this late and still counted in its scenario */
+#define HOST_TICK_SLACK             APP_TIME_MS(1)
+
+/* The catch up check holds the CPU this long on every so many tick runs,
+ * past a couple of ticks each time */
+#define HOST_STALL                  APP_TIME_MS(25)
+#define HOST_STALL_EVERY            (7)
+
+/* Long enough for every PWM timer to reach a period end and latch */
+#define HOST_PWM_LATCH_TIME         APP_TIME_MS(2)
+
+/* LI points timed back to back, one clock read for the lot */
+#define HOST_LI_BENCH_POINTS        (1000000)
+
+/* Colour conversions timed back to back, and the grid of xy they are checked on */
+#define HOST_COLOUR_BENCH_CALLS     (1000000)
+#define HOST_COLOUR_GRID            (64)
+
+/* Driver updates timed back to back for the colour calibration */
+#define HOST_CAL_BENCH_UPDATES      (1000000)
+
+/* Channels the scalar LI reference steps: level, then any colour */
+#ifdef LI_RGB
+#define HOST_LI_CHANNELS            (4)
+#else
+#define HOST_LI_CHANNELS            (1)
+#endif
+#define HOST_LI_SCALE               (7)
+#define HOST_LI_TO_12BIT(u32Value)  (((u32Value) >> (HOST_LI_SCALE - 4)) + ((u32Value) >> (HOST_LI_SCALE + 4)))
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef struct
+{
+    const char *pcName;
+    void      (*prRun)(void);
+} tsHostScenario;
+
+typedef struct
+{
+    const char *pcName;
+    bool_t    (*prCheck)(void);
+} tsHostCheck;
+
+/* Stand-in for the level/colour cluster attributes the ZCL would move */
+typedef struct
+{
+    uint32  u32Step;
+    uint8   au8Start[4];
+    uint8   au8Target[4];
+    uint8   au8Current[4];
+} tsHostCluster;
+
+/* One LI channel as laid out before packing, a 32 bit value with an exact
+ * remainder, kept as the reference the packed LI is checked and timed by */
+typedef struct
+{
+    uint32  u32Current;
+    uint32  u32Step;
+    uint32  u32Remainder;
+    uint32  u32Error;
+    bool_t  bDown;
+} tsHostLiChannel;
+
+typedef struct
+{
+    uint64  u64CpuNs;
+    uint32  u32PeakWritesPerSec;
+    uint32  u32OutputCountAtStart;
+} tsHostStats;
+
+/****************************************************************************/
+/***        Local Function Prototypes                                     ***/
+/****************************************************************************/
+PRIVATE bool_t bHost_CheckDimCurve(void);
+PRIVATE bool_t bHost_CheckLevelMonotonic(void);
+PRIVATE bool_t bHost_CheckColourMonotonic(void);
+PRIVATE bool_t bHost_CheckOutputs(uint32 u32Level, uint32 u32Colour, uint32 *pu32Last);
+PRIVATE bool_t bHost_CheckSegments(void);
+PRIVATE bool_t bHost_CheckStripProfiles(void);
+PRIVATE bool_t bHost_CheckFrame(const char *pcName, const uint8 *pu8Expect, uint16 u16Len);
+PRIVATE bool_t bHost_CheckLiPacked(void);
+PRIVATE bool_t bHost_CheckLiCurves(void);
+PRIVATE bool_t bHost_CheckLiChannels(void);
+PRIVATE bool_t bHost_CheckLiRates(void);
+PRIVATE bool_t bHost_CheckLiCancel(void);
+PRIVATE bool_t bHost_CheckLiHsv(void);
+PRIVATE bool_t bHost_CheckColour(void);
+PRIVATE bool_t bHost_CheckColourTemperature(void);
+PRIVATE bool_t bHost_CheckTunableWhite(void);
+PRIVATE bool_t bHost_CheckRgbw(void);
+PRIVATE bool_t bHost_CheckCalibration(void);
+PRIVATE bool_t bHost_CheckCalibrationOutput(uint32 u32Red, uint32 u32Green, uint32 u32Blue, const uint32 *pu32Expect);
+PRIVATE bool_t bHost_CheckPwmProfiles(void);
+PRIVATE bool_t bHost_CheckTickScheduler(void);
+PRIVATE bool_t bHost_CheckTickCatchUp(void);
+PRIVATE void vHost_RunFade(void);
+PRIVATE void vHost_RunDirectFade(void);
+PRIVATE void vHost_RunSunrise(void);
+PRIVATE void vHost_RunLowFade(void);
+PRIVATE void vHost_RunHold(void);
+PRIVATE void vHost_RunIdle(void);
+#ifdef LI_SEGMENTS
+PRIVATE void vHost_RunSegments(void);
+#endif
+PRIVATE void vHost_Run(uint32 u32TimeMs);
+PRIVATE void vHost_TickTask(void);
+PRIVATE void vHost_ClusterUpdate100mS(void);
+PRIVATE void vHost_CommitLight(void);
+PRIVATE void vHost_CheckTickTask(void);
+PRIVATE void vHost_CatchUpTickTask(void);
+PRIVATE uint32 u32Host_Report(const char *pcName);
+PRIVATE void vHost_ReportTiming(const char *pcName, const tsAPP_TickDiag *psDiag);
+PRIVATE void vHost_BenchLi(void);
+PRIVATE void vHost_CompareLiColour(void);
+PRIVATE void vHost_BenchColour(void);
+PRIVATE void vHost_BenchCalibration(void);
+#ifdef LI_RGB
+PRIVATE void vHost_ColourRefXY(uint16 u16X, uint16 u16Y, uint8 *pu8Rgb);
+PRIVATE void vHost_ColourGridXY(uint32 u32Point, uint16 *pu16X, uint16 *pu16Y);
+#endif
+PRIVATE void vHost_LiRefStart(const uint8 *pu8Target, uint32 u32Points);
+PRIVATE void vHost_LiRefStep(uint32 u32Points);
+PRIVATE void vHost_LiRefUpdateDriver(void);
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE tsHostCluster sCluster;
+PRIVATE tsHostStats   sStats;
+PRIVATE bool_t        bClusterDriven;
+
+/* Times LI has been started from the stand-in cluster */
+PRIVATE uint32        u32Commits;
+
+/* Runs of the tick scheduler check: the stages due and when */
+PRIVATE uint8         au8CheckStages[8];
+PRIVATE uint64        au64CheckAt[8];
+PRIVATE uint32        u32CheckRuns;
+
+/* Runs of the catch up check: last tick the transition was still moving
+ * and first it had landed */
+PRIVATE uint32        u32CatchUpRuns;
+PRIVATE uint32        u32CatchUpBusyTick;
+PRIVATE uint32        u32CatchUpDoneTick;
+PRIVATE tsHostLiChannel asLiRef[HOST_LI_CHANNELS];
+
+PRIVATE const tsHostScenario asScenarios[] =
+{
+    { "fade 10s cluster driven",  vHost_RunFade },
+    { "fade 10s direct",          vHost_RunDirectFade },
+    { "sunrise 30min direct",     vHost_RunSunrise },
+    { "low fade 60s direct",      vHost_RunLowFade },
+    { "hold 10s",                 vHost_RunHold },
+    { "idle 60s",                 vHost_RunIdle },
+#ifdef LI_SEGMENTS
+    { "segments 10s direct",      vHost_RunSegments },
+#endif
+};
+
+PRIVATE const tsHostCheck asChecks[] =
+{
+    { "dim curve monotonic",      bHost_CheckDimCurve },
+    { "output monotonic in level",  bHost_CheckLevelMonotonic },
+    { "output monotonic in colour", bHost_CheckColourMonotonic },
+    { "strip segments",           bHost_CheckSegments },
+    { "strip profiles",           bHost_CheckStripProfiles },
+    { "packed LI against exact",  bHost_CheckLiPacked },
+    { "LI curves",                bHost_CheckLiCurves },
+    { "LI channels overlap",      bHost_CheckLiChannels },
+    { "LI channel rates",         bHost_CheckLiRates },
+    { "LI level cancelled",       bHost_CheckLiCancel },
+    { "LI colour HSV",            bHost_CheckLiHsv },
+    { "colour conversion",        bHost_CheckColour },
+    { "colour temperature on RGB", bHost_CheckColourTemperature },
+    { "tunable white",            bHost_CheckTunableWhite },
+    { "RGBW white extraction",    bHost_CheckRgbw },
+    { "colour calibration",       bHost_CheckCalibration },
+    { "PWM profiles",             bHost_CheckPwmProfiles },
+    { "tick scheduler",           bHost_CheckTickScheduler },
+    { "tick catch up under load", bHost_CheckTickCatchUp },
+};
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    tsAPP_TickDiag asDiag[sizeof(asScenarios) / sizeof(asScenarios[0])];
+    uint32 i;
+    int iFailed = 0;
+
+    vBULB_Init();
+    vBULB_LoadSettings();
+
+    for (i = 0; i < sizeof(asChecks) / sizeof(asChecks[0]); i++)
+    {
+        bool_t bOk = asChecks[i].prCheck();
+        printf("check %-28s %s\n", asChecks[i].pcName, bOk ? "ok" : "FAILED");
+        iFailed |= !bOk;
+    }
+
+    printf("%-28s %8s %8s %10s %10s %6s %10s %12s %8s %8s %8s %10s\n",
+           "scenario", "ticks", "wakes", "ns/wake", "pwm wr", "runts", "spi xfer", "spi wire ms", "spin ms",
+           "hw wr/s", "frames/s", "us/frame");
+
+    for (i = 0; i < sizeof(asScenarios) / sizeof(asScenarios[0]); i++)
+    {
+        vHost_AhiReset();
+        vHost_OsReset();
+        vHost_PdmReset();
+        memset(&sStats, 0, sizeof(sStats));
+        sStats.u32OutputCountAtStart = DriverBulb_u32GetOutputCount ? DriverBulb_u32GetOutputCount() : 0;
+        vBULB_Tick1Sec();
+
+        asScenarios[i].prRun();
+        vApp_Tick_GetDiag(&asDiag[i]);
+
+        /* A restart that cuts a PWM period short is a visible glitch */
+        iFailed |= (u32Host_Report(asScenarios[i].pcName) != 0);
+    }
+
+    printf("%-28s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+           "tick timing us", "late max", "late avg", "upd max", "upd avg", "LI max", "LI avg", "bulb max", "bulb avg");
+    for (i = 0; i < sizeof(asScenarios) / sizeof(asScenarios[0]); i++)
+    {
+        vHost_ReportTiming(asScenarios[i].pcName, &asDiag[i]);
+    }
+
+    vHost_BenchLi();
+    vHost_CompareLiColour();
+    vHost_BenchColour();
+    vHost_BenchCalibration();
+    return iFailed;
+}
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckDimCurve
+ *
+ * DESCRIPTION:     The generated dimming table must run from fully off to
+ *                  fully on without ever decreasing
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckDimCurve(void)
+{
+    uint32 i;
+
+    if (au16DimCurve[0] != 0 || au16DimCurve[DIM_CURVE_SIZE - 1] != 0xFFFF)
+    {
+        return FALSE;
+    }
+    for (i = 1; i < DIM_CURVE_SIZE; i++)
+    {
+        if (au16DimCurve[i] < au16DimCurve[i - 1])
+        {
+            printf("  entry %u: %u < %u\n", i, au16DimCurve[i], au16DimCurve[i - 1]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLevelMonotonic, bHost_CheckColourMonotonic
+ *
+ * DESCRIPTION:     Sweeps level at full white, then each colour value at
+ *                  full level, through the driver and checks no output
+ *                  channel ever steps down
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLevelMonotonic(void)
+{
+    uint32 au32Last[HOST_AHI_NUM_TIMERS + 3] = { 0 };
+    uint32 u32Level;
+
+    vBULB_SetOnOff(TRUE);
+    for (u32Level = 1; u32Level <= 255; u32Level++)
+    {
+        if (!bHost_CheckOutputs(u32Level, 255, au32Last))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+PRIVATE bool_t bHost_CheckColourMonotonic(void)
+{
+    uint32 au32Last[HOST_AHI_NUM_TIMERS + 3] = { 0 };
+    uint32 u32Colour;
+
+    vBULB_SetOnOff(TRUE);
+    for (u32Colour = 0; u32Colour <= 255; u32Colour++)
+    {
+        if (!bHost_CheckOutputs(255, u32Colour, au32Last))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckOutputs
+ *
+ * DESCRIPTION:     Commits one state and compares every PWM duty and SPI
+ *                  colour byte against the previous state's
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckOutputs(uint32 u32Level, uint32 u32Colour, uint32 *pu32Last)
+{
+    uint32 au32Out[HOST_AHI_NUM_TIMERS + 3];
+    uint8 i;
+
+    vBULB_SetState(u32Level, u32Colour, u32Colour, u32Colour, 0);
+    vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        tsHostTimer *psTimer = &sHostAhi.asTimer[i];
+        au32Out[i] = psTimer->bEnabled ? (uint32)(psTimer->u16Lo - psTimer->u16Hi) : 0;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        au32Out[HOST_AHI_NUM_TIMERS + i] = (sHostAhi.u32SpiLastData >> (8 * i)) & 0xFF;
+    }
+
+    for (i = 0; i < HOST_AHI_NUM_TIMERS + 3; i++)
+    {
+        if (au32Out[i] < pu32Last[i])
+        {
+            printf("  level %u colour %u: output %u fell %u -> %u\n",
+                   u32Level, u32Colour, i, pu32Last[i], au32Out[i]);
+            return FALSE;
+        }
+        pu32Last[i] = au32Out[i];
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckSegments
+ *
+ * DESCRIPTION:     Gives two segments of an addressable strip their own
+ *                  colours over a whole light colour and checks each LED
+ *                  clocked into the strip on the bus. Only run against a
+ *                  driver with a segment map
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckSegments(void)
+{
+    /* GRB as sent at full level, 129 being the lowest the driver sends */
+    const uint8 au8Whole[3] = { 129, 255, 129 };
+    const uint8 au8Seg0[3]  = { 255, 129, 129 };
+    const uint8 au8Seg1[3]  = { 129, 129, 255 };
+    const uint8 *pu8Expect;
+    uint16 u16Led;
+
+    if (DriverBulb_bMapSegment == NULL)
+    {
+        return TRUE;
+    }
+
+    vBULB_SetOnOff(TRUE);
+    vBULB_SetState(255, 255, 0, 0, 0);
+    if (!bBULB_MapSegment(0, 0, 4) || !bBULB_MapSegment(1, 10, 3) || bBULB_MapSegment(2, 0, 0xFFFF))
+    {
+        return FALSE;
+    }
+    vBULB_SetSegmentColour(0, 0, 255, 0);
+    vBULB_SetSegmentColour(1, 0, 0, 255);
+    vBULB_Tick();
+    vHost_AhiSpiFlush();
+
+    for (u16Led = 0; u16Led < 16; u16Led++)
+    {
+        pu8Expect = (u16Led < 4) ? au8Seg0 : (u16Led >= 10 && u16Led < 13) ? au8Seg1 : au8Whole;
+        if (memcmp(&sHostAhi.au8Strip[u16Led * 3], pu8Expect, 3) != 0)
+        {
+            printf("  led %u: %u %u %u\n", u16Led, sHostAhi.au8Strip[u16Led * 3],
+                   sHostAhi.au8Strip[u16Led * 3 + 1], sHostAhi.au8Strip[u16Led * 3 + 2]);
+            return FALSE;
+        }
+    }
+
+    /* Give the segments back to the whole light */
+    vBULB_SetState(255, 0, 0, 0, 0);
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckStripProfiles
+ *
+ * DESCRIPTION:     Switches the strip between chips, lengths and byte
+ *                  orders and checks the frames sent for each, then puts
+ *                  the default strip back. Only run against a driver with
+ *                  strip profiles
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckStripProfiles(void)
+{
+    const tsStripProfile sDefault = { 26, E_STRIP_LPD8806, E_STRIP_ORDER_GRB, 2000000 };
+    const tsStripProfile sApa102  = { 10, E_STRIP_APA102,  E_STRIP_ORDER_BGR, 4000000 };
+    const tsStripProfile sWs2801  = { 5,  E_STRIP_WS2801,  E_STRIP_ORDER_RGB, 1000000 };
+    tsStripProfile sBad = sDefault;
+    tsStripProfile sRead;
+    uint8  au8Expect[4 + 10 * 4 + 1];
+    uint64 u64DoneAt;
+    uint16 u16Len;
+    bool_t bOk = TRUE;
+    uint8  i;
+
+    if (DriverBulb_bSetStripProfile == NULL)
+    {
+        return TRUE;
+    }
+
+    /* Profiles the driver can't drive fail the check and are refused,
+     * and checking one leaves the profile in use alone */
+    sBad.u16NumLeds = 0;
+    bOk &= !bBULB_CheckStripProfile(&sBad);
+    bOk &= !bBULB_SetStripProfile(&sBad);
+    sBad.u16NumLeds = 0xFFFF;
+    bOk &= !bBULB_SetStripProfile(&sBad);
+    sBad = sDefault;
+    sBad.u8Chip = E_STRIP_NUM_CHIPS;
+    bOk &= !bBULB_CheckStripProfile(&sBad);
+    bOk &= !bBULB_SetStripProfile(&sBad);
+    bOk &= bBULB_CheckStripProfile(&sApa102);
+    vBULB_GetStripProfile(&sRead);
+    bOk &= (memcmp(&sRead, &sDefault, sizeof(sRead)) == 0);
+
+    /* APA102: zero header, start byte and BGR per LED, one latch byte */
+    vBULB_SetOnOff(TRUE);
+    vHost_AhiSpiFlush();
+    bOk &= bBULB_SetStripProfile(&sApa102);
+    vHost_AhiSpiFlush();
+    vBULB_SetState(255, 255, 0, 0, 0);
+    vHost_AhiSpiFlush();
+    memset(au8Expect, 0, sizeof(au8Expect));
+    for (i = 0; i < 10; i++)
+    {
+        au8Expect[4 + i * 4]     = 0xFF;
+        au8Expect[4 + i * 4 + 3] = 255;
+    }
+    bOk &= bHost_CheckFrame("apa102", au8Expect, sizeof(au8Expect));
+    bOk &= (sHostAhi.u8SpiDivider == 2);
+
+    /* WS2801: plain RGB, each frame waits for the tick to leave a gap */
+    bOk &= bBULB_SetStripProfile(&sWs2801);
+    vHost_AhiSpiFlush();
+    vBULB_SetState(255, 0, 0, 255, 0);
+    bOk &= !bHost_AhiSpiPending(&u64DoneAt);
+    vBULB_Tick();
+    vHost_AhiSpiFlush();
+    memset(au8Expect, 0, sizeof(au8Expect));
+    for (i = 0; i < 5; i++)
+    {
+        au8Expect[i * 3 + 2] = 255;
+    }
+    bOk &= bHost_CheckFrame("ws2801", au8Expect, 5 * 3);
+
+    /* The last profile taken is the one saved */
+    bOk &= PDM_bDoesDataExist(PDM_ID_APP_STRIP_PROFILE, &u16Len) && u16Len == sizeof(tsStripProfile);
+
+    bOk &= bBULB_SetStripProfile(&sDefault);
+    vBULB_Tick();
+    vHost_AhiSpiFlush();
+    PDM_vDeleteDataRecord(PDM_ID_APP_STRIP_PROFILE);
+    return bOk;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckFrame
+ *
+ * DESCRIPTION:     Compares the last frame sent on the SPI bus
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckFrame(const char *pcName, const uint8 *pu8Expect, uint16 u16Len)
+{
+    uint16 i;
+
+    if (sHostAhi.u16SpiFrameLen != u16Len)
+    {
+        printf("  %s: frame of %u bytes, expected %u\n", pcName, sHostAhi.u16SpiFrameLen, u16Len);
+        return FALSE;
+    }
+    for (i = 0; i < u16Len; i++)
+    {
+        if (sHostAhi.au8SpiFrame[i] != pu8Expect[i])
+        {
+            printf("  %s: byte %u is %u, expected %u\n", pcName, i, sHostAhi.au8SpiFrame[i], pu8Expect[i]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckTickScheduler
+ *
+ * DESCRIPTION:     With nothing pending the tick must sleep to the next 1Hz
+ *                  stage; a wake must bring it forward to the next 10ms
+ *                  tick on the grid the timer was started on, and the 100ms
+ *                  and 1 second stages must fall on the ticks they did
+ *                  before the sleep. Every run is timed: once in the
+ *                  lateness histogram and once in the interval spread,
+ *                  whose longest is the sleep from the wake to the second.
+ *                  Either end of it may start late by up to the slack
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckTickScheduler(void)
+{
+    /* Start, 10ms stage only after the wake, then the next second */
+    const uint8  au8Expect[] = { APP_TICK_STAGE_10MS | APP_TICK_STAGE_100MS | APP_TICK_STAGES_ALWAYS,
+                                 APP_TICK_STAGE_10MS,
+                                 APP_TICK_STAGE_10MS | APP_TICK_STAGE_100MS | APP_TICK_STAGES_ALWAYS };
+    const uint32 au32ExpectMs[] = { 10, 350, 1010 };
+    tsAPP_TickStats sTick;
+    tsAPP_TickDiag  sDiag;
+    uint32 u32Histogram = 0;
+    bool_t bOk = TRUE;
+    uint32 i;
+
+    vHost_OsReset();
+    vHost_OsSetTimerTask(APP_TickTimer, vHost_CheckTickTask);
+    u32CheckRuns = 0;
+
+    vApp_Tick_Start();
+    vHost_OsAdvance(APP_TIME_MS(345));
+    vApp_Tick_Wake();
+    vHost_OsAdvance(APP_TIME_MS(1010) + HOST_TICK_SLACK - u64Host_OsTime());
+    OS_eStopSWTimer(APP_TickTimer);
+    vApp_Tick_GetStats(&sTick);
+    vApp_Tick_GetDiag(&sDiag);
+    for (i = 0; i < APP_TICK_LATE_BUCKETS; i++)
+    {
+        u32Histogram += sDiag.au32LateHistogram[i];
+    }
+    if ((sDiag.sLate.u32Count != u32CheckRuns) || (u32Histogram != u32CheckRuns) ||
+        (sDiag.sInterval.u32Max + HOST_TICK_SLACK < APP_TIME_MS(660)) || (sDiag.sInterval.u32Max > APP_TIME_MS(660) + HOST_TICK_SLACK))
+    {
+        printf("  %u runs timed, %u in the histogram, longest interval %u\n",
+               sDiag.sLate.u32Count, u32Histogram, sDiag.sInterval.u32Max);
+        bOk = FALSE;
+    }
+
+    if (u32CheckRuns != sizeof(au8Expect))
+    {
+        printf("  %u runs, expected %u\n", u32CheckRuns, (uint32)sizeof(au8Expect));
+        return FALSE;
+    }
+    for (i = 0; i < u32CheckRuns; i++)
+    {
+        if ((au8CheckStages[i] != au8Expect[i]) ||
+            (au64CheckAt[i] < APP_TIME_MS((uint64)au32ExpectMs[i])) ||
+            (au64CheckAt[i] > APP_TIME_MS((uint64)au32ExpectMs[i]) + HOST_TICK_SLACK))
+        {
+            printf("  run %u stages %02x at %llu ticks, expected %02x at %u ms\n", i, au8CheckStages[i],
+                   (unsigned long long)au64CheckAt[i], au8Expect[i], au32ExpectMs[i]);
+            bOk = FALSE;
+        }
+    }
+    if ((sTick.u32Ticks != 101) || (sTick.u32EarlyWakes != 1) || (sTick.u32LongestSleep != 100))
+    {
+        printf("  %u ticks, %u early wakes, longest sleep %u\n",
+               sTick.u32Ticks, sTick.u32EarlyWakes, sTick.u32LongestSleep);
+        bOk = FALSE;
+    }
+    return bOk;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckTickCatchUp
+ *
+ * DESCRIPTION:     Ten second transitions, one direct and one cluster
+ *                  driven, with the tick task held up for a couple of ticks
+ *                  every few runs. The late runs must make up the LI points
+ *                  and cluster updates they missed, so each transition
+ *                  lands in the first run on or after the tick it was
+ *                  timed for rather than slipping by the ticks lost. The
+ *                  level and colour updates of each cluster driven step
+ *                  must start LI once between them
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckTickCatchUp(void)
+{
+    const uint8 au8Start[4]  = { 1,   255, 0,   0   };
+    const uint8 au8Target[4] = { 254, 0,   0,   255 };
+    tsAPP_TickDiag sDiag;
+    uint32 u32Due;
+    bool_t bOk = TRUE;
+    uint8 i;
+
+    vBULB_SetOnOff(TRUE);
+    for (i = 0; i < 2; i++)
+    {
+        bClusterDriven = (i == 1);
+        vLI_StartTransition(au8Start[0], au8Start[1], au8Start[2], au8Start[3], 0, LI_CHANNEL_ALL, 0,
+                            LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        memcpy(sCluster.au8Start,   au8Start,  sizeof(au8Start));
+        memcpy(sCluster.au8Target,  au8Target, sizeof(au8Target));
+        memcpy(sCluster.au8Current, au8Start,  sizeof(au8Start));
+        if (bClusterDriven)
+        {
+            /* Step n falls on the nth 100ms stage, the first on tick 1 */
+            sCluster.u32Step = 0;
+            u32Due = (HOST_ZCL_STEPS - 1) * (100 / APP_TICK_TIME_MS) + 1;
+        }
+        else
+        {
+            sCluster.u32Step = HOST_ZCL_STEPS;
+            vLI_StartTransition(au8Target[0], au8Target[1], au8Target[2], au8Target[3], 0, LI_CHANNEL_ALL,
+                                HOST_FADE_TIME_MS, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+            u32Due = HOST_FADE_TIME_MS / APP_TICK_TIME_MS;
+        }
+
+        vHost_OsReset();
+        vHost_OsSetTimerTask(APP_TickTimer, vHost_CatchUpTickTask);
+        u32CatchUpRuns     = 0;
+        u32CatchUpBusyTick = 0;
+        u32CatchUpDoneTick = 0;
+        u32Commits         = 0;
+        (void)bApp_Tick_CommitLight();
+        vApp_Tick_Start();
+        vHost_OsAdvance(APP_TIME_MS((uint64)HOST_FADE_TIME_MS + 500));
+        OS_eStopSWTimer(APP_TickTimer);
+        vApp_Tick_GetDiag(&sDiag);
+
+        if ((u32CatchUpBusyTick >= u32Due) || (u32CatchUpDoneTick < u32Due) ||
+            (sDiag.u32MadeUp == 0) || (sDiag.u32Dropped != 0))
+        {
+            printf("  %s: moving on tick %u, landed on %u, due on %u, %u runs made up, %u dropped\n",
+                   bClusterDriven ? "cluster" : "direct", u32CatchUpBusyTick, u32CatchUpDoneTick, u32Due,
+                   sDiag.u32MadeUp, sDiag.u32Dropped);
+            bOk = FALSE;
+        }
+        if (bClusterDriven &&
+            ((u32Commits > HOST_ZCL_STEPS) || (u32Commits + sDiag.u32Coalesced != 2 * HOST_ZCL_STEPS)))
+        {
+            printf("  cluster: %u updates started LI %u times, %u coalesced\n",
+                   2 * HOST_ZCL_STEPS, u32Commits, sDiag.u32Coalesced);
+            bOk = FALSE;
+        }
+    }
+    return bOk;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_CheckTickTask
+ *
+ * DESCRIPTION:     Tick task for the scheduler check, with no work pending
+ *
+ ****************************************************************************/
+PRIVATE void vHost_CheckTickTask(void)
+{
+    uint8 u8Stages = u8App_Tick_Due();
+
+    if (u32CheckRuns < sizeof(au8CheckStages))
+    {
+        au8CheckStages[u32CheckRuns] = u8Stages;
+        au64CheckAt[u32CheckRuns]    = u64Host_OsTime();
+        u32CheckRuns++;
+    }
+    vApp_Tick_Sleep(0);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_CatchUpTickTask
+ *
+ * DESCRIPTION:     Tick task for the catch up check: the cluster updates
+ *                  and LI points due, then on every HOST_STALL_EVERY runs
+ *                  the CPU held as a long callback would hold it
+ *
+ ****************************************************************************/
+PRIVATE void vHost_CatchUpTickTask(void)
+{
+    tsAPP_TickStats sTick;
+    uint32 u32Runs;
+    uint8 u8Stages;
+    uint8 u8Want = 0;
+
+    u8Stages = u8App_Tick_Due();
+    if ((u8Stages & APP_TICK_STAGE_100MS) && bClusterDriven)
+    {
+        for (u32Runs = u32App_Tick_Runs(APP_TICK_STAGE_100MS); u32Runs > 0; u32Runs--)
+        {
+            vHost_ClusterUpdate100mS();
+        }
+    }
+    if (bApp_Tick_CommitLight())
+    {
+        vHost_CommitLight();
+    }
+    vLI_CreatePoints(u32App_Tick_Runs(APP_TICK_STAGE_10MS));
+
+    vApp_Tick_GetStats(&sTick);
+    if (bClusterDriven ? (sCluster.u32Step < HOST_ZCL_STEPS) : bLI_Busy())
+    {
+        u32CatchUpBusyTick = sTick.u32Ticks;
+    }
+    else if (u32CatchUpDoneTick == 0)
+    {
+        u32CatchUpDoneTick = sTick.u32Ticks;
+    }
+
+    if ((++u32CatchUpRuns % HOST_STALL_EVERY) == 0)
+    {
+        vHost_OsStall(HOST_STALL);
+    }
+
+    if (bLI_Busy())
+    {
+        u8Want |= APP_TICK_STAGE_10MS;
+    }
+    if (bClusterDriven && sCluster.u32Step < HOST_ZCL_STEPS)
+    {
+        u8Want |= APP_TICK_STAGE_100MS;
+    }
+    vApp_Tick_Sleep(u8Want);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunFade
+ *
+ * DESCRIPTION:     Ten second level and colour transition, delivered to LI
+ *                  the way the ZCL delivers it: one new point every 100ms
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunFade(void)
+{
+    const uint8 au8Start[4]  = { 1,   255, 0,   0   };
+    const uint8 au8Target[4] = { 254, 0,   0,   255 };
+
+    memcpy(sCluster.au8Start,   au8Start,  sizeof(au8Start));
+    memcpy(sCluster.au8Target,  au8Target, sizeof(au8Target));
+    memcpy(sCluster.au8Current, au8Start,  sizeof(au8Start));
+    sCluster.u32Step = 0;
+
+    vBULB_SetOnOff(TRUE);
+    vLI_Start(sCluster.au8Current[0], sCluster.au8Current[1], sCluster.au8Current[2], sCluster.au8Current[3], 0);
+
+    bClusterDriven = TRUE;
+    vHost_Run(HOST_FADE_TIME_MS);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunDirectFade
+ *
+ * DESCRIPTION:     The same transition handed to LI in one go
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunDirectFade(void)
+{
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(1, 255, 0, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(254, 0, 0, 255, 0, LI_CHANNEL_ALL, HOST_FADE_TIME_MS, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+    bClusterDriven = FALSE;
+    vHost_Run(HOST_FADE_TIME_MS);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunSunrise
+ *
+ * DESCRIPTION:     Thirty minute sunrise scene rendered by LI alone
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunSunrise(void)
+{
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(1, 255, 40, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(254, 255, 220, 180, 0, LI_CHANNEL_ALL, HOST_SUNRISE_TIME_MS, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+    bClusterDriven = FALSE;
+    vHost_Run(HOST_SUNRISE_TIME_MS);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunLowFade
+ *
+ * DESCRIPTION:     Slow fade across the bottom of the dimming range, where
+ *                  each 8 bit step is visible without dithering
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunLowFade(void)
+{
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(1, 255, 255, 255, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(40, 255, 255, 255, 0, LI_CHANNEL_ALL, 60000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+    bClusterDriven = FALSE;
+    vHost_Run(60000);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunHold
+ *
+ * DESCRIPTION:     Steady low level between two PWM steps; the only work
+ *                  per tick is the driver's dither
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunHold(void)
+{
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(20, 255, 200, 100, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+
+    bClusterDriven = FALSE;
+    vHost_Run(HOST_FADE_TIME_MS);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_RunIdle
+ *
+ * DESCRIPTION:     Steady full white, on whole PWM steps, so nothing is
+ *                  left to dither and the tick only wakes for the 1Hz
+ *                  stages. The flux balance of a tunable white light
+ *                  leaves its cool LED between steps, so it keeps ticking
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunIdle(void)
+{
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(254, 255, 255, 255, WARMCOOL_MIRED_COOL, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+
+    bClusterDriven = FALSE;
+    vHost_Run(60000);
+}
+
+#ifdef LI_SEGMENTS
+/****************************************************************************
+ *
+ * NAME:            vHost_RunSegments
+ *
+ * DESCRIPTION:     Whole light fade with each segment of a strip fading to
+ *                  its own colour over it; only the changed LEDs are packed
+ *
+ ****************************************************************************/
+PRIVATE void vHost_RunSegments(void)
+{
+    uint8 u8Segment;
+
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(254, 255, 255, 255, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    for (u8Segment = 0; u8Segment < LI_SEGMENTS; u8Segment++)
+    {
+        vLI_StartSegmentTransition(u8Segment, 64 * u8Segment, 255 - 64 * u8Segment, 0,
+                                   HOST_FADE_TIME_MS / (u8Segment + 1), LI_TICK_RATE_HZ);
+    }
+
+    bClusterDriven = FALSE;
+    vHost_Run(HOST_FADE_TIME_MS);
+}
+#endif
+
+/****************************************************************************
+ *
+ * NAME:            vHost_Run
+ *
+ * DESCRIPTION:     Runs the tick task for u32TimeMs of simulated time
+ *
+ ****************************************************************************/
+PRIVATE void vHost_Run(uint32 u32TimeMs)
+{
+    vHost_OsSetTimerTask(APP_TickTimer, vHost_TickTask);
+    vApp_Tick_Start();
+    vHost_OsAdvance(APP_TIME_MS((uint64)u32TimeMs) + HOST_TICK_SLACK);
+    OS_eStopSWTimer(APP_TickTimer);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_TickTask
+ *
+ * DESCRIPTION:     Mirrors Tick_Task: the cluster updates on the 100ms
+ *                  stage and LI started once for them, then an LI point,
+ *                  the hardware write rate sampled on the 1 second stage,
+ *                  each part timed by the tick timer, and the timer left
+ *                  armed for the stages the pending work needs
+ *
+ ****************************************************************************/
+PRIVATE void vHost_TickTask(void)
+{
+    uint64 u64Start;
+    uint32 u32Start;
+    uint32 u32Runs;
+    uint8 u8Stages;
+    uint8 u8Want = 0;
+
+    u64Start = u64Host_CpuNs();
+    u8Stages = u8App_Tick_Due();
+    u32Start = u32AHI_TickTimerRead();
+    if (((u8Stages & APP_TICK_STAGE_100MS) && bClusterDriven) || bApp_Tick_LightPending())
+    {
+        if ((u8Stages & APP_TICK_STAGE_100MS) && bClusterDriven)
+        {
+            for (u32Runs = u32App_Tick_Runs(APP_TICK_STAGE_100MS); u32Runs > 0; u32Runs--)
+            {
+                vHost_ClusterUpdate100mS();
+            }
+        }
+        if (bApp_Tick_CommitLight())
+        {
+            vHost_CommitLight();
+        }
+        u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_UPDATE_100MS, u32Start);
+    }
+    vLI_CreatePoints(u32App_Tick_Runs(APP_TICK_STAGE_10MS));
+    u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_LI, u32Start);
+    vBULB_Tick();
+    u32Start = u32App_Tick_Timed(E_APP_TICK_TIMED_BULB, u32Start);
+
+    if (u8Stages & APP_TICK_STAGE_1SEC)
+    {
+        vBULB_Tick1Sec();
+        sStats.u32PeakWritesPerSec = MAX(sStats.u32PeakWritesPerSec, u32BULB_GetWritesPerSecond());
+        u32App_Tick_Timed(E_APP_TICK_TIMED_ZCL_TIMER, u32Start);
+    }
+
+    if (bLI_Busy() || bBULB_TickPending())
+    {
+        u8Want |= APP_TICK_STAGE_10MS;
+    }
+    if (bClusterDriven && sCluster.u32Step < HOST_ZCL_STEPS)
+    {
+        u8Want |= APP_TICK_STAGE_100MS;
+    }
+    vApp_Tick_Sleep(u8Want);
+    sStats.u64CpuNs += u64Host_CpuNs() - u64Start;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_ClusterUpdate100mS
+ *
+ * DESCRIPTION:     Steps the stand-in cluster attributes, which the level
+ *                  and the colour cluster each report
+ *
+ ****************************************************************************/
+PRIVATE void vHost_ClusterUpdate100mS(void)
+{
+    uint8 i;
+
+    if (sCluster.u32Step < HOST_ZCL_STEPS)
+    {
+        sCluster.u32Step++;
+        for (i = 0; i < 4; i++)
+        {
+            int32 i32Span = (int32)sCluster.au8Target[i] - (int32)sCluster.au8Start[i];
+            sCluster.au8Current[i] = (uint8)(sCluster.au8Start[i] + (i32Span * (int32)sCluster.u32Step) / HOST_ZCL_STEPS);
+        }
+        vApp_Tick_LightChanged();
+        vApp_Tick_LightChanged();
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_CommitLight
+ *
+ * DESCRIPTION:     Hands the stand-in cluster values to LI once for the
+ *                  updates since the last tick, as vCommitLightState does
+ *
+ ****************************************************************************/
+PRIVATE void vHost_CommitLight(void)
+{
+    u32Commits++;
+    vLI_Start(sCluster.au8Current[0], sCluster.au8Current[1], sCluster.au8Current[2], sCluster.au8Current[3], 0);
+}
+
+/****************************************************************************
+ *
+ * NAME:            u32Host_Report
+ *
+ * DESCRIPTION:     Prints one result line for the scenario just run
+ *
+ * RETURNS:         PWM periods cut short by a timer restart
+ *
+ ****************************************************************************/
+PRIVATE uint32 u32Host_Report(const char *pcName)
+{
+    uint32 u32PwmWrites = 0;
+    uint32 u32Runts = 0;
+    uint32 u32Frames;
+    uint32 u32Wakes;
+    uint64 u64FrameNs;
+    tsAPP_TickStats sTick;
+    uint8 i;
+
+    /* The CPU wakes for the tick task and for each PWM period interrupt */
+    vApp_Tick_GetStats(&sTick);
+    u32Wakes = sTick.u32Wakes + sHostAhi.u32TimerInts;
+
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        u32PwmWrites += sHostAhi.asTimer[i].u32Starts;
+        u32Runts     += sHostAhi.asTimer[i].u32Runts;
+    }
+
+    /* A frame is one hardware update. Its CPU cost is the tick time, the
+     * SPI and timer interrupt time and, on the target, any time spun
+     * waiting on SPI */
+    u32Frames  = (DriverBulb_u32GetOutputCount ? DriverBulb_u32GetOutputCount() : 0) - sStats.u32OutputCountAtStart;
+    u64FrameNs = sStats.u64CpuNs + sHostAhi.u64SpiIsrNs + sHostAhi.u64TimerIsrNs + sHostAhi.u64SpiSpinNs;
+
+    printf("%-28s %8u %8u %10llu %10u %6u %10u %12llu %8llu %8u %8u %10.1f\n",
+           pcName,
+           sTick.u32Ticks,
+           u32Wakes,
+           (unsigned long long)((sStats.u64CpuNs + sHostAhi.u64TimerIsrNs) / MAX(1, u32Wakes)),
+           u32PwmWrites,
+           u32Runts,
+           sHostAhi.u32SpiTransfers,
+           (unsigned long long)(sHostAhi.u64SpiWireNs / 1000000ULL),
+           (unsigned long long)(sHostAhi.u64SpiSpinNs / 1000000ULL),
+           sStats.u32PeakWritesPerSec,
+           (u32Frames * LI_TICK_RATE_HZ) / MAX(1, sTick.u32Ticks),
+           (double)u64FrameNs / 1000.0 / MAX(1, u32Frames));
+    return u32Runts;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_ReportTiming
+ *
+ * DESCRIPTION:     Prints how late the tick task ran in a scenario and what
+ *                  its parts took, as the diagnostics cluster reports them.
+ *                  The host tick timer runs on during a task by the task's
+ *                  CPU time, so these are host times
+ *
+ ****************************************************************************/
+PRIVATE void vHost_ReportTiming(const char *pcName, const tsAPP_TickDiag *psDiag)
+{
+    const tsAPP_TickTiming *psUpdate = &psDiag->asTimed[E_APP_TICK_TIMED_UPDATE_100MS];
+    const tsAPP_TickTiming *psLi     = &psDiag->asTimed[E_APP_TICK_TIMED_LI];
+    const tsAPP_TickTiming *psBulb   = &psDiag->asTimed[E_APP_TICK_TIMED_BULB];
+
+    printf("%-28s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n",
+           pcName,
+           (double)psDiag->sLate.u32Max / APP_TICK_COUNTS_PER_US,
+           (double)psDiag->sLate.u64Total / APP_TICK_COUNTS_PER_US / MAX(1, psDiag->sLate.u32Count),
+           (double)psUpdate->u32Max / APP_TICK_COUNTS_PER_US,
+           (double)psUpdate->u64Total / APP_TICK_COUNTS_PER_US / MAX(1, psUpdate->u32Count),
+           (double)psLi->u32Max / APP_TICK_COUNTS_PER_US,
+           (double)psLi->u64Total / APP_TICK_COUNTS_PER_US / MAX(1, psLi->u32Count),
+           (double)psBulb->u32Max / APP_TICK_COUNTS_PER_US,
+           (double)psBulb->u64Total / APP_TICK_COUNTS_PER_US / MAX(1, psBulb->u32Count));
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiPacked
+ *
+ * DESCRIPTION:     Runs transitions through LI alongside the scalar
+ *                  reference, one point per tick. Every point must be
+ *                  within the rounding of the packed step, one 8.7 unit
+ *                  plus one per 2^15 points so far, of the exact one and
+ *                  the last must land on the target.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiPacked(void)
+{
+    /* Start and target level, red, green, blue and the time between */
+    const struct { uint8 au8Start[4]; uint8 au8Target[4]; uint32 u32TimeMs; } asCase[] =
+    {
+        { { 1,   255, 0,   0   }, { 254, 0,   0,   255 }, HOST_FADE_TIME_MS },
+        { { 1,   255, 40,  0   }, { 254, 255, 220, 180 }, HOST_SUNRISE_TIME_MS },
+        { { 254, 0,   128, 255 }, { 1,   255, 127, 0   }, 60000 },
+        { { 40,  10,  200, 30  }, { 41,  11,  199, 30  }, 600000 },
+        { { 0,   0,   0,   0   }, { 255, 255, 255, 255 }, 100 },
+    };
+    uint32 au32Out[5];
+    uint32 u32Points;
+    uint32 u32Bound;
+    uint32 i, j, k;
+
+    for (i = 0; i < sizeof(asCase) / sizeof(asCase[0]); i++)
+    {
+        const uint8 *pu8Start  = asCase[i].au8Start;
+        const uint8 *pu8Target = asCase[i].au8Target;
+
+        vLI_StartTransition(pu8Start[0], pu8Start[1], pu8Start[2], pu8Start[3], 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        vHost_LiRefStart(pu8Start, 1);
+        vHost_LiRefStep(1);
+
+        u32Points = (asCase[i].u32TimeMs * LI_TICK_RATE_HZ) / 1000;
+        vLI_StartTransition(pu8Target[0], pu8Target[1], pu8Target[2], pu8Target[3], 0, LI_CHANNEL_ALL,
+                            asCase[i].u32TimeMs, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vHost_LiRefStart(pu8Target, u32Points);
+
+        for (j = 1; j <= u32Points; j++)
+        {
+            vLI_CreatePoints(1);
+            vHost_LiRefStep(u32Points);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+
+            u32Bound = 1 + (j >> 15);
+            for (k = 0; k < HOST_LI_CHANNELS; k++)
+            {
+                uint32 u32Exact = asLiRef[k].u32Current;
+
+                if ((au32Out[k] < HOST_LI_TO_12BIT(u32Exact - MIN(u32Exact, u32Bound))) ||
+                    (au32Out[k] > HOST_LI_TO_12BIT(u32Exact + u32Bound)) ||
+                    ((j == u32Points) && (au32Out[k] != HOST_LI_TO_12BIT(u32Exact))))
+                {
+                    printf("  case %u point %u channel %u: %u, exact %u\n",
+                           i, j, k, au32Out[k], HOST_LI_TO_12BIT(u32Exact));
+                    return FALSE;
+                }
+            }
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiCurves
+ *
+ * DESCRIPTION:     Runs a rising level and, with colour, a falling red
+ *                  through each curve. Both must move one way only and land
+ *                  exactly, the polynomial curves must stay within their
+ *                  16 piece chords of the exact curve, and at the half way
+ *                  point each curve must lead or lag a straight line as its
+ *                  shape says. The exponential curve falls fastest first.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiCurves(void)
+{
+    /* Level and red in 12 bits at the start and end */
+    const uint32 u32LevelStart = HOST_LI_TO_12BIT(1 << HOST_LI_SCALE);
+    const uint32 u32LevelEnd   = HOST_LI_TO_12BIT(254 << HOST_LI_SCALE);
+    const uint32 u32RedStart   = HOST_LI_TO_12BIT(255 << HOST_LI_SCALE);
+    const uint32 u32Points     = (HOST_FADE_TIME_MS * LI_TICK_RATE_HZ) / 1000;
+    const uint32 u32Span       = u32LevelEnd - u32LevelStart;
+    uint32 au32Out[5];
+    uint32 au32Last[2];
+    uint32 au32Mid[2] = { 0, 0 };
+    uint32 u32Curve;
+    uint32 j;
+
+    for (u32Curve = E_LI_CURVE_LINEAR; u32Curve < E_LI_CURVE_NUM; u32Curve++)
+    {
+        vLI_StartTransition(1, 255, 0, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        vLI_StartTransition(254, 0, 0, 255, 0, LI_CHANNEL_ALL, HOST_FADE_TIME_MS, LI_TICK_RATE_HZ, (teLI_Curve)u32Curve);
+
+        au32Last[0] = u32LevelStart;
+        au32Last[1] = u32RedStart;
+        for (j = 1; j <= u32Points; j++)
+        {
+            double dT = (double)j / u32Points;
+            double dProgress = -1.0;
+            double dError;
+
+            vLI_CreatePoints(1);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+
+            switch (u32Curve)
+            {
+            case E_LI_CURVE_LINEAR:   dProgress = dT;                           break;
+            case E_LI_CURVE_EASE_IN:  dProgress = dT * dT;                      break;
+            case E_LI_CURVE_EASE_OUT: dProgress = 1.0 - (1.0 - dT) * (1.0 - dT); break;
+            case E_LI_CURVE_S_CURVE:  dProgress = dT * dT * (3.0 - 2.0 * dT);   break;
+            default:                                                            break;
+            }
+            dError = (double)au32Out[0] - u32LevelStart - u32Span * dProgress;
+
+            if ((au32Out[0] < au32Last[0]) ||
+#ifdef LI_RGB
+                (au32Out[1] > au32Last[1]) ||
+#endif
+                ((dProgress >= 0.0) &&
+                 (MAX(dError, -dError) > (u32Span / 256.0) + 2.0)))
+            {
+                printf("  curve %u point %u: level %u red %u\n", u32Curve, j, au32Out[0], au32Out[1]);
+                return FALSE;
+            }
+            au32Last[0] = au32Out[0];
+            au32Last[1] = au32Out[1];
+            if (j == u32Points / 2)
+            {
+                if (u32Curve == E_LI_CURVE_LINEAR)
+                {
+                    au32Mid[0] = au32Out[0];
+                    au32Mid[1] = au32Out[1];
+                }
+                else if ((((u32Curve == E_LI_CURVE_EASE_IN) || (u32Curve == E_LI_CURVE_EXPONENTIAL)) &&
+                          (au32Out[0] >= au32Mid[0])) ||
+                         ((u32Curve == E_LI_CURVE_EASE_OUT) && (au32Out[0] <= au32Mid[0])) ||
+                         ((u32Curve == E_LI_CURVE_S_CURVE) && (abs((int)au32Out[0] - (int)au32Mid[0]) > 2))
+#ifdef LI_RGB
+                         || ((u32Curve == E_LI_CURVE_EXPONENTIAL) && (au32Out[1] >= au32Mid[1]))
+#endif
+                        )
+                {
+                    printf("  curve %u half way: level %u red %u, linear %u %u\n",
+                           u32Curve, au32Out[0], au32Out[1], au32Mid[0], au32Mid[1]);
+                    return FALSE;
+                }
+            }
+        }
+        if ((au32Out[0] != u32LevelEnd)
+#ifdef LI_RGB
+            || (au32Out[1] != 0)
+#endif
+           )
+        {
+            printf("  curve %u ends at level %u red %u\n", u32Curve, au32Out[0], au32Out[1]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiChannels
+ *
+ * DESCRIPTION:     Runs a 5s level transition alone, then again with a 2s
+ *                  colour transition started part way through it and the
+ *                  cluster updates that come with one, which carry a stale
+ *                  level and colour. The level must take the same path
+ *                  both times, and the colour land where it was sent.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiChannels(void)
+{
+    const uint32 u32Points = (5000 * LI_TICK_RATE_HZ) / 1000;
+    const uint32 u32ColourAt = 100;
+    const uint32 u32ColourPoints = (2000 * LI_TICK_RATE_HZ) / 1000;
+    uint32 au32Level[(5000 * LI_TICK_RATE_HZ) / 1000];
+    uint32 au32Out[5];
+    uint32 u32Run;
+    uint32 j;
+
+    for (u32Run = 0; u32Run < 2; u32Run++)
+    {
+        vLI_StartTransition(1, 255, 0, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        vLI_StartTransition(254, 0, 0, 0, 0, LI_CHANNEL_LEVEL, 5000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+        for (j = 0; j < u32Points; j++)
+        {
+            if (u32Run == 1)
+            {
+                if (j == u32ColourAt)
+                {
+                    vLI_StartTransition(0, 0, 0, 255, 0, LI_CHANNEL_COLOUR, 2000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+                }
+                else if ((j > u32ColourAt) && (j < u32ColourAt + u32ColourPoints) && ((j % 10) == 0))
+                {
+                    /* A 100ms cluster update, still holding the old values */
+                    vLI_Start(77, 9, 9, 9, 0);
+                }
+            }
+            vLI_CreatePoints(1);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+
+            if (u32Run == 0)
+            {
+                au32Level[j] = au32Out[0];
+            }
+            else if (au32Out[0] != au32Level[j])
+            {
+                printf("  point %u: level %u, alone %u\n", j, au32Out[0], au32Level[j]);
+                return FALSE;
+            }
+        }
+    }
+
+#ifdef LI_RGB
+    if ((au32Out[1] != 0) || (au32Out[2] != 0) || (au32Out[3] != HOST_LI_TO_12BIT(255 << HOST_LI_SCALE)))
+    {
+        printf("  colour ends at %u %u %u\n", au32Out[1], au32Out[2], au32Out[3]);
+        return FALSE;
+    }
+#endif
+    return (au32Out[0] == HOST_LI_TO_12BIT(254 << HOST_LI_SCALE));
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiRates
+ *
+ * DESCRIPTION:     Runs a 5s level transition at LI_TICK_RATE_HZ alone,
+ *                  then again after a 1s colour transition at 10Hz has
+ *                  been started. The level must take the same path both
+ *                  times, and the colour keep its own rate: a new point
+ *                  every 10 ticks, landing on the 100th.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiRates(void)
+{
+    const uint32 u32Points = (5000 * LI_TICK_RATE_HZ) / 1000;
+    uint32 au32Level[(5000 * LI_TICK_RATE_HZ) / 1000];
+    uint32 au32Out[5];
+#ifdef LI_RGB
+    const uint32 u32ColourTicks = LI_TICK_RATE_HZ / 10;
+    uint32 u32Blue = 0;
+#endif
+    uint32 u32Run;
+    uint32 j;
+
+    for (u32Run = 0; u32Run < 2; u32Run++)
+    {
+        vLI_StartTransition(1, 0, 0, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        if (u32Run == 1)
+        {
+            vLI_StartTransition(0, 0, 0, 255, 0, LI_CHANNEL_COLOUR, 1000, 10, E_LI_CURVE_LINEAR);
+        }
+        vLI_StartTransition(254, 0, 0, 0, 0, LI_CHANNEL_LEVEL, 5000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+        for (j = 0; j < u32Points; j++)
+        {
+            vLI_CreatePoints(1);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+
+            if (u32Run == 0)
+            {
+                au32Level[j] = au32Out[0];
+                continue;
+            }
+            if (au32Out[0] != au32Level[j])
+            {
+                printf("  tick %u: level %u, alone %u\n", j + 1, au32Out[0], au32Level[j]);
+                return FALSE;
+            }
+#ifdef LI_RGB
+            if ((j < 10 * u32ColourTicks) && ((au32Out[3] != u32Blue) != (((j + 1) % u32ColourTicks) == 0)))
+            {
+                printf("  tick %u: blue %u after %u\n", j + 1, au32Out[3], u32Blue);
+                return FALSE;
+            }
+            if ((j + 1 < 10 * u32ColourTicks) == (au32Out[3] == HOST_LI_TO_12BIT(255 << HOST_LI_SCALE)))
+            {
+                printf("  tick %u: blue %u\n", j + 1, au32Out[3]);
+                return FALSE;
+            }
+            u32Blue = au32Out[3];
+#endif
+        }
+    }
+    return (au32Out[0] == HOST_LI_TO_12BIT(254 << HOST_LI_SCALE));
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiCancel
+ *
+ * DESCRIPTION:     A 5s level transition with a colour transition running
+ *                  alongside, cut short as vCancelLevelTransition does for
+ *                  another level command. The level must stop where it is
+ *                  and follow the next cluster update, while the colour
+ *                  carries on to where it was sent.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiCancel(void)
+{
+    uint32 au32Out[5];
+    uint32 au32Stopped[5];
+    uint32 j;
+
+    vLI_StartTransition(1, 255, 0, 0, 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(254, 0, 0, 0, 0, LI_CHANNEL_LEVEL, 5000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_StartTransition(0, 0, 0, 255, 0, LI_CHANNEL_COLOUR, 2000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    for (j = 0; j < 100; j++)
+    {
+        vLI_CreatePoints(1);
+    }
+
+    vLI_StopChannels(LI_CHANNEL_LEVEL);
+    vLI_GetCurrentValues(&au32Stopped[0], &au32Stopped[1], &au32Stopped[2], &au32Stopped[3], &au32Stopped[4]);
+    vLI_CreatePoints(1);
+    vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+    if ((au32Out[0] != au32Stopped[0]) || bLI_TransitionActive(LI_CHANNEL_LEVEL)
+#ifdef LI_RGB
+        || !bLI_TransitionActive(LI_CHANNEL_COLOUR)
+#endif
+       )
+    {
+        printf("  level %u after the cancel, %u when cancelled\n", au32Out[0], au32Stopped[0]);
+        return FALSE;
+    }
+
+    /* The cluster update the command brings, with the colour it still holds */
+    vLI_Start(128, 255, 0, 0, 0);
+    for (j = 0; j < 2000; j++)
+    {
+        vLI_CreatePoints(1);
+    }
+    vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+    if ((au32Out[0] != HOST_LI_TO_12BIT(128 << HOST_LI_SCALE))
+#ifdef LI_RGB
+        || (au32Out[1] != 0) || (au32Out[3] != HOST_LI_TO_12BIT(255 << HOST_LI_SCALE))
+#endif
+       )
+    {
+        printf("  ends at level %u red %u blue %u\n", au32Out[0], au32Out[1], au32Out[3]);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckLiHsv
+ *
+ * DESCRIPTION:     Colour transitions interpolated in HSV. Red to green
+ *                  must stay at full brightness and pass through yellow,
+ *                  magenta to red take the short way round without any
+ *                  green, and white to blue only take the other primaries
+ *                  away. Each must land on exactly the colour it was sent.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckLiHsv(void)
+{
+#ifdef LI_RGB
+    const uint32 u32Full   = HOST_LI_TO_12BIT(255 << HOST_LI_SCALE);
+    const uint32 u32Points = (2000 * LI_TICK_RATE_HZ) / 1000;
+    const uint8 au8Pairs[3][2][3] =
+    {
+        { { 255, 0,   0   }, { 0,   255, 0   } },
+        { { 255, 0,   255 }, { 255, 0,   0   } },
+        { { 255, 255, 255 }, { 0,   0,   255 } },
+    };
+    uint32 au32Out[5];
+    uint32 au32Last[3];
+    uint32 u32Pair;
+    uint32 j;
+    bool_t bOk = TRUE;
+
+    vLI_SetColourSpace(E_LI_COLOUR_HSV);
+    for (u32Pair = 0; bOk && (u32Pair < 3); u32Pair++)
+    {
+        const uint8 *pu8From = au8Pairs[u32Pair][0];
+        const uint8 *pu8To   = au8Pairs[u32Pair][1];
+
+        vLI_StartTransition(254, pu8From[0], pu8From[1], pu8From[2], 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+        vLI_CreatePoints(1);
+        vLI_GetCurrentValues(&au32Out[0], &au32Last[0], &au32Last[1], &au32Last[2], &au32Out[4]);
+        vLI_StartTransition(254, pu8To[0], pu8To[1], pu8To[2], 0, LI_CHANNEL_COLOUR, 2000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+        for (j = 1; bOk && (j <= u32Points); j++)
+        {
+            vLI_CreatePoints(1);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+
+            switch (u32Pair)
+            {
+            case 0:
+                bOk = (MAX(au32Out[1], au32Out[2]) + 16 >= u32Full) && (au32Out[3] <= 16) &&
+                      (au32Out[1] <= au32Last[0]) && (au32Out[2] >= au32Last[1]) &&
+                      ((j != u32Points / 2) || (abs((int)au32Out[1] - (int)au32Out[2]) <= 32));
+                break;
+            case 1:
+                bOk = (au32Out[1] + 16 >= u32Full) && (au32Out[2] <= 16) && (au32Out[3] <= au32Last[2]);
+                break;
+            default:
+                bOk = (au32Out[1] <= au32Last[0]) && (au32Out[2] <= au32Last[1]) && (au32Out[3] + 16 >= u32Full);
+                break;
+            }
+            if (bOk == FALSE)
+            {
+                printf("  pair %u point %u: %u %u %u\n", u32Pair, j, au32Out[1], au32Out[2], au32Out[3]);
+            }
+            memcpy(au32Last, &au32Out[1], sizeof(au32Last));
+        }
+        if (bOk &&
+            ((au32Out[1] != HOST_LI_TO_12BIT(pu8To[0] << HOST_LI_SCALE)) ||
+             (au32Out[2] != HOST_LI_TO_12BIT(pu8To[1] << HOST_LI_SCALE)) ||
+             (au32Out[3] != HOST_LI_TO_12BIT(pu8To[2] << HOST_LI_SCALE))))
+        {
+            printf("  pair %u ends at %u %u %u\n", u32Pair, au32Out[1], au32Out[2], au32Out[3]);
+            bOk = FALSE;
+        }
+    }
+    vLI_SetColourSpace(E_LI_COLOUR_RGB);
+    return bOk;
+#else
+    return TRUE;
+#endif
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_BenchLi
+ *
+ * DESCRIPTION:     Times LI alone over a transition with a point due on
+ *                  every tick, packed as built and with the scalar
+ *                  reference. Both include the same driver update, and the
+ *                  reference the idle pass of a stopped LI so that both pay
+ *                  the same per-tick overhead. The per-tick clock reads
+ *                  cost more than LI itself, so these are the figures to
+ *                  compare LI changes by
+ *
+ ****************************************************************************/
+PRIVATE void vHost_BenchLi(void)
+{
+    const uint8 au8Start[4]  = { 1,   255, 0, 0   };
+    const uint8 au8Target[4] = { 254, 0,   0, 255 };
+    uint64 u64Packed;
+    uint64 u64Scalar;
+    uint64 u64Start;
+    uint32 i;
+
+    vHost_AhiReset();
+    vBULB_SetOnOff(TRUE);
+    vLI_StartTransition(au8Start[0], au8Start[1], au8Start[2], au8Start[3], 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(au8Target[0], au8Target[1], au8Target[2], au8Target[3], 0, LI_CHANNEL_ALL,
+                        HOST_LI_BENCH_POINTS * (1000 / LI_TICK_RATE_HZ), LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_LI_BENCH_POINTS; i++)
+    {
+        vLI_CreatePoints(1);
+    }
+    u64Packed = u64Host_CpuNs() - u64Start;
+
+    vHost_LiRefStart(au8Start, 1);
+    vHost_LiRefStep(1);
+    vHost_LiRefStart(au8Target, HOST_LI_BENCH_POINTS);
+    vLI_Stop();
+
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_LI_BENCH_POINTS; i++)
+    {
+        vLI_CreatePoints(1);
+        vHost_LiRefStep(HOST_LI_BENCH_POINTS);
+        vHost_LiRefUpdateDriver();
+    }
+    u64Scalar = u64Host_CpuNs() - u64Start;
+
+    printf("bench LI point packed %.1f ns, scalar %.1f ns",
+           (double)u64Packed / HOST_LI_BENCH_POINTS,
+           (double)u64Scalar / HOST_LI_BENCH_POINTS);
+
+#ifdef LI_RGB
+    /* The same transition with the colour turned through HSV */
+    vLI_SetColourSpace(E_LI_COLOUR_HSV);
+    vLI_StartTransition(au8Start[0], au8Start[1], au8Start[2], au8Start[3], 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+    vLI_CreatePoints(1);
+    vLI_StartTransition(au8Target[0], au8Target[1], au8Target[2], au8Target[3], 0, LI_CHANNEL_ALL,
+                        HOST_LI_BENCH_POINTS * (1000 / LI_TICK_RATE_HZ), LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_LI_BENCH_POINTS; i++)
+    {
+        vLI_CreatePoints(1);
+    }
+    u64Packed = u64Host_CpuNs() - u64Start;
+    vLI_Stop();
+    vLI_SetColourSpace(E_LI_COLOUR_RGB);
+
+    printf(", hsv %.1f ns", (double)u64Packed / HOST_LI_BENCH_POINTS);
+#endif
+    printf("\n");
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_CompareLiColour
+ *
+ * DESCRIPTION:     How far colour transitions sag part way, in RGB and in
+ *                  HSV. The brightness of a point is taken as its largest
+ *                  primary and its saturation as the spread of its primaries
+ *                  over that; the figure for each is the worst shortfall,
+ *                  in percent, from a straight line between the two ends.
+ *
+ ****************************************************************************/
+PRIVATE void vHost_CompareLiColour(void)
+{
+#ifdef LI_RGB
+    const uint32 u32Points = (2000 * LI_TICK_RATE_HZ) / 1000;
+    const struct
+    {
+        const char *pcName;
+        uint8 au8From[3];
+        uint8 au8To[3];
+    } asPairs[] =
+    {
+        { "red-green",   { 255, 0,   0   }, { 0,   255, 0   } },
+        { "red-cyan",    { 255, 0,   0   }, { 0,   255, 255 } },
+        { "blue-yellow", { 0,   0,   255 }, { 255, 255, 0   } },
+        { "white-blue",  { 255, 255, 255 }, { 0,   0,   255 } },
+    };
+    double adBright[2];
+    double adSat[2];
+    double adWorst[2][2];
+    uint32 au32Out[5];
+    uint32 u32Pair;
+    uint32 u32Space;
+    uint32 j;
+
+    for (u32Pair = 0; u32Pair < sizeof(asPairs) / sizeof(asPairs[0]); u32Pair++)
+    {
+        const uint8 *pu8From = asPairs[u32Pair].au8From;
+        const uint8 *pu8To   = asPairs[u32Pair].au8To;
+        uint32 u32Max[2] = { MAX(pu8From[0], MAX(pu8From[1], pu8From[2])), MAX(pu8To[0], MAX(pu8To[1], pu8To[2])) };
+        uint32 u32Min[2] = { MIN(pu8From[0], MIN(pu8From[1], pu8From[2])), MIN(pu8To[0], MIN(pu8To[1], pu8To[2])) };
+
+        for (j = 0; j < 2; j++)
+        {
+            adBright[j] = u32Max[j] / 255.0;
+            adSat[j]    = u32Max[j] ? (double)(u32Max[j] - u32Min[j]) / u32Max[j] : 0.0;
+        }
+
+        for (u32Space = E_LI_COLOUR_RGB; u32Space < E_LI_COLOUR_NUM; u32Space++)
+        {
+            vLI_SetColourSpace((teLI_ColourSpace)u32Space);
+            vLI_StartTransition(254, pu8From[0], pu8From[1], pu8From[2], 0, LI_CHANNEL_ALL, 0, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+            vLI_CreatePoints(1);
+            vLI_StartTransition(254, pu8To[0], pu8To[1], pu8To[2], 0, LI_CHANNEL_COLOUR, 2000, LI_TICK_RATE_HZ, E_LI_CURVE_LINEAR);
+
+            adWorst[u32Space][0] = 0.0;
+            adWorst[u32Space][1] = 0.0;
+            for (j = 1; j <= u32Points; j++)
+            {
+                double dT = (double)j / u32Points;
+                uint32 u32OutMax;
+                uint32 u32OutMin;
+                double dBright;
+                double dSat;
+
+                vLI_CreatePoints(1);
+                vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+                u32OutMax = MAX(au32Out[1], MAX(au32Out[2], au32Out[3]));
+                u32OutMin = MIN(au32Out[1], MIN(au32Out[2], au32Out[3]));
+                dBright   = u32OutMax / 4095.0;
+                dSat      = u32OutMax ? (double)(u32OutMax - u32OutMin) / u32OutMax : 0.0;
+
+                adWorst[u32Space][0] = MAX(adWorst[u32Space][0], adBright[0] + (adBright[1] - adBright[0]) * dT - dBright);
+                adWorst[u32Space][1] = MAX(adWorst[u32Space][1], adSat[0] + (adSat[1] - adSat[0]) * dT - dSat);
+            }
+        }
+        vLI_SetColourSpace(E_LI_COLOUR_RGB);
+
+        printf("colour %-12s brightness sag rgb %5.1f%% hsv %5.1f%%, saturation sag rgb %5.1f%% hsv %5.1f%%\n",
+               asPairs[u32Pair].pcName,
+               adWorst[E_LI_COLOUR_RGB][0] * 100.0, adWorst[E_LI_COLOUR_HSV][0] * 100.0,
+               adWorst[E_LI_COLOUR_RGB][1] * 100.0, adWorst[E_LI_COLOUR_HSV][1] * 100.0);
+    }
+#endif
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckColour
+ *
+ * DESCRIPTION:     The fixed point colour conversions against floating
+ *                  point: xy across the gamut of the primaries must come
+ *                  within 2 of an exact conversion through the same
+ *                  matrix, and hue/saturation within 1 of exact HSV. A
+ *                  repeated colour must come back from the cache as it was
+ *                  converted, a change to any attribute its mode uses must
+ *                  be converted again, and an unknown mode left to the
+ *                  library.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckColour(void)
+{
+#ifdef LI_RGB
+    tsAPP_LightColour sColour = { APP_LIGHT_COLOUR_MODE_XY };
+    uint8  au8Out[3];
+    uint8  au8Ref[3];
+    uint8  au8Again[3];
+    uint16 u16X;
+    uint16 u16Y;
+    uint32 u32Point;
+    uint32 u32Hue;
+    uint32 u32Sat;
+    uint32 i;
+
+    for (u32Point = 0; u32Point < HOST_COLOUR_GRID * HOST_COLOUR_GRID; u32Point++)
+    {
+        vHost_ColourGridXY(u32Point, &u16X, &u16Y);
+        vApp_LightColour_XYToRGB(u16X, u16Y, &au8Out[0], &au8Out[1], &au8Out[2]);
+        vHost_ColourRefXY(u16X, u16Y, au8Ref);
+        for (i = 0; i < 3; i++)
+        {
+            if (abs((int)au8Out[i] - (int)au8Ref[i]) > 2)
+            {
+                printf("  xy %u %u: %u %u %u, exact %u %u %u\n", u16X, u16Y,
+                       au8Out[0], au8Out[1], au8Out[2], au8Ref[0], au8Ref[1], au8Ref[2]);
+                return FALSE;
+            }
+        }
+    }
+
+    for (u32Hue = 0; u32Hue < 256; u32Hue++)
+    {
+        for (u32Sat = 0; u32Sat <= 254; u32Sat++)
+        {
+            double dH = 6.0 * (u32Hue % 254) / 254.0;
+            double dS = MIN(u32Sat, 254) / 254.0;
+            double dF = dH - (int)dH;
+            double adRgb[3];
+            double dP = 255.0 * (1.0 - dS);
+            double dQ = 255.0 * (1.0 - dS * dF);
+            double dT = 255.0 * (1.0 - dS * (1.0 - dF));
+
+            switch ((int)dH)
+            {
+            case 0:  adRgb[0] = 255; adRgb[1] = dT;  adRgb[2] = dP;  break;
+            case 1:  adRgb[0] = dQ;  adRgb[1] = 255; adRgb[2] = dP;  break;
+            case 2:  adRgb[0] = dP;  adRgb[1] = 255; adRgb[2] = dT;  break;
+            case 3:  adRgb[0] = dP;  adRgb[1] = dQ;  adRgb[2] = 255; break;
+            case 4:  adRgb[0] = dT;  adRgb[1] = dP;  adRgb[2] = 255; break;
+            default: adRgb[0] = 255; adRgb[1] = dP;  adRgb[2] = dQ;  break;
+            }
+            vApp_LightColour_HSToRGB(u32Hue, u32Sat, &au8Out[0], &au8Out[1], &au8Out[2]);
+            for (i = 0; i < 3; i++)
+            {
+                if (abs((int)au8Out[i] - (int)(adRgb[i] + 0.5)) > 1)
+                {
+                    printf("  hue %u sat %u: %u %u %u, exact %.1f %.1f %.1f\n", u32Hue, u32Sat,
+                           au8Out[0], au8Out[1], au8Out[2], adRgb[0], adRgb[1], adRgb[2]);
+                    return FALSE;
+                }
+            }
+        }
+    }
+
+    /* Cached: attributes of another mode do not count, those of this one do */
+    sColour.u16X = 20000;
+    sColour.u16Y = 20000;
+    sColour.u8Hue = 10;
+    if ((bApp_LightColour_GetRGB(&sColour, &au8Out[0], &au8Out[1], &au8Out[2]) == FALSE) ||
+        (sColour.u8Hue = 100, bApp_LightColour_GetRGB(&sColour, &au8Again[0], &au8Again[1], &au8Again[2]) == FALSE) ||
+        (memcmp(au8Out, au8Again, sizeof(au8Out)) != 0))
+    {
+        printf("  cached xy %u %u %u, again %u %u %u\n", au8Out[0], au8Out[1], au8Out[2],
+               au8Again[0], au8Again[1], au8Again[2]);
+        return FALSE;
+    }
+    sColour.u8ColourMode = APP_LIGHT_COLOUR_MODE_HS;
+    sColour.u8Saturation = 254;
+    vApp_LightColour_HSToRGB(sColour.u8Hue, sColour.u8Saturation, &au8Ref[0], &au8Ref[1], &au8Ref[2]);
+    if ((bApp_LightColour_GetRGB(&sColour, &au8Out[0], &au8Out[1], &au8Out[2]) == FALSE) ||
+        (memcmp(au8Out, au8Ref, sizeof(au8Out)) != 0))
+    {
+        printf("  hs after xy %u %u %u, expected %u %u %u\n", au8Out[0], au8Out[1], au8Out[2],
+               au8Ref[0], au8Ref[1], au8Ref[2]);
+        return FALSE;
+    }
+    sColour.u8ColourMode = APP_LIGHT_COLOUR_MODE_CT + 1;
+    return (bApp_LightColour_GetRGB(&sColour, &au8Out[0], &au8Out[1], &au8Out[2]) == FALSE);
+#else
+    return TRUE;
+#endif
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckColourTemperature
+ *
+ * DESCRIPTION:     The black body table must give its entries exactly,
+ *                  grow warmer (red never falling, blue never rising) as
+ *                  the mired rises, and hold its ends beyond its range. A
+ *                  10s sweep from 6500K to 2000K, converted on each 100ms
+ *                  cluster update and rendered by LI, must do the same on
+ *                  every point.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckColourTemperature(void)
+{
+    uint32 au32Rgb[3];
+    uint32 au32Last[3] = { 0, 0xFFFF, 0xFFFF };
+    uint32 u32Mired;
+
+    for (u32Mired = MIRED_TABLE_MIN - 60; u32Mired <= MIRED_TABLE_MAX + 60; u32Mired++)
+    {
+        vBULB_MiredToRGB(u32Mired, &au32Rgb[0], &au32Rgb[1], &au32Rgb[2]);
+        if ((au32Rgb[0] < au32Last[0]) || (au32Rgb[2] > au32Last[2]) ||
+            (MAX(au32Rgb[0], MAX(au32Rgb[1], au32Rgb[2])) > 4095) ||
+            ((u32Mired >= MIRED_TABLE_MIN) && (u32Mired <= MIRED_TABLE_MAX) &&
+             (((u32Mired - MIRED_TABLE_MIN) % MIRED_TABLE_STEP) == 0) &&
+             (memcmp(au16MiredTable[(u32Mired - MIRED_TABLE_MIN) / MIRED_TABLE_STEP],
+                     (uint16[3]){ au32Rgb[0], au32Rgb[1], au32Rgb[2] }, 3 * sizeof(uint16)) != 0)))
+        {
+            printf("  %u mired: %u %u %u\n", u32Mired, au32Rgb[0], au32Rgb[1], au32Rgb[2]);
+            return FALSE;
+        }
+        memcpy(au32Last, au32Rgb, sizeof(au32Last));
+    }
+
+#ifdef LI_RGB
+    {
+        tsAPP_LightColour sColour = { APP_LIGHT_COLOUR_MODE_CT };
+        uint32 au32Out[5];
+        uint8  au8Rgb[3];
+        uint32 j;
+
+        au32Last[0] = 0;
+        au32Last[2] = 0xFFFF;
+        for (j = 0; j <= HOST_ZCL_STEPS * 10; j++)
+        {
+            if ((j % 10) == 0)
+            {
+                sColour.u16ColourTemperatureMired = 153 + ((500 - 153) * j) / (HOST_ZCL_STEPS * 10);
+                bApp_LightColour_GetRGB(&sColour, &au8Rgb[0], &au8Rgb[1], &au8Rgb[2]);
+                vLI_Start(254, au8Rgb[0], au8Rgb[1], au8Rgb[2], 0);
+            }
+            vLI_CreatePoints(1);
+            vLI_GetCurrentValues(&au32Out[0], &au32Out[1], &au32Out[2], &au32Out[3], &au32Out[4]);
+            if ((j > 10) && ((au32Out[1] < au32Last[0]) || (au32Out[3] > au32Last[2])))
+            {
+                printf("  sweep point %u: %u %u %u\n", j, au32Out[1], au32Out[2], au32Out[3]);
+                return FALSE;
+            }
+            au32Last[0] = au32Out[1];
+            au32Last[2] = au32Out[3];
+        }
+    }
+#endif
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckTunableWhite
+ *
+ * DESCRIPTION:     Every entry of the warm/cool table must give the light
+ *                  of its ends to within 1%, taking each LED's flux from
+ *                  the end it is alone at. A tunable white driver must give
+ *                  its LEDs as its range, and a move from the cool to the
+ *                  warm LED rendered by LI must never dim the warm LED or
+ *                  brighten the cool one, landing on the warm LED alone.
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckTunableWhite(void)
+{
+#ifdef LI_COLTEMP
+    tsHostTimer *psWarm = &sHostAhi.asTimer[E_AHI_TIMER_3];
+    tsHostTimer *psCool = &sHostAhi.asTimer[E_AHI_TIMER_4];
+    uint32 u32Warm, u32Cool;
+    uint32 u32LastWarm = 0;
+    uint32 u32LastCool = 0xFFFF;
+    uint32 u32Light;
+    uint16 u16Min, u16Max;
+    uint32 n;
+
+    for (n = 0; n <= MIRED_TABLE_SIZE; n++)
+    {
+        u32Light = (au16WarmCoolTable[n][0] * 4095) / au16WarmCoolTable[MIRED_TABLE_SIZE][0] +
+                   (au16WarmCoolTable[n][1] * 4095) / au16WarmCoolTable[0][1];
+        if ((u32Light < 4095 - 41) || (u32Light > 4095 + 41))
+        {
+            printf("  entry %u: light %u\n", n, u32Light);
+            return FALSE;
+        }
+    }
+
+    DriverBulb_vGetColourTempPhyMinMax(&u16Min, &u16Max);
+    if ((u16Min != WARMCOOL_MIRED_COOL) || (u16Max != WARMCOOL_MIRED_WARM))
+    {
+        return FALSE;
+    }
+
+    vBULB_SetOnOff(TRUE);
+    vLI_SetCurrentValues(254, 0, 0, 0, WARMCOOL_MIRED_COOL);
+    vLI_Start(254, 0, 0, 0, WARMCOOL_MIRED_WARM);
+    for (n = 0; n < 2 * LI_TICK_RATE_HZ; n++)
+    {
+        vLI_CreatePoints(1);
+        vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+        u32Warm = psWarm->u16Lo - psWarm->u16Hi;
+        u32Cool = psCool->u16Lo - psCool->u16Hi;
+        if ((u32Warm < u32LastWarm) || (u32Cool > u32LastCool))
+        {
+            printf("  point %u: warm %u cool %u\n", n, u32Warm, u32Cool);
+            return FALSE;
+        }
+        u32LastWarm = u32Warm;
+        u32LastCool = u32Cool;
+    }
+    if ((u32LastWarm != 255) || (u32LastCool != 0))
+    {
+        printf("  landed on warm %u cool %u\n", u32LastWarm, u32LastCool);
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckRgbw
+ *
+ * DESCRIPTION:     An RGBW driver must put a white colour on the white LED
+ *                  alone, leave it off for a primary, and take the white
+ *                  out of a mix so the least of its primaries is left at
+ *                  the lowest it is driven at
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckRgbw(void)
+{
+#ifdef JN516X_RGBW
+    static const struct
+    {
+        uint8  au8Colour[3];
+        uint8  au8Min[4];
+        uint8  au8Max[4];
+    } asCases[] =
+    {
+        /* colour           R    G    B    W        R    G    B    W    */
+        { { 255, 255, 255 }, {   0,   0,   0, 255 }, {   1,   1,   1, 255 } },
+        { { 255,   0,   0 }, { 255,   0,   0,   0 }, { 255,   1,   1,   0 } },
+        { { 255, 128,  64 }, { 200,  10,   0,  10 }, { 255, 100,   1, 100 } },
+    };
+    uint32 u32Out;
+    uint8 i, j;
+
+    vBULB_SetOnOff(TRUE);
+    for (i = 0; i < sizeof(asCases) / sizeof(asCases[0]); i++)
+    {
+        vBULB_SetState(255, asCases[i].au8Colour[0], asCases[i].au8Colour[1], asCases[i].au8Colour[2], 0);
+        vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+        for (j = 0; j < 4; j++)
+        {
+            tsHostTimer *psTimer = &sHostAhi.asTimer[E_AHI_TIMER_1 + j];
+            u32Out = psTimer->u16Lo - psTimer->u16Hi;
+            if ((u32Out < asCases[i].au8Min[j]) || (u32Out > asCases[i].au8Max[j]))
+            {
+                printf("  colour %u %u %u: channel %u at %u\n", asCases[i].au8Colour[0],
+                       asCases[i].au8Colour[1], asCases[i].au8Colour[2], j, u32Out);
+                return FALSE;
+            }
+        }
+    }
+#endif
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckCalibration
+ *
+ * DESCRIPTION:     The identity calibration must leave the outputs as the
+ *                  dimming curve gives them, a matrix must mix the colour
+ *                  between the LEDs and a gain dim its LED. Calibrations
+ *                  out of range are refused, and one saved in PDM is
+ *                  taken up by vBULB_LoadSettings. Only run against a
+ *                  driver with colour calibration
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckCalibration(void)
+{
+    const uint32 au32Full[3]  = { 255, 255, 255 };
+    const uint32 au32Red[3]   = { 255, 1,   1   };
+    const uint32 au32Green[3] = { 1,   255, 1   };
+    const uint32 au32Half[3]  = { 128, 1,   1   };
+    tsColourCalibration sIdentity;
+    tsColourCalibration sCal;
+    tsColourCalibration sRead;
+    uint32 au32Expect[3];
+    uint16 u16Len;
+    bool_t bOk = TRUE;
+    uint8  i;
+
+    if (DriverBulb_bSetColourCalibration == NULL)
+    {
+        return TRUE;
+    }
+
+    vBULB_GetColourCalibration(&sIdentity);
+    vBULB_SetOnOff(TRUE);
+
+    /* Identity: each LED on the dimming curve of its own channel */
+    for (i = 0; i < 3; i++)
+    {
+        au32Expect[i] = DIM_CURVE_SCALE12(DIM_EXPAND_12BIT(i * 100), DIM_12BIT_MAX, 8);
+    }
+    bOk &= bHost_CheckCalibrationOutput(0, 100, 200, au32Expect);
+    bOk &= bHost_CheckCalibrationOutput(255, 255, 255, au32Full);
+
+    /* Red and green swapped: red lights the green LED */
+    sCal = sIdentity;
+    sCal.ai16Matrix[0][0] = 0;
+    sCal.ai16Matrix[0][1] = COLOUR_CAL_ONE;
+    sCal.ai16Matrix[1][0] = COLOUR_CAL_ONE;
+    sCal.ai16Matrix[1][1] = 0;
+    bOk &= bBULB_SetColourCalibration(&sCal);
+    bOk &= bHost_CheckCalibrationOutput(255, 0, 0, au32Green);
+    bOk &= bHost_CheckCalibrationOutput(0, 255, 0, au32Red);
+
+    /* Half gain on red, and the calibration it gives saved */
+    sCal = sIdentity;
+    sCal.au16Gain[0] = COLOUR_CAL_ONE / 2;
+    bOk &= bBULB_SetColourCalibration(&sCal);
+    bOk &= bHost_CheckCalibrationOutput(255, 0, 0, au32Half);
+    bOk &= PDM_bDoesDataExist(PDM_ID_APP_COLOUR_CAL, &u16Len) && u16Len == sizeof(tsColourCalibration);
+
+    /* Calibrations the driver can't apply are refused, and checking one
+     * leaves the calibration in use alone */
+    sCal = sIdentity;
+    sCal.ai16Matrix[2][0] = COLOUR_CAL_MATRIX_MAX + 1;
+    bOk &= !bBULB_CheckColourCalibration(&sCal);
+    bOk &= !bBULB_SetColourCalibration(&sCal);
+    sCal = sIdentity;
+    sCal.au16Gain[2] = COLOUR_CAL_GAIN_MAX + 1;
+    bOk &= !bBULB_CheckColourCalibration(&sCal);
+    bOk &= !bBULB_SetColourCalibration(&sCal);
+    sCal = sIdentity;
+    bOk &= bBULB_CheckColourCalibration(&sCal);
+    vBULB_GetColourCalibration(&sRead);
+    bOk &= (sRead.au16Gain[0] == COLOUR_CAL_ONE / 2);
+
+    /* A calibration found in PDM at start up is taken */
+    sCal = sIdentity;
+    sCal.ai16Matrix[2][1] = -COLOUR_CAL_ONE / 4;
+    PDM_eSaveRecordData(PDM_ID_APP_COLOUR_CAL, &sCal, sizeof(sCal));
+    vBULB_LoadSettings();
+    vBULB_GetColourCalibration(&sRead);
+    bOk &= (memcmp(&sRead, &sCal, sizeof(sCal)) == 0);
+
+    bOk &= bBULB_SetColourCalibration(&sIdentity);
+    PDM_vDeleteDataRecord(PDM_ID_APP_COLOUR_CAL);
+    return bOk;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckCalibrationOutput
+ *
+ * DESCRIPTION:     Shows a colour at full level and compares the red, green
+ *                  and blue PWM against the expected 8 bit duties, allowing
+ *                  a step of dither
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckCalibrationOutput(uint32 u32Red, uint32 u32Green, uint32 u32Blue, const uint32 *pu32Expect)
+{
+    uint32 u32Out;
+    uint8 i;
+
+    vBULB_SetState(255, u32Red, u32Green, u32Blue, 0);
+    vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+    for (i = 0; i < 3; i++)
+    {
+        tsHostTimer *psTimer = &sHostAhi.asTimer[E_AHI_TIMER_1 + i];
+        u32Out = psTimer->u16Lo - psTimer->u16Hi;
+        if ((u32Out + 1 < pu32Expect[i]) || (u32Out > pu32Expect[i] + 1))
+        {
+            printf("  colour %u %u %u: channel %u at %u, expected %u\n",
+                   u32Red, u32Green, u32Blue, i, u32Out, pu32Expect[i]);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/****************************************************************************
+ *
+ * NAME:            bHost_CheckPwmProfiles
+ *
+ * DESCRIPTION:     Each PWM profile must program every PWM timer with its
+ *                  prescale and period, only latch where it asks to, and
+ *                  keep the duty ratios of the standard profile. The period
+ *                  interrupt must only be on while a new duty waits to be
+ *                  latched. Unknown profiles fail the check and are
+ *                  refused, and one saved in PDM is taken up by
+ *                  vBULB_LoadSettings. Only run against a driver with PWM
+ *                  profiles
+ *
+ ****************************************************************************/
+PRIVATE bool_t bHost_CheckPwmProfiles(void)
+{
+    const tsPwmProfile asProfile[E_PWM_PROFILE_NUM] = PWM_PROFILES;
+    uint32 au32Standard[HOST_AHI_NUM_TIMERS];
+    uint32 u32Starts;
+    uint32 u32Ints;
+    uint16 u16Len;
+    uint8  u8Profile;
+    bool_t bOk = TRUE;
+    uint8  i;
+
+    if (DriverBulb_bSetPwmProfile == NULL)
+    {
+        return TRUE;
+    }
+
+    bOk &= (u8BULB_GetPwmProfile() == E_PWM_PROFILE_STANDARD);
+    bOk &= bBULB_CheckPwmProfile(E_PWM_PROFILE_HIGH_RES);
+    bOk &= !bBULB_CheckPwmProfile(E_PWM_PROFILE_NUM);
+    bOk &= !bBULB_SetPwmProfile(E_PWM_PROFILE_NUM);
+    bOk &= (u8BULB_GetPwmProfile() == E_PWM_PROFILE_STANDARD);
+
+    vBULB_SetOnOff(TRUE);
+    vBULB_SetState(128, 200, 100, 50, 0);
+    vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        au32Standard[i] = sHostAhi.asTimer[i].u16Lo - sHostAhi.asTimer[i].u16Hi;
+    }
+
+    for (u8Profile = 0; u8Profile < E_PWM_PROFILE_NUM; u8Profile++)
+    {
+        const tsPwmProfile *psProfile = &asProfile[u8Profile];
+
+        bOk &= bBULB_SetPwmProfile(u8Profile);
+        bOk &= (u8BULB_GetPwmProfile() == u8Profile);
+        for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+        {
+            tsHostTimer *psTimer = &sHostAhi.asTimer[i];
+            uint32 u32Out = psTimer->u16Lo - psTimer->u16Hi;
+
+            if (!psTimer->bEnabled)
+            {
+                continue;
+            }
+            /* Two 8 bit steps either way covers the dither of both */
+            if (psTimer->u8Prescale != psProfile->u8Prescale || psTimer->u16Lo != psProfile->u16Period ||
+                psTimer->bIntPeriod ||
+                u32Out * 255 + 2 * psProfile->u16Period < au32Standard[i] * psProfile->u16Period ||
+                u32Out * 255 > au32Standard[i] * psProfile->u16Period + 2 * psProfile->u16Period)
+            {
+                printf("  profile %u: timer %u prescale %u period %u duty %u, standard duty %u\n",
+                       u8Profile, i, psTimer->u8Prescale, psTimer->u16Lo, u32Out, au32Standard[i]);
+                bOk = FALSE;
+            }
+        }
+    }
+
+    /* The period interrupt latches a new duty, then goes off again */
+    bOk &= bBULB_SetPwmProfile(E_PWM_PROFILE_STANDARD);
+    vBULB_SetState(200, 10, 200, 90, 0);
+    for (i = 0, u32Ints = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        u32Ints += sHostAhi.asTimer[i].bIntPeriod;
+    }
+    vHost_OsAdvance(HOST_PWM_LATCH_TIME);
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        if (sHostAhi.asTimer[i].bIntPeriod)
+        {
+            printf("  timer %u period interrupt left on after the latch\n", i);
+            bOk = FALSE;
+        }
+    }
+    if (u32Ints == 0)
+    {
+        printf("  no period interrupt turned on for a new duty\n");
+        bOk = FALSE;
+    }
+
+    /* Too fast to latch: a new duty goes straight to the timer */
+    bOk &= bBULB_SetPwmProfile(E_PWM_PROFILE_FLICKER_FREE);
+    u32Starts = 0;
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        u32Starts += sHostAhi.asTimer[i].u32Starts;
+    }
+    vBULB_SetState(255, 200, 100, 50, 0);
+    for (i = 0; i < HOST_AHI_NUM_TIMERS; i++)
+    {
+        u32Starts -= sHostAhi.asTimer[i].u32Starts;
+    }
+    bOk &= (u32Starts != 0);
+    bOk &= PDM_bDoesDataExist(PDM_ID_APP_PWM_PROFILE, &u16Len) && u16Len == sizeof(uint8);
+
+    /* A profile found in PDM at start up is taken */
+    u8Profile = E_PWM_PROFILE_HIGH_RES;
+    PDM_eSaveRecordData(PDM_ID_APP_PWM_PROFILE, &u8Profile, sizeof(u8Profile));
+    vBULB_LoadSettings();
+    bOk &= (u8BULB_GetPwmProfile() == E_PWM_PROFILE_HIGH_RES);
+    bOk &= (sHostAhi.asTimer[E_AHI_TIMER_3].u16Lo == asProfile[E_PWM_PROFILE_HIGH_RES].u16Period);
+
+    bOk &= bBULB_SetPwmProfile(E_PWM_PROFILE_STANDARD);
+    PDM_vDeleteDataRecord(PDM_ID_APP_PWM_PROFILE);
+    return bOk;
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_BenchColour
+ *
+ * DESCRIPTION:     Times an xy conversion in fixed point against the same
+ *                  conversion in floating point, which is how the ZCL
+ *                  library converts, and a repeated colour from the cache
+ *                  as a level or on/off update now finds it
+ *
+ ****************************************************************************/
+PRIVATE void vHost_BenchColour(void)
+{
+#ifdef LI_RGB
+    tsAPP_LightColour sColour = { APP_LIGHT_COLOUR_MODE_XY };
+    volatile uint8 u8Sink;
+    uint64 au64Ns[3];
+    uint64 u64Start;
+    uint16 au16X[HOST_COLOUR_GRID];
+    uint16 au16Y[HOST_COLOUR_GRID];
+    uint8  au8Rgb[3];
+    uint32 i;
+
+    for (i = 0; i < HOST_COLOUR_GRID; i++)
+    {
+        vHost_ColourGridXY(i * (HOST_COLOUR_GRID + 1), &au16X[i], &au16Y[i]);
+    }
+
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_COLOUR_BENCH_CALLS; i++)
+    {
+        vApp_LightColour_XYToRGB(au16X[i % HOST_COLOUR_GRID], au16Y[i % HOST_COLOUR_GRID],
+                                 &au8Rgb[0], &au8Rgb[1], &au8Rgb[2]);
+        u8Sink = au8Rgb[0];
+    }
+    au64Ns[0] = u64Host_CpuNs() - u64Start;
+
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_COLOUR_BENCH_CALLS; i++)
+    {
+        vHost_ColourRefXY(au16X[i % HOST_COLOUR_GRID], au16Y[i % HOST_COLOUR_GRID], au8Rgb);
+        u8Sink = au8Rgb[0];
+    }
+    au64Ns[1] = u64Host_CpuNs() - u64Start;
+
+    sColour.u16X = au16X[0];
+    sColour.u16Y = au16Y[0];
+    u64Start = u64Host_CpuNs();
+    for (i = 0; i < HOST_COLOUR_BENCH_CALLS; i++)
+    {
+        bApp_LightColour_GetRGB(&sColour, &au8Rgb[0], &au8Rgb[1], &au8Rgb[2]);
+        u8Sink = au8Rgb[0];
+    }
+    au64Ns[2] = u64Host_CpuNs() - u64Start;
+    (void)u8Sink;
+
+    printf("bench colour xy fixed %.1f ns, float %.1f ns, cached %.1f ns\n",
+           (double)au64Ns[0] / HOST_COLOUR_BENCH_CALLS,
+           (double)au64Ns[1] / HOST_COLOUR_BENCH_CALLS,
+           (double)au64Ns[2] / HOST_COLOUR_BENCH_CALLS);
+#endif
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_BenchCalibration
+ *
+ * DESCRIPTION:     Times a driver update through the calibrated output
+ *                  path with a full matrix, a new colour every update, and
+ *                  the same updates with the identity calibration. Both
+ *                  include the PWM write to the fake timers
+ *
+ ****************************************************************************/
+PRIVATE void vHost_BenchCalibration(void)
+{
+    tsColourCalibration sIdentity;
+    tsColourCalibration sCal;
+    uint64 au64Ns[2];
+    uint64 u64Start;
+    uint32 i, j;
+
+    if (DriverBulb_bSetColourCalibration == NULL)
+    {
+        return;
+    }
+
+    vBULB_GetColourCalibration(&sIdentity);
+    sCal = sIdentity;
+    sCal.ai16Matrix[0][1] = COLOUR_CAL_ONE / 8;
+    sCal.ai16Matrix[1][2] = -COLOUR_CAL_ONE / 8;
+    sCal.ai16Matrix[2][0] = COLOUR_CAL_ONE / 16;
+    sCal.au16Gain[1] = COLOUR_CAL_ONE * 7 / 8;
+
+    vHost_AhiReset();
+    vBULB_SetOnOff(TRUE);
+    for (j = 0; j < 2; j++)
+    {
+        bBULB_SetColourCalibration(j ? &sCal : &sIdentity);
+        u64Start = u64Host_CpuNs();
+        for (i = 0; i < HOST_CAL_BENCH_UPDATES; i++)
+        {
+            vBULB_Set12BitState(DIM_12BIT_MAX, i & DIM_12BIT_MAX, (i >> 4) & DIM_12BIT_MAX, (i >> 8) & DIM_12BIT_MAX, 0);
+        }
+        au64Ns[j] = u64Host_CpuNs() - u64Start;
+    }
+    bBULB_SetColourCalibration(&sIdentity);
+    PDM_vDeleteDataRecord(PDM_ID_APP_COLOUR_CAL);
+
+    printf("bench driver update identity calibration %.1f ns, full matrix %.1f ns\n",
+           (double)au64Ns[0] / HOST_CAL_BENCH_UPDATES,
+           (double)au64Ns[1] / HOST_CAL_BENCH_UPDATES);
+}
+
+#ifdef LI_RGB
+/****************************************************************************
+ *
+ * NAME:            vHost_ColourRefXY
+ *
+ * DESCRIPTION:     Exact xy to RGB through the primaries and white point,
+ *                  in double precision, as the reference for the fixed
+ *                  point conversion
+ *
+ ****************************************************************************/
+PRIVATE void vHost_ColourRefXY(uint16 u16X, uint16 u16Y, uint8 *pu8Rgb)
+{
+    const double adX[4] = { CLD_COLOURCONTROL_RED_X, CLD_COLOURCONTROL_GREEN_X,
+                            CLD_COLOURCONTROL_BLUE_X, CLD_COLOURCONTROL_WHITE_X };
+    const double adY[4] = { CLD_COLOURCONTROL_RED_Y, CLD_COLOURCONTROL_GREEN_Y,
+                            CLD_COLOURCONTROL_BLUE_Y, CLD_COLOURCONTROL_WHITE_Y };
+    double adXyz[3] = { u16X / 65536.0, u16Y / 65536.0, 1.0 - u16X / 65536.0 - u16Y / 65536.0 };
+    double adP[3][3];
+    double adInv[3][3];
+    double adRgb[3];
+    double dDet;
+    double dWhite;
+    double dMax = 0.0;
+    int i;
+    int j;
+
+    for (j = 0; j < 3; j++)
+    {
+        adP[0][j] = adX[j];
+        adP[1][j] = adY[j];
+        adP[2][j] = 1.0 - adX[j] - adY[j];
+    }
+    dDet = adP[0][0] * (adP[1][1] * adP[2][2] - adP[1][2] * adP[2][1]) -
+           adP[0][1] * (adP[1][0] * adP[2][2] - adP[1][2] * adP[2][0]) +
+           adP[0][2] * (adP[1][0] * adP[2][1] - adP[1][1] * adP[2][0]);
+    for (i = 0; i < 3; i++)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            /* Cofactor of the transposed element */
+            int r1 = (j + 1) % 3, r2 = (j + 2) % 3, c1 = (i + 1) % 3, c2 = (i + 2) % 3;
+            adInv[i][j] = (adP[r1][c1] * adP[r2][c2] - adP[r1][c2] * adP[r2][c1]) / dDet;
+        }
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        dWhite   = adInv[i][0] * adX[3] + adInv[i][1] * adY[3] + adInv[i][2] * (1.0 - adX[3] - adY[3]);
+        adRgb[i] = (adInv[i][0] * adXyz[0] + adInv[i][1] * adXyz[1] + adInv[i][2] * MAX(adXyz[2], 0.0)) / dWhite;
+        adRgb[i] = MAX(adRgb[i], 0.0);
+        dMax     = MAX(dMax, adRgb[i]);
+    }
+    for (i = 0; i < 3; i++)
+    {
+        pu8Rgb[i] = (dMax > 0.0) ? (uint8)(255.0 * adRgb[i] / dMax + 0.5) : 0;
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_ColourGridXY
+ *
+ * DESCRIPTION:     A point of a grid over the triangle of the primaries,
+ *                  as ZCL xy attributes
+ *
+ ****************************************************************************/
+PRIVATE void vHost_ColourGridXY(uint32 u32Point, uint16 *pu16X, uint16 *pu16Y)
+{
+    double dA = (double)(u32Point % HOST_COLOUR_GRID) / (HOST_COLOUR_GRID - 1);
+    double dB = (double)(u32Point / HOST_COLOUR_GRID) / (HOST_COLOUR_GRID - 1) * (1.0 - dA);
+    double dC = 1.0 - dA - dB;
+
+    *pu16X = (uint16)(65536.0 * (dA * CLD_COLOURCONTROL_RED_X + dB * CLD_COLOURCONTROL_GREEN_X +
+                                 dC * CLD_COLOURCONTROL_BLUE_X));
+    *pu16Y = (uint16)(65536.0 * (dA * CLD_COLOURCONTROL_RED_Y + dB * CLD_COLOURCONTROL_GREEN_Y +
+                                 dC * CLD_COLOURCONTROL_BLUE_Y));
+}
+#endif
+
+/****************************************************************************
+ *
+ * NAME:            vHost_LiRefStart, vHost_LiRefStep
+ *
+ * DESCRIPTION:     Scalar reference LI: retargets each channel, splitting
+ *                  the span into a whole step and a remainder, and steps
+ *                  them one at a time, landing exactly on the target
+ *
+ ****************************************************************************/
+PRIVATE void vHost_LiRefStart(const uint8 *pu8Target, uint32 u32Points)
+{
+    tsHostLiChannel *psChannel;
+    uint32 u32Target;
+    uint32 u32Span;
+    uint32 k;
+
+    for (k = 0, psChannel = asLiRef; k < HOST_LI_CHANNELS; k++, psChannel++)
+    {
+        u32Target = (uint32)pu8Target[k] << HOST_LI_SCALE;
+        psChannel->bDown    = (u32Target < psChannel->u32Current);
+        psChannel->u32Error = 0;
+        u32Span = (psChannel->bDown) ? (psChannel->u32Current - u32Target) : (u32Target - psChannel->u32Current);
+        psChannel->u32Step      = u32Span / u32Points;
+        psChannel->u32Remainder = u32Span - (psChannel->u32Step * u32Points);
+    }
+}
+
+PRIVATE void vHost_LiRefStep(uint32 u32Points)
+{
+    tsHostLiChannel *psChannel;
+    uint32 u32Delta;
+    uint32 k;
+
+    for (k = 0, psChannel = asLiRef; k < HOST_LI_CHANNELS; k++, psChannel++)
+    {
+        u32Delta = psChannel->u32Step;
+        psChannel->u32Error += psChannel->u32Remainder;
+        if (psChannel->u32Error >= u32Points)
+        {
+            psChannel->u32Error -= u32Points;
+            u32Delta++;
+        }
+        if (psChannel->bDown)
+        {
+            psChannel->u32Current -= u32Delta;
+        }
+        else
+        {
+            psChannel->u32Current += u32Delta;
+        }
+    }
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_LiRefUpdateDriver
+ *
+ * DESCRIPTION:     Passes the reference point to the driver as
+ *                  vLI_UpdateDriver does the packed one
+ *
+ ****************************************************************************/
+PRIVATE void vHost_LiRefUpdateDriver(void)
+{
+#ifdef LI_RGB
+    vBULB_Set12BitState(HOST_LI_TO_12BIT(asLiRef[0].u32Current),
+                        HOST_LI_TO_12BIT(asLiRef[1].u32Current),
+                        HOST_LI_TO_12BIT(asLiRef[2].u32Current),
+                        HOST_LI_TO_12BIT(asLiRef[3].u32Current),
+                        0);
+#else
+    vBULB_Set12BitLevel(HOST_LI_TO_12BIT(asLiRef[0].u32Current));
+#endif
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
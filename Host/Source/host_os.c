@@ -0,0 +1,324 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          host_os.c
+ *
+ * DESCRIPTION:        Host build: fake JenOS software timers, tasks and message queues
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <string.h>
+#include <jendefs.h>
+#include "os.h"
+#include "os_gen.h"
+#include "host_fake.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+#define HOST_OS_MAX_TIMERS          8
+
+/* Host ns to tick timer counts, for time spent running tasks */
+#define HOST_OS_NS_TO_TICKS(u64Ns)  (((u64Ns) * 16) / 1000)
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+tsHostSWTimer sHost_APP_TickTimer;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE uint64        u64Time = 0;
+PRIVATE uint32        u32Activations = 0;
+PRIVATE uint32        u32TaskDepth = 0;
+PRIVATE uint64        u64TaskStartNs;
+PRIVATE OS_thSWTimer  ahTimers[HOST_OS_MAX_TIMERS];
+PRIVATE uint8         u8NumTimers = 0;
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+PRIVATE void vHost_OsRegisterTimer(OS_thSWTimer hSWTimer)
+{
+    uint8 i;
+
+    for (i = 0; i < u8NumTimers; i++)
+    {
+        if (ahTimers[i] == hSWTimer)
+        {
+            return;
+        }
+    }
+    if (u8NumTimers < HOST_OS_MAX_TIMERS)
+    {
+        ahTimers[u8NumTimers++] = hSWTimer;
+    }
+}
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+/****************************************************************************
+ *
+ * NAME:            vHost_OsReset
+ *
+ * DESCRIPTION:     Stops all timers and rewinds simulated time
+ *
+ ****************************************************************************/
+PUBLIC void vHost_OsReset(void)
+{
+    uint8 i;
+
+    for (i = 0; i < u8NumTimers; i++)
+    {
+        ahTimers[i]->bRunning = FALSE;
+        ahTimers[i]->bExpired = FALSE;
+    }
+    u64Time = 0;
+    u32Activations = 0;
+}
+
+PUBLIC void vHost_OsSetTimerTask(OS_thSWTimer hSWTimer, OS_thTask hTask)
+{
+    hSWTimer->hTask = hTask;
+    vHost_OsRegisterTimer(hSWTimer);
+}
+
+PUBLIC uint64 u64Host_OsTime(void)
+{
+    return u64Time;
+}
+
+PUBLIC uint32 u32Host_OsActivations(void)
+{
+    return u32Activations;
+}
+
+/****************************************************************************
+ *
+ * NAME:            u64Host_OsRunTicks
+ *
+ * DESCRIPTION:     Host time the running task has taken so far, in tick
+ *                  timer counts. Simulated time stands still while a task
+ *                  runs, so this is added to the tick timer and to timers
+ *                  started from the task, as the time would have moved on
+ *                  by the end of the task on the target
+ *
+ ****************************************************************************/
+PUBLIC uint64 u64Host_OsRunTicks(void)
+{
+    if (u32TaskDepth == 0)
+    {
+        return 0;
+    }
+    return HOST_OS_NS_TO_TICKS(u64Host_WallNs() - u64TaskStartNs);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_OsAdvance
+ *
+ * DESCRIPTION:     Moves simulated time forward, expiring software timers in
+ *                  deadline order and running the tasks they activate.
+ *                  SPI transfers in flight complete, and raise their
+ *                  interrupt, at their end time in the same order, as do
+ *                  the period interrupts of the running timers
+ *
+ ****************************************************************************/
+PUBLIC void vHost_OsAdvance(uint64 u64Ticks)
+{
+    uint64 u64End = u64Time + u64Ticks;
+
+    for (;;)
+    {
+        OS_thSWTimer hNext = NULL;
+        uint64 u64SpiDoneAt;
+        uint64 u64PeriodAt;
+        uint8 i;
+
+        for (i = 0; i < u8NumTimers; i++)
+        {
+            if (ahTimers[i]->bRunning && ahTimers[i]->u64Expiry <= u64End &&
+                (hNext == NULL || ahTimers[i]->u64Expiry < hNext->u64Expiry))
+            {
+                hNext = ahTimers[i];
+            }
+        }
+        if (bHost_AhiSpiPending(&u64SpiDoneAt) && u64SpiDoneAt <= u64End &&
+            (hNext == NULL || u64SpiDoneAt <= hNext->u64Expiry))
+        {
+            u64Time = MAX(u64Time, u64SpiDoneAt);
+            vHost_AhiSpiComplete();
+            continue;
+        }
+        if (bHost_AhiTimerPending(&u64PeriodAt) && u64PeriodAt <= u64End &&
+            (hNext == NULL || u64PeriodAt <= hNext->u64Expiry))
+        {
+            u64Time = MAX(u64Time, u64PeriodAt);
+            vHost_AhiTimerPeriod();
+            continue;
+        }
+        if (hNext == NULL)
+        {
+            break;
+        }
+        u64Time = MAX(u64Time, hNext->u64Expiry);
+        hNext->bRunning = FALSE;
+        hNext->bExpired = TRUE;
+        if (hNext->hTask != NULL)
+        {
+            OS_eActivateTask(hNext->hTask);
+        }
+    }
+    u64Time = MAX(u64Time, u64End);
+}
+
+/****************************************************************************
+ *
+ * NAME:            vHost_OsStall
+ *
+ * DESCRIPTION:     Moves simulated time forward with nothing run, as a long
+ *                  callback or a blocking SPI frame holds the CPU on the
+ *                  target; timers that expire meanwhile run late, at the
+ *                  next vHost_OsAdvance
+ *
+ ****************************************************************************/
+PUBLIC void vHost_OsStall(uint64 u64Ticks)
+{
+    u64Time += u64Ticks;
+}
+
+/****************************************************************************
+ *
+ * NAME:            OS_e*SWTimer
+ *
+ * DESCRIPTION:     Software timers counting in tick timer units
+ *
+ ****************************************************************************/
+PUBLIC OS_teStatus OS_eStartSWTimer(OS_thSWTimer hSWTimer, uint32 u32Ticks, void *pvData)
+{
+    vHost_OsRegisterTimer(hSWTimer);
+    hSWTimer->bRunning  = TRUE;
+    hSWTimer->bExpired  = FALSE;
+    hSWTimer->u64Expiry = u64Time + u64Host_OsRunTicks() + u32Ticks;
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eContinueSWTimer(OS_thSWTimer hSWTimer, uint32 u32Ticks, void *pvData)
+{
+    /* Continue is relative to the previous expiry, not to now */
+    vHost_OsRegisterTimer(hSWTimer);
+    hSWTimer->bRunning  = TRUE;
+    hSWTimer->bExpired  = FALSE;
+    hSWTimer->u64Expiry = hSWTimer->u64Expiry + u32Ticks;
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eStopSWTimer(OS_thSWTimer hSWTimer)
+{
+    hSWTimer->bRunning = FALSE;
+    hSWTimer->bExpired = FALSE;
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eGetSWTimerStatus(OS_thSWTimer hSWTimer)
+{
+    if (hSWTimer->bRunning)
+    {
+        return OS_E_SWTIMER_RUNNING;
+    }
+    return (hSWTimer->bExpired) ? OS_E_SWTIMER_EXPIRED : OS_E_SWTIMER_STOPPED;
+}
+
+/****************************************************************************
+ *
+ * NAME:            OS_eActivateTask
+ *
+ * DESCRIPTION:     Tasks run to completion immediately on activation. A
+ *                  task activated from another is timed as part of it
+ *
+ ****************************************************************************/
+PUBLIC OS_teStatus OS_eActivateTask(OS_thTask hTask)
+{
+    u32Activations++;
+    if (u32TaskDepth++ == 0)
+    {
+        u64TaskStartNs = u64Host_WallNs();
+    }
+    hTask();
+    u32TaskDepth--;
+    return OS_E_OK;
+}
+
+/****************************************************************************
+ *
+ * NAME:            OS_ePostMessage, OS_eCollectMessage
+ *
+ * DESCRIPTION:     Fixed depth FIFO message queues
+ *
+ ****************************************************************************/
+PUBLIC OS_teStatus OS_ePostMessage(OS_thMessage hMessage, void *pvMessage)
+{
+    uint8 u8Slot;
+
+    if (hMessage->u8Count >= hMessage->u8Depth)
+    {
+        return OS_E_QUEUE_FULL;
+    }
+    u8Slot = (hMessage->u8Head + hMessage->u8Count) % hMessage->u8Depth;
+    memcpy(&hMessage->pu8Items[u8Slot * hMessage->u16ItemSize], pvMessage, hMessage->u16ItemSize);
+    hMessage->u8Count++;
+
+    if (hMessage->hTask != NULL)
+    {
+        OS_eActivateTask(hMessage->hTask);
+    }
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eCollectMessage(OS_thMessage hMessage, void *pvMessage)
+{
+    if (hMessage->u8Count == 0)
+    {
+        return OS_E_QUEUE_EMPTY;
+    }
+    memcpy(pvMessage, &hMessage->pu8Items[hMessage->u8Head * hMessage->u16ItemSize], hMessage->u16ItemSize);
+    hMessage->u8Head = (hMessage->u8Head + 1) % hMessage->u8Depth;
+    hMessage->u8Count--;
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eEnterCriticalSection(OS_thMutex hMutex)
+{
+    return OS_E_OK;
+}
+
+PUBLIC OS_teStatus OS_eExitCriticalSection(OS_thMutex hMutex)
+{
+    return OS_E_OK;
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
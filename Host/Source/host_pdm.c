@@ -0,0 +1,153 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          host_pdm.c
+ *
+ * DESCRIPTION:        Host build: fake Persistent Data Manager backed by RAM
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+/****************************************************************************/
+/***        Include files                                                 ***/
+/****************************************************************************/
+#include <string.h>
+#include <jendefs.h>
+#include "pdm.h"
+#include "host_fake.h"
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+#define HOST_PDM_MAX_RECORDS        16
+#define HOST_PDM_MAX_RECORD_SIZE    1024
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+typedef struct
+{
+    bool_t  bValid;
+    uint16  u16Id;
+    uint16  u16Length;
+    uint8   au8Data[HOST_PDM_MAX_RECORD_SIZE];
+} tsHostPdmRecord;
+
+/****************************************************************************/
+/***        Exported Variables                                            ***/
+/****************************************************************************/
+tsHostPdm sHostPdm;
+
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+PRIVATE tsHostPdmRecord asRecords[HOST_PDM_MAX_RECORDS];
+
+/****************************************************************************/
+/***        Local Functions                                               ***/
+/****************************************************************************/
+
+PRIVATE tsHostPdmRecord *psHost_PdmFind(uint16 u16IdValue)
+{
+    uint8 i;
+
+    for (i = 0; i < HOST_PDM_MAX_RECORDS; i++)
+    {
+        if (asRecords[i].bValid && asRecords[i].u16Id == u16IdValue)
+        {
+            return &asRecords[i];
+        }
+    }
+    return NULL;
+}
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC void vHost_PdmReset(void)
+{
+    memset(asRecords, 0, sizeof(asRecords));
+    memset(&sHostPdm, 0, sizeof(sHostPdm));
+}
+
+PUBLIC PDM_teStatus PDM_eSaveRecordData(uint16 u16IdValue, void *pvDataBuffer, uint16 u16Datalength)
+{
+    tsHostPdmRecord *psRecord = psHost_PdmFind(u16IdValue);
+    uint8 i;
+
+    if (u16Datalength > HOST_PDM_MAX_RECORD_SIZE)
+    {
+        return PDM_E_STATUS_INVLD_PARAM;
+    }
+    for (i = 0; psRecord == NULL && i < HOST_PDM_MAX_RECORDS; i++)
+    {
+        if (!asRecords[i].bValid)
+        {
+            psRecord = &asRecords[i];
+        }
+    }
+    if (psRecord == NULL)
+    {
+        return PDM_E_STATUS_NOT_SAVED;
+    }
+
+    psRecord->bValid    = TRUE;
+    psRecord->u16Id     = u16IdValue;
+    psRecord->u16Length = u16Datalength;
+    memcpy(psRecord->au8Data, pvDataBuffer, u16Datalength);
+    sHostPdm.u32Saves++;
+    return PDM_E_STATUS_OK;
+}
+
+PUBLIC PDM_teStatus PDM_eReadDataFromRecord(uint16 u16IdValue, void *pvDataBuffer,
+                                            uint16 u16DataBufferLength, uint16 *pu16DataBytesRead)
+{
+    tsHostPdmRecord *psRecord = psHost_PdmFind(u16IdValue);
+
+    sHostPdm.u32Reads++;
+    *pu16DataBytesRead = 0;
+    if (psRecord == NULL)
+    {
+        return PDM_E_STATUS_INVLD_PARAM;
+    }
+    *pu16DataBytesRead = MIN(u16DataBufferLength, psRecord->u16Length);
+    memcpy(pvDataBuffer, psRecord->au8Data, *pu16DataBytesRead);
+    return PDM_E_STATUS_OK;
+}
+
+PUBLIC void PDM_vDeleteDataRecord(uint16 u16IdValue)
+{
+    tsHostPdmRecord *psRecord = psHost_PdmFind(u16IdValue);
+
+    if (psRecord != NULL)
+    {
+        psRecord->bValid = FALSE;
+    }
+}
+
+PUBLIC bool_t PDM_bDoesDataExist(uint16 u16IdValue, uint16 *pu16DataLength)
+{
+    tsHostPdmRecord *psRecord = psHost_PdmFind(u16IdValue);
+
+    *pu16DataLength = (psRecord != NULL) ? psRecord->u16Length : 0;
+    return (psRecord != NULL);
+}
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          os.h
+ *
+ * DESCRIPTION:        Host build: stand-in for the JenOS kernel API
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef OS_H_INCLUDED
+#define OS_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Macro Definitions                                             ***/
+/****************************************************************************/
+
+#define OS_TASK(a)                  void os_v##a(void)
+#define OS_ISR(a)                   void os_v##a(void)
+#define OS_SWTIMER_CALLBACK(a, b)   void os_v##a(void *b)
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef enum
+{
+    OS_E_OK,
+    OS_E_QUEUE_EMPTY,
+    OS_E_QUEUE_FULL,
+    OS_E_SWTIMER_STOPPED,
+    OS_E_SWTIMER_EXPIRED,
+    OS_E_SWTIMER_RUNNING,
+    OS_E_BAD_SWTIMER
+} OS_teStatus;
+
+typedef void (*OS_thTask)(void);
+
+typedef struct
+{
+    bool_t      bRunning;
+    bool_t      bExpired;
+    uint64      u64Expiry;
+    OS_thTask   hTask;
+} tsHostSWTimer;
+
+typedef struct
+{
+    uint16      u16ItemSize;
+    uint8       u8Depth;
+    uint8       u8Head;
+    uint8       u8Count;
+    uint8      *pu8Items;
+    OS_thTask   hTask;
+} tsHostMessage;
+
+typedef tsHostSWTimer *OS_thSWTimer;
+typedef tsHostMessage *OS_thMessage;
+typedef void          *OS_thMutex;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC OS_teStatus OS_eStartSWTimer(OS_thSWTimer hSWTimer, uint32 u32Ticks, void *pvData);
+PUBLIC OS_teStatus OS_eContinueSWTimer(OS_thSWTimer hSWTimer, uint32 u32Ticks, void *pvData);
+PUBLIC OS_teStatus OS_eStopSWTimer(OS_thSWTimer hSWTimer);
+PUBLIC OS_teStatus OS_eGetSWTimerStatus(OS_thSWTimer hSWTimer);
+
+PUBLIC OS_teStatus OS_eActivateTask(OS_thTask hTask);
+PUBLIC OS_teStatus OS_ePostMessage(OS_thMessage hMessage, void *pvMessage);
+PUBLIC OS_teStatus OS_eCollectMessage(OS_thMessage hMessage, void *pvMessage);
+
+PUBLIC OS_teStatus OS_eEnterCriticalSection(OS_thMutex hMutex);
+PUBLIC OS_teStatus OS_eExitCriticalSection(OS_thMutex hMutex);
+
+#endif /* OS_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
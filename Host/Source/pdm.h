@@ -0,0 +1,60 @@
+/*****************************************************************************
+ *
+ * MODULE:             JN-AN-1171
+ *
+ * COMPONENT:          pdm.h
+ *
+ * DESCRIPTION:        Host build: stand-in for the Persistent Data Manager API
+ *
+ ****************************************************************************
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef PDM_H_INCLUDED
+#define PDM_H_INCLUDED
+
+/****************************************************************************/
+/***        Include Files                                                 ***/
+/****************************************************************************/
+
+#include <jendefs.h>
+
+/****************************************************************************/
+/***        Type Definitions                                              ***/
+/****************************************************************************/
+
+typedef enum
+{
+    PDM_E_STATUS_OK,
+    PDM_E_STATUS_INVLD_PARAM,
+    PDM_E_STATUS_NOT_SAVED,
+    PDM_E_STATUS_INTERNAL_ERROR
+} PDM_teStatus;
+
+/****************************************************************************/
+/***        Exported Functions                                            ***/
+/****************************************************************************/
+
+PUBLIC PDM_teStatus PDM_eSaveRecordData(uint16 u16IdValue, void *pvDataBuffer, uint16 u16Datalength);
+PUBLIC PDM_teStatus PDM_eReadDataFromRecord(uint16 u16IdValue, void *pvDataBuffer,
+                                            uint16 u16DataBufferLength, uint16 *pu16DataBytesRead);
+PUBLIC void         PDM_vDeleteDataRecord(uint16 u16IdValue);
+PUBLIC bool_t       PDM_bDoesDataExist(uint16 u16IdValue, uint16 *pu16DataLength);
+
+#endif /* PDM_H_INCLUDED */
+
+/****************************************************************************/
+/***        END OF FILE                                                   ***/
+/****************************************************************************/
@@ -46,6 +46,13 @@
 #include <string.h>
 
 #include "app_light_interpolation.h"
+#include "app_light_curve.h"
+#include "app_light_calibration.h"
+#include "app_light_diagnostics.h"
+#ifdef JN516X_SPI_RGB
+#include "app_light_strip.h"
+#endif
+#include "app_light_colour.h"
 #include "DriverBulb_Shim.h"
 
 
@@ -100,6 +107,20 @@ uint16 u16CurrentGreen;
 uint16 u16TargetGreen;
 int16 i16DeltaGreen = 0;
 
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* The light's cluster instances followed by the transition curve, colour
+ * calibration and diagnostics clusters, and on a strip the strip profile */
+#ifdef JN516X_SPI_RGB
+#define LIGHT_APP_CLUSTERS  (4)
+#else
+#define LIGHT_APP_CLUSTERS  (3)
+#endif
+PRIVATE tsZCL_ClusterInstance asLightClusterInstance[(sizeof(tsZLL_ColourLightDeviceClusterInstances) /
+                                                      sizeof(tsZCL_ClusterInstance)) + LIGHT_APP_CLUSTERS];
+
 /****************************************************************************/
 /***        Exported Functions                                            ***/
 /****************************************************************************/
@@ -124,6 +145,8 @@ PRIVATE void vOverideProfileId(uint16* pu16Profile, uint8 u8Ep);
 PUBLIC teZCL_Status eApp_ZLL_RegisterEndpoint(tfpZCL_ZCLCallBackFunction fptr,
                                        tsZLL_CommissionEndpoint* psCommissionEndpoint)
 {
+    teZCL_Status eZCL_Status;
+
 	ZPS_vAplZdoRegisterProfileCallback(vOverideProfileId);
 	zps_vSetIgnoreProfileCheck();
 
@@ -131,9 +154,39 @@ PUBLIC teZCL_Status eApp_ZLL_RegisterEndpoint(tfpZCL_ZCLCallBackFunction fptr,
                                     fptr,
                                     psCommissionEndpoint);
 
-    return eZLL_RegisterColourLightEndPoint(LIGHT_COLORLIGHT_LIGHT_00_ENDPOINT,
-                                            fptr,
-                                            &sLight);
+    eZCL_Status = eZLL_RegisterColourLightEndPoint(LIGHT_COLORLIGHT_LIGHT_00_ENDPOINT,
+                                                   fptr,
+                                                   &sLight);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    eZCL_Status = eApp_LightCurve_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                           sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    eZCL_Status = eApp_LightCalibration_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                                 sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+#ifdef JN516X_SPI_RGB
+    eZCL_Status = eApp_LightStrip_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                           sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+#endif
+
+    return eApp_LightDiagnostics_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                          sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
 }
 
 
@@ -164,7 +217,9 @@ PRIVATE void vOverideProfileId(uint16* pu16Profile, uint8 u8Ep)
  * NAME: vApp_eCLD_ColourControl_GetRGB
  *
  * DESCRIPTION:
- * To get RGB value
+ * To get RGB value. Hue/saturation, xy and colour temperature are
+ * converted by the app's own fixed point path, and only when a colour
+ * attribute has changed; any other mode is left to the library.
  *
  * PARAMETER
  * Type                   Name                    Descirption
@@ -178,10 +233,28 @@ PRIVATE void vOverideProfileId(uint16* pu16Profile, uint8 u8Ep)
  ****************************************************************************/
 PUBLIC void vApp_eCLD_ColourControl_GetRGB(uint8 *pu8Red,uint8 *pu8Green,uint8 *pu8Blue)
 {
-    eCLD_ColourControl_GetRGB(LIGHT_COLORLIGHT_LIGHT_00_ENDPOINT,
-                              pu8Red,
-                              pu8Green,
-                              pu8Blue);
+    tsAPP_LightColour sColour = { 0 };
+
+    sColour.u8ColourMode = sLight.sColourControlServerCluster.u8ColourMode;
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_HUE_SATURATION_SUPPORTED)
+    sColour.u8Hue        = sLight.sColourControlServerCluster.u8CurrentHue;
+    sColour.u8Saturation = sLight.sColourControlServerCluster.u8CurrentSaturation;
+#endif
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_XY_SUPPORTED)
+    sColour.u16X         = sLight.sColourControlServerCluster.u16CurrentX;
+    sColour.u16Y         = sLight.sColourControlServerCluster.u16CurrentY;
+#endif
+#if (CLD_COLOURCONTROL_COLOUR_CAPABILITIES & COLOUR_CAPABILITY_COLOUR_TEMPERATURE_SUPPORTED)
+    sColour.u16ColourTemperatureMired = sLight.sColourControlServerCluster.u16ColourTemperatureMired;
+#endif
+
+    if (bApp_LightColour_GetRGB(&sColour, pu8Red, pu8Green, pu8Blue) == FALSE)
+    {
+        eCLD_ColourControl_GetRGB(LIGHT_COLORLIGHT_LIGHT_00_ENDPOINT,
+                                  pu8Red,
+                                  pu8Green,
+                                  pu8Blue);
+    }
 }
 
 /****************************************************************************
@@ -240,10 +313,8 @@ PUBLIC void APP_vHandleIdentify(uint16 u16Time) {
 
         vApp_eCLD_ColourControl_GetRGB(&u8Red, &u8Green, &u8Blue);
 
-        DBG_vPrintf(TRACE_LIGHT_TASK, "R %d G %d B %d L %d Hue %d Sat %d\n", u8Red, u8Green, u8Blue,
-                            sLight.sLevelControlServerCluster.u8CurrentLevel,
-                            sLight.sColourControlServerCluster.u8CurrentHue,
-                            sLight.sColourControlServerCluster.u8CurrentSaturation);
+        DBG_vPrintf(TRACE_LIGHT_TASK, "R %d G %d B %d L %d\n", u8Red, u8Green, u8Blue,
+                            sLight.sLevelControlServerCluster.u8CurrentLevel);
 
         //DBG_vPrintf(TRACE_LIGHT_TASK, "\nidentify stop");
 
@@ -261,6 +332,23 @@ PUBLIC void APP_vHandleIdentify(uint16 u16Time) {
         }
 }
 
+/****************************************************************************
+ *
+ * NAME: bIdEffectActive
+ *
+ * DESCRIPTION:
+ * Whether an identify effect is still being stepped by the 100ms updates
+ *
+ * PARAMETER: void
+ *
+ * RETURNS: TRUE while an effect runs
+ *
+ ****************************************************************************/
+PUBLIC bool_t bIdEffectActive(void)
+{
+    return (sIdEffect.u8Effect < E_CLD_IDENTIFY_EFFECT_STOP_EFFECT);
+}
+
 /****************************************************************************
  *
  * NAME: vIdEffectTick
@@ -333,13 +421,11 @@ PUBLIC void vIdEffectTick(uint8 u8Endpoint) {
             APP_ZCL_vSetIdentifyTime(0);
                 uint8 u8Red, u8Green, u8Blue;
                 vApp_eCLD_ColourControl_GetRGB(&u8Red, &u8Green, &u8Blue);
-                DBG_vPrintf(TRACE_LIGHT_TASK, "EF - R %d G %d B %d L %d Hue %d Sat %d\n",
+                DBG_vPrintf(TRACE_LIGHT_TASK, "EF - R %d G %d B %d L %d\n",
                                     u8Red,
                                     u8Green,
                                     u8Blue,
-                                    sLight.sLevelControlServerCluster.u8CurrentLevel,
-                                    sLight.sColourControlServerCluster.u8CurrentHue,
-                                    sLight.sColourControlServerCluster.u8CurrentSaturation);
+                                    sLight.sLevelControlServerCluster.u8CurrentLevel);
 
                 vRGBLight_SetLevels(sLight.sOnOffServerCluster.bOnOff,
                                     sLight.sLevelControlServerCluster.u8CurrentLevel,
@@ -425,7 +511,9 @@ PUBLIC void vStartEffect(uint8 u8Effect) {
  * NAME: vRGBLight_SetLevels
  *
  * DESCRIPTION:
- * Set the RGB and levels
+ * Set the RGB and levels. A tunable white driver takes the colour
+ * temperature attribute in place of the RGB, so the identify effects
+ * run on it at the current white point
  *
  * RETURNS:
  * void
@@ -436,7 +524,38 @@ PUBLIC void vRGBLight_SetLevels(bool_t bOn, uint8 u8Level, uint8 u8Red, uint8 u8
 {
     if (bOn == TRUE)
     {
+        vLI_SetColourSpace(eApp_LightCurve_GetColourSpace());
+#ifdef LI_COLTEMP
+        vLI_Start(u8Level, u8Red, u8Green, u8Blue, sLight.sColourControlServerCluster.u16ColourTemperatureMired);
+#else
     	vLI_Start(u8Level, u8Red, u8Green, u8Blue, 0);
+#endif
+    }
+    else
+    {
+        vLI_Stop();
+    }
+    vBULB_SetOnOff(bOn);
+}
+
+#ifdef LI_COLTEMP
+/****************************************************************************
+ *
+ * NAME: vTunableWhiteLightSetLevels
+ *
+ * DESCRIPTION:
+ * Set the level and colour temperature of a tunable white driver. LI moves
+ * the colour temperature between cluster updates as it does the level
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vTunableWhiteLightSetLevels(bool_t bOn, uint8 u8Level, uint16 u16ColourTemperatureMired)
+{
+    if (bOn == TRUE)
+    {
+        vLI_Start(u8Level, 0, 0, 0, u16ColourTemperatureMired);
     }
     else
     {
@@ -444,6 +563,24 @@ PUBLIC void vRGBLight_SetLevels(bool_t bOn, uint8 u8Level, uint8 u8Red, uint8 u8
     }
     vBULB_SetOnOff(bOn);
 }
+#endif
+
+/****************************************************************************
+ *
+ * NAME: vRGBLight_StartLevelTransition
+ *
+ * DESCRIPTION:
+ * Moves the level to u8Level over u32TimeMs along eCurve; the colour
+ * carries on with any transition of its own
+ *
+ * RETURNS:
+ * void
+ *
+ ****************************************************************************/
+PUBLIC void vRGBLight_StartLevelTransition(uint8 u8Level, uint32 u32TimeMs, teLI_Curve eCurve)
+{
+    vLI_StartTransition(u8Level, 0, 0, 0, 0, LI_CHANNEL_LEVEL, u32TimeMs, LI_TICK_RATE_HZ, eCurve);
+}
 
 /****************************************************************/
 /* OS Stub functions to allow single osconfig diagram (ZLL/ZHA) */
@@ -38,6 +38,7 @@
 
 #include "colour_light.h"
 #include "commission_endpoint.h"
+#include "app_light_interpolation.h"
 
 /****************************************************************************/
 /***        External Variables                                            ***/
@@ -56,9 +57,14 @@ PUBLIC void vApp_eCLD_ColourControl_GetRGB(uint8* pu8Red,uint8* pu8Green,uint8*
 PUBLIC void vAPP_ZCL_DeviceSpecific_Init(void);
 PUBLIC void vStartEffect(uint8 u8Effect);
 PUBLIC void vIdEffectTick(uint8 u8Endpoint);
+PUBLIC bool_t bIdEffectActive(void);
 
 PUBLIC void vRGBLight_SetLevels(bool_t bOn, uint8 u8Level, uint8 u8Red,
                                 uint8 u8Green, uint8 u8Blue);
+PUBLIC void vRGBLight_StartLevelTransition(uint8 u8Level, uint32 u32TimeMs, teLI_Curve eCurve);
+#ifdef LI_COLTEMP
+PUBLIC void vTunableWhiteLightSetLevels(bool_t bOn, uint8 u8Level, uint16 u16ColourTemperatureMired);
+#endif
 PUBLIC void APP_vHandleIdentify(uint16 u16Time);
 PUBLIC void vCreateInterpolationPoints( void);
 
@@ -233,11 +233,27 @@ PUBLIC void vLoadScenesNVM(void);
 #define CLD_COLOURCONTROL_ATTR_ENHANCED_COLOUR_MODE
 #define CLD_COLOURCONTROL_ATTR_COLOUR_CAPABILITIES
 
-/* define capabilities of colour light */
+#ifdef JN516X_TUNABLEWHITE
+/* Built with the tunable white driver the light is a warm and a cool white
+ * LED, so it shows colour temperature only, over the range between them
+ * (WARMCOOL_MIRED_COOL to WARMCOOL_MIRED_WARM, 6500K to 2700K) */
+#define CLD_COLOURCONTROL_COLOUR_CAPABILITIES           (COLOUR_CAPABILITY_COLOUR_TEMPERATURE_SUPPORTED)
+
+#define CLD_COLOURCONTROL_COLOUR_TEMPERATURE_PHY_MIN    (154)
+#define CLD_COLOURCONTROL_COLOUR_TEMPERATURE_PHY_MAX    (370)
+#else
+/* define capabilities of colour light; colour temperature is shown on the
+ * RGB LEDs from the black body table, see vBULB_MiredToRGB */
 #define CLD_COLOURCONTROL_COLOUR_CAPABILITIES           (COLOUR_CAPABILITY_HUE_SATURATION_SUPPORTED | \
                                                          COLOUR_CAPABILITY_ENHANCE_HUE_SUPPORTED    | \
                                                          COLOUR_CAPABILITY_COLOUR_LOOP_SUPPORTED    | \
-                                                         COLOUR_CAPABILITY_XY_SUPPORTED)
+                                                         COLOUR_CAPABILITY_XY_SUPPORTED             | \
+                                                         COLOUR_CAPABILITY_COLOUR_TEMPERATURE_SUPPORTED)
+
+/* Colour temperature range the black body table covers, 6536K to 1667K */
+#define CLD_COLOURCONTROL_COLOUR_TEMPERATURE_PHY_MIN    (153)
+#define CLD_COLOURCONTROL_COLOUR_TEMPERATURE_PHY_MAX    (600)
+#endif
 
 
 /* Defined Primaries Information attribute attribute ID's set (5.2.2.2.2) */
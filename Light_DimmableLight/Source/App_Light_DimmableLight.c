@@ -46,6 +46,8 @@
 #include <string.h>
 #include "os.h"
 #include "app_light_interpolation.h"
+#include "app_light_curve.h"
+#include "app_light_diagnostics.h"
 #include "DriverBulb_Shim.h"
 
 #ifdef DEBUG_LIGHT_TASK
@@ -79,6 +81,15 @@ tsCLD_ZllDeviceTable sDeviceTable = { ZLL_NUMBER_DEVICES,
                                       }
 };
 
+/****************************************************************************/
+/***        Local Variables                                               ***/
+/****************************************************************************/
+
+/* The light's cluster instances followed by the transition curve and
+ * diagnostics clusters */
+PRIVATE tsZCL_ClusterInstance asLightClusterInstance[(sizeof(tsZLL_DimmableLightDeviceClusterInstances) /
+                                                      sizeof(tsZCL_ClusterInstance)) + 2];
+
 /****************************************************************************/
 /***        Exported Functions                                            ***/
 /****************************************************************************/
@@ -102,6 +113,7 @@ PRIVATE void vOverideProfileId(uint16* pu16Profile, uint8 u8Ep);
 PUBLIC teZCL_Status eApp_ZLL_RegisterEndpoint(tfpZCL_ZCLCallBackFunction fptr,
                                        tsZLL_CommissionEndpoint* psCommissionEndpoint)
 {
+    teZCL_Status eZCL_Status;
 
 	ZPS_vAplZdoRegisterProfileCallback(vOverideProfileId);
 	zps_vSetIgnoreProfileCheck();
@@ -110,9 +122,23 @@ PUBLIC teZCL_Status eApp_ZLL_RegisterEndpoint(tfpZCL_ZCLCallBackFunction fptr,
                                     fptr,
                                     psCommissionEndpoint);
 
-    return eZLL_RegisterDimmableLightEndPoint(LIGHT_DIMMABLELIGHT_LIGHT_00_ENDPOINT,
-                                              fptr,
-                                              &sLight);
+    eZCL_Status = eZLL_RegisterDimmableLightEndPoint(LIGHT_DIMMABLELIGHT_LIGHT_00_ENDPOINT,
+                                                     fptr,
+                                                     &sLight);
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    eZCL_Status = eApp_LightCurve_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                           sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
+    if (eZCL_Status != E_ZCL_SUCCESS)
+    {
+        return eZCL_Status;
+    }
+
+    return eApp_LightDiagnostics_Register(&sLight.sEndPoint, asLightClusterInstance,
+                                          sizeof(asLightClusterInstance) / sizeof(tsZCL_ClusterInstance));
 }
 
 
@@ -219,6 +245,23 @@ static bool bActive = FALSE;
     }
 }
 
+/****************************************************************************
+ *
+ * NAME: bIdEffectActive
+ *
+ * DESCRIPTION:
+ * Whether an identify effect is still being stepped by the 100ms updates
+ *
+ * PARAMETER: void
+ *
+ * RETURNS: TRUE while an effect runs
+ *
+ ****************************************************************************/
+PUBLIC bool_t bIdEffectActive(void)
+{
+    return (sIdEffect.u8Effect < E_CLD_IDENTIFY_EFFECT_STOP_EFFECT);
+}
+
 /****************************************************************************
  *
  * NAME: vIdEffectTick
@@ -420,6 +463,23 @@ PUBLIC void vSetBulbState(bool bOn, uint8 u8Level)
 	vBULB_SetOnOff(bOn);
 }
 
+/****************************************************************************
+ *
+ * NAME: vStartBulbLevelTransition
+ *
+ * DESCRIPTION:
+ * Moves the level to u8Level over u32TimeMs along eCurve
+ *
+ * PARAMETER: the target level, the transition time, its curve
+ *
+ * RETURNS: void
+ *
+ ****************************************************************************/
+PUBLIC void vStartBulbLevelTransition(uint8 u8Level, uint32 u32TimeMs, teLI_Curve eCurve)
+{
+	vLI_StartTransition(u8Level, 0, 0, 0, 0, LI_CHANNEL_LEVEL, u32TimeMs, LI_TICK_RATE_HZ, eCurve);
+}
+
 
 
 /****************************************************************************/
@@ -38,6 +38,7 @@
 
 #include "dimmable_light.h"
 #include "commission_endpoint.h"
+#include "app_light_interpolation.h"
 
 /****************************************************************************/
 /***        External Variables                                            ***/
@@ -53,8 +54,10 @@ extern tsCLD_ZllDeviceTable sDeviceTable;
 PUBLIC teZCL_Status eApp_ZLL_RegisterEndpoint(tfpZCL_ZCLCallBackFunction fptr,tsZLL_CommissionEndpoint* psCommissionEndpoint);
 PUBLIC void vAPP_ZCL_DeviceSpecific_Init(void);
 PUBLIC void vSetBulbState(bool bOn, uint8 u8Level);
+PUBLIC void vStartBulbLevelTransition(uint8 u8Level, uint32 u32TimeMs, teLI_Curve eCurve);
 PUBLIC void vStartEffect(uint8 u8Effect);
 PUBLIC void vIdEffectTick( uint8 u8Endpoint);
+PUBLIC bool_t bIdEffectActive(void);
 PUBLIC void APP_vHandleIdentify(uint16 u16Time);
 PUBLIC void vCreateInterpolationPoints(void);
 